@@ -250,6 +250,13 @@ PassRefPtr<StringImpl> Identifier::addSlowCase(JSGlobalData* globalData, StringI
                 return r;
     }
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    // An atomic string can be released on any thread, but an identifier has
+    // to be released on the thread whose table holds it.
+    if (r->isAtomic())
+        return add(globalData, r->characters(), r->length());
+#endif
+
     return *globalData->identifierTable->add(r).first;
 }
 
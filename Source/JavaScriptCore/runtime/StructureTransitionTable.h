@@ -65,6 +65,9 @@ class StructureTransitionTable {
 
         static const bool needsDestruction = FirstTraits::needsDestruction || SecondTraits::needsDestruction;
 
+        // Transition maps are probed on every property addition.
+        static const bool usesGroupProbing = true;
+
         static void constructDeletedValue(TraitType& slot) { FirstTraits::constructDeletedValue(slot.first); }
         static bool isDeletedValue(const TraitType& value) { return FirstTraits::isDeletedValue(value.first); }
     };
@@ -84,27 +84,42 @@ namespace WTF {
 inline int atomicIncrement(int* addend) { return InterlockedIncrement(reinterpret_cast<long*>(addend)); }
 inline int atomicDecrement(int* addend) { return InterlockedDecrement(reinterpret_cast<long*>(addend)); }
 #else
+#define WTF_USE_LOCKFREE_MESSAGEQUEUE 1
+
 inline int atomicIncrement(int volatile* addend) { return InterlockedIncrement(reinterpret_cast<long volatile*>(addend)); }
 inline int atomicDecrement(int volatile* addend) { return InterlockedDecrement(reinterpret_cast<long volatile*>(addend)); }
+inline bool atomicCompareAndSwap(void* volatile* location, void* expected, void* newValue) { return InterlockedCompareExchangePointer(location, newValue, expected) == expected; }
+inline bool atomicCompareAndSwap(int volatile* location, int expected, int newValue) { return InterlockedCompareExchange(reinterpret_cast<long volatile*>(location), newValue, expected) == expected; }
 #endif
 
 #elif OS(DARWIN)
 #define WTF_USE_LOCKFREE_THREADSAFEREFCOUNTED 1
 
+#define WTF_USE_LOCKFREE_MESSAGEQUEUE 1
+
 inline int atomicIncrement(int volatile* addend) { return OSAtomicIncrement32Barrier(const_cast<int*>(addend)); }
 inline int atomicDecrement(int volatile* addend) { return OSAtomicDecrement32Barrier(const_cast<int*>(addend)); }
+inline bool atomicCompareAndSwap(void* volatile* location, void* expected, void* newValue) { return OSAtomicCompareAndSwapPtrBarrier(expected, newValue, location); }
+inline bool atomicCompareAndSwap(int volatile* location, int expected, int newValue) { return OSAtomicCompareAndSwap32Barrier(expected, newValue, location); }
 
 #elif OS(ANDROID)
 //#define WTF_USE_LOCKFREE_THREADSAFEREFCOUNTED 1
 
+#define WTF_USE_LOCKFREE_MESSAGEQUEUE 1
+
 inline int atomicIncrement(int volatile* addend) { return android_atomic_inc(addend); }
 inline int atomicDecrement(int volatile* addend) { return android_atomic_dec(addend); }
+inline bool atomicCompareAndSwap(void* volatile* location, void* expected, void* newValue) { return __sync_bool_compare_and_swap(location, expected, newValue); }
+inline bool atomicCompareAndSwap(int volatile* location, int expected, int newValue) { return __sync_bool_compare_and_swap(location, expected, newValue); }
 
 #elif COMPILER(GCC) && !CPU(SPARC64) && !OS(SYMBIAN) // sizeof(_Atomic_word) != sizeof(int) on sparc64 gcc
 #define WTF_USE_LOCKFREE_THREADSAFEREFCOUNTED 1
+#define WTF_USE_LOCKFREE_MESSAGEQUEUE 1
 
 inline int atomicIncrement(int volatile* addend) { return __gnu_cxx::__exchange_and_add(addend, 1) + 1; }
 inline int atomicDecrement(int volatile* addend) { return __gnu_cxx::__exchange_and_add(addend, -1) - 1; }
+inline bool atomicCompareAndSwap(void* volatile* location, void* expected, void* newValue) { return __sync_bool_compare_and_swap(location, expected, newValue); }
+inline bool atomicCompareAndSwap(int volatile* location, int expected, int newValue) { return __sync_bool_compare_and_swap(location, expected, newValue); }
 
 #endif
 
@@ -115,4 +130,8 @@ using WTF::atomicDecrement;
 using WTF::atomicIncrement;
 #endif
 
+#if USE(LOCKFREE_MESSAGEQUEUE)
+using WTF::atomicCompareAndSwap;
+#endif
+
 #endif // Atomics_h
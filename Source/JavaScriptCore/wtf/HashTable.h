@@ -25,9 +25,18 @@
 #include "FastMalloc.h"
 #include "HashTraits.h"
 #include "ValueCheck.h"
+#include <string.h>
 #include <wtf/Assertions.h>
 #include <wtf/Threading.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif CPU(ARM_NEON)
+#include <arm_neon.h>
+#elif COMPILER(MSVC)
+#include <intrin.h>
+#endif
+
 namespace WTF {
 
 #define DUMP_HASHTABLE_STATS 0
@@ -369,13 +378,29 @@ namespace WTF {
         template<typename T, typename HashTranslator> FullLookupType fullLookupForWriting(const T&);
         template<typename T, typename HashTranslator> LookupType lookupForWriting(const T&);
 
+        // Tables whose key traits set usesGroupProbing keep a control byte for
+        // each bucket after the buckets, and probe them a group at a time.
+        static uint8_t* controlBytes(ValueType* table, int size) { return reinterpret_cast<uint8_t*>(table + size); }
+        uint8_t* controlBytes() const { return controlBytes(m_table, m_tableSize); }
+        void setControlByte(ValueType* entry, uint8_t byte) { controlBytes()[entry - m_table] = byte; }
+        template<typename T, typename HashTranslator> ValueType* groupLookup(const T&);
+        template<typename T, typename HashTranslator> FullLookupType groupLookupForWriting(const T&);
+        template<typename T, typename Extra, typename HashTranslator> pair<iterator, bool> groupAdd(const T& key, const Extra&);
+
         template<typename T, typename HashTranslator> void checkKey(const T&);
 
         void removeAndInvalidateWithoutEntryConsistencyCheck(ValueType*);
         void removeAndInvalidate(ValueType*);
         void remove(ValueType*);
 
-        bool shouldExpand() const { return (m_keyCount + m_deletedCount) * m_maxLoad >= m_tableSize; }
+        bool shouldExpand() const
+        {
+            // Control bytes find empty buckets quickly, so group probing tables
+            // can be filled up to 7/8 of their size.
+            if (KeyTraits::usesGroupProbing)
+                return (m_keyCount + m_deletedCount) * 8 >= m_tableSize * 7;
+            return (m_keyCount + m_deletedCount) * m_maxLoad >= m_tableSize;
+        }
         bool mustRehashInPlace() const { return m_keyCount * m_minLoad < m_tableSize * 2; }
         bool shouldShrink() const { return m_keyCount * m_minLoad < m_tableSize && m_tableSize > m_minTableSize; }
         void expand();
@@ -448,6 +473,87 @@ namespace WTF {
         return key;
     }
 
+    // Group probing tables find candidate buckets through their control bytes,
+    // a group of hashTableGroupSize at a time.  A full bucket's control byte
+    // holds seven bits of its hash, so most mismatches are rejected without
+    // touching the bucket itself.
+    static const int hashTableGroupSize = 16;
+    static const uint8_t emptyControlByte = 0x80;
+    static const uint8_t deletedControlByte = 0xFE;
+
+    static inline uint8_t controlByteForHash(unsigned hash)
+    {
+        // Table positions come from the low bits of the hash, so take the
+        // control byte from a rehash of it.
+        return doubleHash(hash) & 0x7F;
+    }
+
+#if CPU(ARM_NEON) && !defined(__SSE2__)
+    static inline unsigned controlByteMask(uint8x16_t matches)
+    {
+        static const uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        uint8x16_t matchBits = vandq_u8(matches, vld1q_u8(bits));
+        uint8x8_t sums = vpadd_u8(vget_low_u8(matchBits), vget_high_u8(matchBits));
+        sums = vpadd_u8(sums, sums);
+        sums = vpadd_u8(sums, sums);
+        return vget_lane_u8(sums, 0) | (vget_lane_u8(sums, 1) << 8);
+    }
+#endif
+
+    // Returns a mask with bit i set if group[i] is byte.
+    static inline unsigned matchControlBytes(const uint8_t* group, uint8_t byte)
+    {
+#if defined(__SSE2__)
+        __m128i controlBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(controlBytes, _mm_set1_epi8(static_cast<char>(byte))));
+#elif CPU(ARM_NEON)
+        return controlByteMask(vceqq_u8(vld1q_u8(group), vdupq_n_u8(byte)));
+#else
+        unsigned mask = 0;
+        for (int i = 0; i < hashTableGroupSize; ++i) {
+            if (group[i] == byte)
+                mask |= 1 << i;
+        }
+        return mask;
+#endif
+    }
+
+    // Returns a mask with bit i set if group[i] is empty or deleted.
+    static inline unsigned matchFreeControlBytes(const uint8_t* group)
+    {
+#if defined(__SSE2__)
+        return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group)));
+#elif CPU(ARM_NEON)
+        return controlByteMask(vtstq_u8(vld1q_u8(group), vdupq_n_u8(0x80)));
+#else
+        unsigned mask = 0;
+        for (int i = 0; i < hashTableGroupSize; ++i) {
+            if (group[i] & 0x80)
+                mask |= 1 << i;
+        }
+        return mask;
+#endif
+    }
+
+    static inline int firstControlByteMatch(unsigned mask)
+    {
+        ASSERT(mask);
+#if COMPILER(GCC)
+        return __builtin_ctz(mask);
+#elif COMPILER(MSVC)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        int index = 0;
+        while (!(mask & 1)) {
+            mask >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
+
 #if ASSERT_DISABLED
 
     template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
@@ -480,6 +586,10 @@ namespace WTF {
     {
         checkKey<T, HashTranslator>(key);
 
+        // we count on the compiler to optimize out this branch
+        if (KeyTraits::usesGroupProbing)
+            return m_table ? groupLookup<T, HashTranslator>(key) : 0;
+
         int k = 0;
         int sizeMask = m_tableSizeMask;
         ValueType* table = m_table;
@@ -528,6 +638,9 @@ namespace WTF {
         ASSERT(m_table);
         checkKey<T, HashTranslator>(key);
 
+        if (KeyTraits::usesGroupProbing)
+            return groupLookupForWriting<T, HashTranslator>(key).first;
+
         int k = 0;
         ValueType* table = m_table;
         int sizeMask = m_tableSizeMask;
@@ -580,6 +693,9 @@ namespace WTF {
         ASSERT(m_table);
         checkKey<T, HashTranslator>(key);
 
+        if (KeyTraits::usesGroupProbing)
+            return groupLookupForWriting<T, HashTranslator>(key);
+
         int k = 0;
         ValueType* table = m_table;
         int sizeMask = m_tableSizeMask;
@@ -625,6 +741,121 @@ namespace WTF {
         }
     }
 
+    template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
+    template<typename T, typename HashTranslator>
+    inline Value* HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::groupLookup(const T& key)
+    {
+        ASSERT(m_table);
+
+        ValueType* table = m_table;
+        const uint8_t* control = controlBytes();
+        int sizeMask = m_tableSizeMask;
+        unsigned h = HashTranslator::hash(key);
+        uint8_t byte = controlByteForHash(h);
+        int group = h & sizeMask & ~(hashTableGroupSize - 1);
+        int step = 0;
+
+#if DUMP_HASHTABLE_STATS
+        atomicIncrement(&HashTableStats::numAccesses);
+        int probeCount = 0;
+#endif
+
+        while (1) {
+            for (unsigned matches = matchControlBytes(control + group, byte); matches; matches &= matches - 1) {
+                ValueType* entry = table + group + firstControlByteMatch(matches);
+                if (HashTranslator::equal(Extractor::extract(*entry), key))
+                    return entry;
+            }
+
+            if (matchControlBytes(control + group, emptyControlByte))
+                return 0;
+#if DUMP_HASHTABLE_STATS
+            ++probeCount;
+            HashTableStats::recordCollisionAtCount(probeCount);
+#endif
+            // Visiting groups at triangular number offsets reaches all of them.
+            step += hashTableGroupSize;
+            group = (group + step) & sizeMask;
+        }
+    }
+
+    template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
+    template<typename T, typename HashTranslator>
+    inline typename HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::FullLookupType HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::groupLookupForWriting(const T& key)
+    {
+        ASSERT(m_table);
+
+        ValueType* table = m_table;
+        const uint8_t* control = controlBytes();
+        int sizeMask = m_tableSizeMask;
+        unsigned h = HashTranslator::hash(key);
+        uint8_t byte = controlByteForHash(h);
+        int group = h & sizeMask & ~(hashTableGroupSize - 1);
+        int step = 0;
+
+#if DUMP_HASHTABLE_STATS
+        atomicIncrement(&HashTableStats::numAccesses);
+        int probeCount = 0;
+#endif
+
+        ValueType* freeEntry = 0;
+
+        while (1) {
+            for (unsigned matches = matchControlBytes(control + group, byte); matches; matches &= matches - 1) {
+                ValueType* entry = table + group + firstControlByteMatch(matches);
+                if (HashTranslator::equal(Extractor::extract(*entry), key))
+                    return makeLookupResult(entry, true, h);
+            }
+
+            if (!freeEntry) {
+                if (unsigned free = matchFreeControlBytes(control + group))
+                    freeEntry = table + group + firstControlByteMatch(free);
+            }
+
+            if (matchControlBytes(control + group, emptyControlByte))
+                return makeLookupResult(freeEntry, false, h);
+#if DUMP_HASHTABLE_STATS
+            ++probeCount;
+            HashTableStats::recordCollisionAtCount(probeCount);
+#endif
+            step += hashTableGroupSize;
+            group = (group + step) & sizeMask;
+        }
+    }
+
+    template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
+    template<typename T, typename Extra, typename HashTranslator>
+    inline pair<typename HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::iterator, bool> HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::groupAdd(const T& key, const Extra& extra)
+    {
+        FullLookupType lookupResult = groupLookupForWriting<T, HashTranslator>(key);
+
+        ValueType* entry = lookupResult.first.first;
+        if (lookupResult.first.second)
+            return std::make_pair(makeKnownGoodIterator(entry), false);
+
+        if (isDeletedBucket(*entry)) {
+            initializeBucket(*entry);
+            --m_deletedCount;
+        }
+
+        HashTranslator::translate(*entry, key, extra);
+        setControlByte(entry, controlByteForHash(lookupResult.second));
+
+        ++m_keyCount;
+
+        if (shouldExpand()) {
+            KeyType enteredKey = Extractor::extract(*entry);
+            expand();
+            pair<iterator, bool> p = std::make_pair(find(enteredKey), true);
+            ASSERT(p.first != end());
+            return p;
+        }
+
+        internalCheckTableConsistency();
+
+        return std::make_pair(makeKnownGoodIterator(entry), true);
+    }
+
     template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
     template<typename T, typename Extra, typename HashTranslator>
     inline pair<typename HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::iterator, bool> HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::add(const T& key, const Extra& extra)
@@ -640,6 +871,9 @@ namespace WTF {
 
         ASSERT(m_table);
 
+        if (KeyTraits::usesGroupProbing)
+            return groupAdd<T, Extra, HashTranslator>(key, extra);
+
         int k = 0;
         ValueType* table = m_table;
         int sizeMask = m_tableSizeMask;
@@ -738,6 +972,8 @@ namespace WTF {
         }
         
         HashTranslator::translate(*entry, key, extra, h);
+        if (KeyTraits::usesGroupProbing)
+            setControlByte(entry, controlByteForHash(h));
         ++m_keyCount;
         if (shouldExpand()) {
             // FIXME: This makes an extra copy on expand. Probably not that bad since
@@ -765,6 +1001,13 @@ namespace WTF {
         atomicIncrement(&HashTableStats::numReinserts);
 #endif
 
+        if (KeyTraits::usesGroupProbing) {
+            FullLookupType lookupResult = groupLookupForWriting<Key, IdentityTranslatorType>(Extractor::extract(entry));
+            Mover<ValueType, Traits::needsDestruction>::move(entry, *lookupResult.first.first);
+            setControlByte(lookupResult.first.first, controlByteForHash(lookupResult.second));
+            return;
+        }
+
         Mover<ValueType, Traits::needsDestruction>::move(entry, *lookupForWriting(Extractor::extract(entry)).first);
     }
 
@@ -828,8 +1071,20 @@ namespace WTF {
         atomicIncrement(&HashTableStats::numRemoves);
 #endif
 
-        deleteBucket(*pos);
-        ++m_deletedCount;
+        // A probe only moves past a group with no empty buckets, and a group
+        // that has an empty bucket has had one ever since the last rehash.  So
+        // nothing was ever placed beyond such a group, and its buckets can be
+        // emptied instead of being marked deleted.
+        if (KeyTraits::usesGroupProbing && matchControlBytes(controlBytes() + ((pos - m_table) & ~(hashTableGroupSize - 1)), emptyControlByte)) {
+            pos->~ValueType();
+            initializeBucket(*pos);
+            setControlByte(pos, emptyControlByte);
+        } else {
+            deleteBucket(*pos);
+            if (KeyTraits::usesGroupProbing)
+                setControlByte(pos, deletedControlByte);
+            ++m_deletedCount;
+        }
         --m_keyCount;
 
         if (shouldShrink())
@@ -874,13 +1129,22 @@ namespace WTF {
     template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits>
     Value* HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits>::allocateTable(int size)
     {
+        size_t allocationSize = size * sizeof(ValueType);
+        if (KeyTraits::usesGroupProbing)
+            allocationSize += size;
+
         // would use a template member function with explicit specializations here, but
         // gcc doesn't appear to support that
+        ValueType* result;
         if (Traits::emptyValueIsZero)
-            return static_cast<ValueType*>(fastZeroedMalloc(size * sizeof(ValueType)));
-        ValueType* result = static_cast<ValueType*>(fastMalloc(size * sizeof(ValueType)));
-        for (int i = 0; i < size; i++)
-            initializeBucket(result[i]);
+            result = static_cast<ValueType*>(fastZeroedMalloc(allocationSize));
+        else {
+            result = static_cast<ValueType*>(fastMalloc(allocationSize));
+            for (int i = 0; i < size; i++)
+                initializeBucket(result[i]);
+        }
+        if (KeyTraits::usesGroupProbing)
+            memset(controlBytes(result, size), emptyControlByte, size);
         return result;
     }
 
@@ -1022,14 +1286,18 @@ namespace WTF {
         int deletedCount = 0;
         for (int j = 0; j < m_tableSize; ++j) {
             ValueType* entry = m_table + j;
-            if (isEmptyBucket(*entry))
+            if (isEmptyBucket(*entry)) {
+                ASSERT(!KeyTraits::usesGroupProbing || controlBytes()[j] == emptyControlByte);
                 continue;
+            }
 
             if (isDeletedBucket(*entry)) {
+                ASSERT(!KeyTraits::usesGroupProbing || controlBytes()[j] == deletedControlByte);
                 ++deletedCount;
                 continue;
             }
 
+            ASSERT(!KeyTraits::usesGroupProbing || controlBytes()[j] == controlByteForHash(HashFunctions::hash(Extractor::extract(*entry))));
             const_iterator it = find(Extractor::extract(*entry));
             ASSERT(entry == it.m_position);
             ++count;
@@ -40,12 +40,14 @@ namespace WTF {
     template<typename T> struct GenericHashTraitsBase<false, T> {
         static const bool emptyValueIsZero = false;
         static const bool needsDestruction = true;
+        static const bool usesGroupProbing = false;
     };
 
     // Default integer traits disallow both 0 and -1 as keys (max value instead of -1 for unsigned).
     template<typename T> struct GenericHashTraitsBase<true, T> {
         static const bool emptyValueIsZero = true;
         static const bool needsDestruction = false;
+        static const bool usesGroupProbing = false;
         static void constructDeletedValue(T& slot) { slot = static_cast<T>(-1); }
         static bool isDeletedValue(T value) { return value == static_cast<T>(-1); }
     };
@@ -92,6 +94,13 @@ namespace WTF {
     template<typename P> struct HashTraits<RefPtr<P> > : SimpleClassHashTraits<RefPtr<P> > { };
     template<> struct HashTraits<String> : SimpleClassHashTraits<String> { };
 
+    // Tables whose key traits are wrapped in this keep a byte of metadata for
+    // each bucket and match a group of those at once when probing.  That is
+    // faster for large tables, and for keys that are slow to compare.
+    template<typename Traits> struct GroupProbingHashTraits : Traits {
+        static const bool usesGroupProbing = true;
+    };
+
     // special traits for pairs, helpful for their use in HashMap implementation
 
     template<typename FirstTraitsArg, typename SecondTraitsArg>
@@ -114,6 +123,7 @@ namespace WTF {
 
 } // namespace WTF
 
+using WTF::GroupProbingHashTraits;
 using WTF::HashTraits;
 using WTF::PairHashTraits;
 
@@ -32,7 +32,9 @@
 
 #include <limits>
 #include <wtf/Assertions.h>
+#include <wtf/Atomics.h>
 #include <wtf/Deque.h>
+#include <wtf/FastAllocBase.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/Threading.h>
 
@@ -207,8 +209,252 @@ namespace WTF {
         MutexLocker lock(m_mutex);
         return m_killed;
     }
+
+#if USE(LOCKFREE_MESSAGEQUEUE)
+    // A MessageQueue for any number of threads posting messages to a single
+    // thread taking them.  append() never takes a lock: messages are pushed
+    // onto a lock-free list that the consumer moves into its own queue all at
+    // once.  The consumer yields a few times before going to sleep, and
+    // producers only touch the mutex when they have to wake it up.
+    // prepend() and removeIf() may be called from any thread; they lock the
+    // consumer's queue like the consumer itself does.
+    template<typename DataType>
+    class LockFreeMessageQueue {
+        WTF_MAKE_NONCOPYABLE(LockFreeMessageQueue);
+    public:
+        LockFreeMessageQueue() : m_incoming(0), m_consumerWaiting(0), m_killed(false) { }
+        ~LockFreeMessageQueue();
+
+        void append(PassOwnPtr<DataType>);
+        void prepend(PassOwnPtr<DataType>);
+
+        // Only one thread may wait for and take messages.
+        PassOwnPtr<DataType> waitForMessage();
+        PassOwnPtr<DataType> tryGetMessage();
+        template<typename Predicate>
+        PassOwnPtr<DataType> waitForMessageFilteredWithTimeout(MessageQueueWaitResult&, Predicate&, double absoluteTime);
+
+        template<typename Predicate>
+        void removeIf(Predicate&);
+
+        void kill();
+        bool killed() const;
+
+        // The result of isEmpty() is only valid if no other thread is manipulating the queue at the same time.
+        bool isEmpty();
+
+        static double infiniteTime() { return std::numeric_limits<double>::max(); }
+
+    private:
+        struct Node {
+            WTF_MAKE_FAST_ALLOCATED;
+        public:
+            DataType* message;
+            Node* next;
+        };
+
+        static bool alwaysTruePredicate(DataType*) { return true; }
+
+        // Moves messages appended since the last call into m_queue. m_mutex must be held.
+        void takeIncomingMessages();
+        bool hasIncomingMessages() const { return m_incoming; }
+
+        // Number of times the consumer yields waiting for messages before it sleeps.
+        static const int spinCount = 10;
+
+        // Most recently appended message first.
+        void* volatile m_incoming;
+        int volatile m_consumerWaiting;
+
+        mutable Mutex m_mutex;
+        ThreadCondition m_condition;
+        Deque<DataType*> m_queue;
+        volatile bool m_killed;
+    };
+
+    template<typename DataType>
+    LockFreeMessageQueue<DataType>::~LockFreeMessageQueue()
+    {
+        MutexLocker lock(m_mutex);
+        takeIncomingMessages();
+        deleteAllValues(m_queue);
+    }
+
+    template<typename DataType>
+    inline void LockFreeMessageQueue<DataType>::append(PassOwnPtr<DataType> message)
+    {
+        Node* node = new Node;
+        node->message = message.leakPtr();
+        do
+            node->next = static_cast<Node*>(m_incoming);
+        while (!atomicCompareAndSwap(&m_incoming, node->next, node));
+
+        // The compare-and-swap is a full barrier, so either the consumer sees
+        // the message before it sleeps or we see that it is about to.
+        if (m_consumerWaiting) {
+            MutexLocker lock(m_mutex);
+            m_condition.signal();
+        }
+    }
+
+    template<typename DataType>
+    inline void LockFreeMessageQueue<DataType>::prepend(PassOwnPtr<DataType> message)
+    {
+        MutexLocker lock(m_mutex);
+        m_queue.prepend(message.leakPtr());
+        m_condition.signal();
+    }
+
+    template<typename DataType>
+    void LockFreeMessageQueue<DataType>::takeIncomingMessages()
+    {
+        void* incoming;
+        do
+            incoming = m_incoming;
+        while (incoming && !atomicCompareAndSwap(&m_incoming, incoming, 0));
+
+        // Reverse the list so that messages are queued in the order they were appended.
+        Node* oldestFirst = 0;
+        for (Node* node = static_cast<Node*>(incoming); node; ) {
+            Node* next = node->next;
+            node->next = oldestFirst;
+            oldestFirst = node;
+            node = next;
+        }
+        while (Node* node = oldestFirst) {
+            oldestFirst = node->next;
+            m_queue.append(node->message);
+            delete node;
+        }
+    }
+
+    template<typename DataType>
+    inline PassOwnPtr<DataType> LockFreeMessageQueue<DataType>::waitForMessage()
+    {
+        MessageQueueWaitResult exitReason; 
+        PassOwnPtr<DataType> result = waitForMessageFilteredWithTimeout(exitReason, LockFreeMessageQueue<DataType>::alwaysTruePredicate, infiniteTime());
+        ASSERT(exitReason == MessageQueueTerminated || exitReason == MessageQueueMessageReceived);
+        return result;
+    }
+
+    template<typename DataType>
+    template<typename Predicate>
+    inline PassOwnPtr<DataType> LockFreeMessageQueue<DataType>::waitForMessageFilteredWithTimeout(MessageQueueWaitResult& result, Predicate& predicate, double absoluteTime)
+    {
+        MutexLocker lock(m_mutex);
+        bool timedOut = false;
+        bool spun = false;
+
+        DequeConstIterator<DataType*> found = m_queue.end();
+        while (true) {
+            takeIncomingMessages();
+            if (m_killed || timedOut || (found = m_queue.findIf(predicate)) != m_queue.end())
+                break;
+
+            if (!spun) {
+                // Messages tend to come in bursts, so give the producers a
+                // chance to post the next one rather than going to sleep at once.
+                m_mutex.unlock();
+                for (int i = 0; i < spinCount && !hasIncomingMessages() && !m_killed; ++i)
+                    yield();
+                m_mutex.lock();
+                spun = true;
+                continue;
+            }
+
+            atomicIncrement(&m_consumerWaiting);
+            takeIncomingMessages();
+            if (!m_killed && (found = m_queue.findIf(predicate)) == m_queue.end())
+                timedOut = !m_condition.timedWait(m_mutex, absoluteTime);
+            atomicDecrement(&m_consumerWaiting);
+            if (found != m_queue.end())
+                break;
+        }
+
+        ASSERT(!timedOut || absoluteTime != infiniteTime());
+
+        if (m_killed) {
+            result = MessageQueueTerminated;
+            return nullptr;
+        }
+
+        if (timedOut) {
+            result = MessageQueueTimeout;
+            return nullptr;
+        }
+
+        ASSERT(found != m_queue.end());
+        DataType* message = *found;
+        m_queue.remove(found);
+        result = MessageQueueMessageReceived;
+        return message;
+    }
+
+    template<typename DataType>
+    inline PassOwnPtr<DataType> LockFreeMessageQueue<DataType>::tryGetMessage()
+    {
+        MutexLocker lock(m_mutex);
+        if (m_killed)
+            return nullptr;
+        takeIncomingMessages();
+        if (m_queue.isEmpty())
+            return nullptr;
+
+        return m_queue.takeFirst();
+    }
+
+    template<typename DataType>
+    template<typename Predicate>
+    inline void LockFreeMessageQueue<DataType>::removeIf(Predicate& predicate)
+    {
+        MutexLocker lock(m_mutex);
+        takeIncomingMessages();
+        // See bug 31657 for why this loop looks so weird
+        while (true) {
+            DequeConstIterator<DataType*> found = m_queue.findIf(predicate);
+            if (found == m_queue.end())
+                break;
+
+            DataType* message = *found;
+            m_queue.remove(found);
+            delete message;
+       }
+    }
+
+    template<typename DataType>
+    inline bool LockFreeMessageQueue<DataType>::isEmpty()
+    {
+        MutexLocker lock(m_mutex);
+        if (m_killed)
+            return true;
+        takeIncomingMessages();
+        return m_queue.isEmpty();
+    }
+
+    template<typename DataType>
+    inline void LockFreeMessageQueue<DataType>::kill()
+    {
+        MutexLocker lock(m_mutex);
+        m_killed = true;
+        m_condition.broadcast();
+    }
+
+    template<typename DataType>
+    inline bool LockFreeMessageQueue<DataType>::killed() const
+    {
+        MutexLocker lock(m_mutex);
+        return m_killed;
+    }
+#else
+    // Without a compare-and-swap primitive the lock-free queue falls back to
+    // the locking one.
+    template<typename DataType>
+    class LockFreeMessageQueue : public MessageQueue<DataType> {
+    };
+#endif
 } // namespace WTF
 
+using WTF::LockFreeMessageQueue;
 using WTF::MessageQueue;
 // MessageQueueWaitResult enum and all its values.
 using WTF::MessageQueueWaitResult;
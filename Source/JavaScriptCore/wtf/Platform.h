@@ -1091,6 +1091,34 @@
 #define ENABLE_FULLSCREEN_API 0
 #endif
 
+/* Let the generic image decoders decode fewer pixels than the image has, either to
+   stay under a pixel budget or because the image is displayed smaller. The port's
+   drawing code must then scale frames back up to the intrinsic size. Android's Skia
+   ImageSource downscales on its own and doesn't need this. */
+#if !defined(ENABLE_IMAGE_DECODER_DOWN_SAMPLING)
+#define ENABLE_IMAGE_DECODER_DOWN_SAMPLING 0
+#endif
+
+/* Whether wtf/Atomics.h has atomicIncrement(), atomicDecrement() and
+   atomicCompareAndSwap() on volatile ints and pointers. */
+#if (OS(WINDOWS) && !COMPILER(MINGW) && !COMPILER(MSVC7_OR_LOWER) && !OS(WINCE)) \
+    || OS(DARWIN) \
+    || OS(ANDROID) \
+    || (COMPILER(GCC) && !CPU(SPARC64) && !OS(SYMBIAN))
+#define WTF_USE_LOCKFREE_ATOMICS 1
+#endif
+
+/* Keep one atomic string table for all threads, so that atomic strings can be
+   passed between threads. Atomic strings are then ref counted atomically. */
+#if !defined(ENABLE_SHARED_ATOMIC_STRING_TABLE)
+#define ENABLE_SHARED_ATOMIC_STRING_TABLE 0
+#endif
+
+/* Allocate DOM nodes and attributes from per-document slabs in WebCore. */
+#if !defined(ENABLE_DOM_NODE_ARENA)
+#define ENABLE_DOM_NODE_ARENA 0
+#endif
+
 #if !defined(WTF_USE_JSVALUE64) && !defined(WTF_USE_JSVALUE32_64)
 #if (CPU(X86_64) && (OS(UNIX) || OS(WINDOWS))) \
     || (CPU(IA64) && !CPU(IA64_32)) \
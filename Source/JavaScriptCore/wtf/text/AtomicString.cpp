@@ -35,6 +35,85 @@ using namespace Unicode;
 
 COMPILE_ASSERT(sizeof(AtomicString) == sizeof(String), atomic_string_and_string_must_be_same_size);
 
+// Most atomic string lookups are for strings already in the table, and each
+// probe of a bucket that holds some other string compares characters, so let
+// the table reject those through its control bytes.
+typedef HashSet<StringImpl*, StringHash, GroupProbingHashTraits<HashTraits<StringImpl*> > > StringTable;
+
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+
+// The table is split by hash into shards with their own locks, so threads
+// atomizing different strings rarely wait for each other.
+static const unsigned stringTableShardBits = 4;
+
+struct StringTableShard {
+    Mutex lock;
+    StringTable table;
+};
+
+static StringTableShard* stringTableShards;
+
+static inline StringTableShard& stringTableShard(unsigned hash)
+{
+    // As with AtomicString::init(), the first atomic string must be made on
+    // the main thread before other threads start using the table.
+    if (UNLIKELY(!stringTableShards))
+        stringTableShards = new StringTableShard[1 << stringTableShardBits];
+
+    // Pick the shard with the high bits; the shard's table uses the low ones.
+    return stringTableShards[hash >> (32 - stringTableShardBits)];
+}
+
+// Lets a translator's hash be computed once, to choose the shard, and then
+// reused by the shard's table.
+template<typename T> struct HashedValue {
+    HashedValue(const T& value, unsigned hash)
+        : value(value)
+        , hash(hash)
+    {
+    }
+
+    const T& value;
+    unsigned hash;
+};
+
+template<typename T, typename HashTranslator> struct HashedValueTranslator {
+    static unsigned hash(const HashedValue<T>& hashedValue)
+    {
+        return hashedValue.hash;
+    }
+
+    static bool equal(StringImpl* const& string, const HashedValue<T>& hashedValue)
+    {
+        return HashTranslator::equal(string, hashedValue.value);
+    }
+
+    static void translate(StringImpl*& location, const HashedValue<T>& hashedValue, unsigned hash)
+    {
+        HashTranslator::translate(location, hashedValue.value, hash);
+    }
+};
+
+template<typename T, typename HashTranslator>
+static inline PassRefPtr<StringImpl> addToStringTable(const T& value)
+{
+    HashedValue<T> hashedValue(value, HashTranslator::hash(value));
+    StringTableShard& shard = stringTableShard(hashedValue.hash);
+    MutexLocker locker(shard.lock);
+    pair<StringTable::iterator, bool> addResult = shard.table.add<HashedValue<T>, HashedValueTranslator<T, HashTranslator> >(hashedValue);
+    if (addResult.second || (*addResult.first)->tryRef())
+        return adoptRef(*addResult.first);
+
+    // The string in the table was released on another thread and is waiting
+    // for this lock to remove itself. Put a new string in its place; the old
+    // one only removes the entry if it still holds it.
+    StringImpl*& location = const_cast<StringImpl*&>(*addResult.first);
+    HashTranslator::translate(location, value, hashedValue.hash);
+    return adoptRef(location);
+}
+
+#else
+
 class AtomicStringTable {
 public:
     static AtomicStringTable* create()
@@ -48,7 +127,7 @@ public:
         return table;
     }
 
-    HashSet<StringImpl*>& table()
+    StringTable& table()
     {
         return m_table;
     }
@@ -56,16 +135,16 @@ public:
 private:
     static void destroy(AtomicStringTable* table)
     {
-        HashSet<StringImpl*>::iterator end = table->m_table.end();
-        for (HashSet<StringImpl*>::iterator iter = table->m_table.begin(); iter != end; ++iter)
+        StringTable::iterator end = table->m_table.end();
+        for (StringTable::iterator iter = table->m_table.begin(); iter != end; ++iter)
             (*iter)->setIsAtomic(false);
         delete table;
     }
 
-    HashSet<StringImpl*> m_table;
+    StringTable m_table;
 };
 
-static inline HashSet<StringImpl*>& stringTable()
+static inline StringTable& stringTable()
 {
     // Once possible we should make this non-lazy (constructed in WTFThreadData's constructor).
     AtomicStringTable* table = wtfThreadData().atomicStringTable();
@@ -77,13 +156,15 @@ static inline HashSet<StringImpl*>& stringTable()
 template<typename T, typename HashTranslator>
 static inline PassRefPtr<StringImpl> addToStringTable(const T& value)
 {
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<T, HashTranslator>(value);
+    pair<StringTable::iterator, bool> addResult = stringTable().add<T, HashTranslator>(value);
 
     // If the string is newly-translated, then we need to adopt it.
     // The boolean in the pair tells us if that is so.
     return addResult.second ? adoptRef(*addResult.first) : *addResult.first;
 }
 
+#endif // ENABLE(SHARED_ATOMIC_STRING_TABLE)
+
 struct CStringTranslator {
     static unsigned hash(const char* c)
     {
@@ -313,13 +394,33 @@ PassRefPtr<StringImpl> AtomicString::addSlowCase(StringImpl* r)
     if (!r->length())
         return StringImpl::empty();
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    // Identifiers have to be released on the thread that made them.
+    if (r->isIdentifier()) {
+        UCharBuffer buffer = { r->characters(), r->length() };
+        return addToStringTable<UCharBuffer, UCharBufferTranslator>(buffer);
+    }
+
+    StringTableShard& shard = stringTableShard(r->hash());
+    MutexLocker locker(shard.lock);
+    pair<StringTable::iterator, bool> addResult = shard.table.add(r);
+    if (!addResult.second && (*addResult.first)->tryRef())
+        return adoptRef(*addResult.first);
+
+    // Only this thread can see r until it is in the table, so it is safe to
+    // make it atomic here, even when it replaces a string being destroyed.
+    const_cast<StringImpl*&>(*addResult.first) = r;
+    r->setIsAtomic(true);
+    return r;
+#else
     StringImpl* result = *stringTable().add(r).first;
     if (result == r)
         r->setIsAtomic(true);
     return result;
+#endif
 }
 
-AtomicStringImpl* AtomicString::find(const UChar* s, unsigned length, unsigned existingHash)
+PassRefPtr<AtomicStringImpl> AtomicString::find(const UChar* s, unsigned length, unsigned existingHash)
 {
     ASSERT(s);
     ASSERT(existingHash);
@@ -328,15 +429,35 @@ AtomicStringImpl* AtomicString::find(const UChar* s, unsigned length, unsigned e
         return static_cast<AtomicStringImpl*>(StringImpl::empty());
 
     HashAndCharacters buffer = { existingHash, s, length }; 
-    HashSet<StringImpl*>::iterator iterator = stringTable().find<HashAndCharacters, HashAndCharactersTranslator>(buffer);
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    StringTableShard& shard = stringTableShard(existingHash);
+    MutexLocker locker(shard.lock);
+    StringTable::iterator iterator = shard.table.find<HashAndCharacters, HashAndCharactersTranslator>(buffer);
+    // Ref the string while the shard is locked, since another thread may
+    // release it as soon as the lock is dropped. A string that is already
+    // being destroyed can't be in use by the caller.
+    if (iterator == shard.table.end() || !(*iterator)->tryRef())
+        return 0;
+    return adoptRef(static_cast<AtomicStringImpl*>(*iterator));
+#else
+    StringTable::iterator iterator = stringTable().find<HashAndCharacters, HashAndCharactersTranslator>(buffer);
     if (iterator == stringTable().end())
         return 0;
     return static_cast<AtomicStringImpl*>(*iterator);
+#endif
 }
 
 void AtomicString::remove(StringImpl* r)
 {
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    StringTableShard& shard = stringTableShard(r->existingHash());
+    MutexLocker locker(shard.lock);
+    StringTable::iterator iterator = shard.table.find(r);
+    if (iterator != shard.table.end() && *iterator == r)
+        shard.table.remove(iterator);
+#else
     stringTable().remove(r);
+#endif
 }
 
 AtomicString AtomicString::lower() const
@@ -30,6 +30,11 @@
 
 namespace WTF {
 
+// Chunked builders only start new buffers once they are this long, and new
+// buffers stop doubling in length once they are maximumChunkLength long.
+static const unsigned minimumChunkLength = 4 * 1024;
+static const unsigned maximumChunkLength = 128 * 1024;
+
 void StringBuilder::reifyString()
 {
     // Check if the string already exists.
@@ -44,6 +49,9 @@ void StringBuilder::reifyString()
         return;
     }
 
+    if (!m_chunks.isEmpty())
+        joinChunks(m_length);
+
     // Must be valid in the buffer, take a substring (unless string fills the buffer).
     ASSERT(m_buffer && m_length <= m_buffer->length());
     m_string = (m_length == m_buffer->length())
@@ -59,6 +67,9 @@ void StringBuilder::resize(unsigned newSize)
         return;
     ASSERT(m_length);
 
+    if (newSize < m_chunkedLength)
+        joinChunks(m_length);
+
     // If there is a buffer, we only need to duplicate it if it has more than one ref.
     if (m_buffer) {
         if (!m_buffer->hasOneRef())
@@ -80,8 +91,8 @@ void StringBuilder::reserveCapacity(unsigned newCapacity)
 {
     if (m_buffer) {
         // If there is already a buffer, then grow if necessary.
-        if (newCapacity > m_buffer->length())
-            allocateBuffer(m_buffer->characters(), newCapacity);
+        if (newCapacity > m_chunkedLength + m_buffer->length())
+            allocateBuffer(m_buffer->characters(), newCapacity - m_chunkedLength);
     } else {
         // Grow the string, if necessary.
         if (newCapacity > m_length)
@@ -95,7 +106,7 @@ void StringBuilder::allocateBuffer(const UChar* currentCharacters, unsigned requ
 {
     // Copy the existing data into a new buffer, set result to point to the end of the existing data.
     RefPtr<StringImpl> buffer = StringImpl::createUninitialized(requiredLength, m_bufferCharacters);
-    memcpy(m_bufferCharacters, currentCharacters, static_cast<size_t>(m_length) * sizeof(UChar)); // This can't overflow.
+    memcpy(m_bufferCharacters, currentCharacters, static_cast<size_t>(m_length - m_chunkedLength) * sizeof(UChar)); // This can't overflow.
 
     // Update the builder state.
     m_buffer = buffer.release();
@@ -114,29 +125,64 @@ UChar* StringBuilder::appendUninitialized(unsigned length)
         CRASH();
 
     if (m_buffer) {
+        unsigned bufferLength = m_length - m_chunkedLength;
+        unsigned requiredBufferLength = requiredLength - m_chunkedLength;
+
         // If the buffer is valid it must be at least as long as the current builder contents!
-        ASSERT(m_buffer->length() >= m_length);
+        ASSERT(m_buffer->length() >= bufferLength);
 
         // Check if the buffer already has sufficient capacity.
-        if (requiredLength <= m_buffer->length()) {
-            unsigned currentLength = m_length;
+        if (requiredBufferLength <= m_buffer->length()) {
             m_string = String();
             m_length = requiredLength;
-            return m_bufferCharacters + currentLength;
+            return m_bufferCharacters + bufferLength;
+        }
+
+        // Keep a large buffer as a chunk rather than copying it.
+        if (m_usesChunks && bufferLength && m_buffer->length() >= minimumChunkLength) {
+            unsigned chunkLength = std::max(length, std::min(m_buffer->length() * 2, maximumChunkLength));
+            m_chunks.append(bufferLength == m_buffer->length() ? String(m_buffer) : String(StringImpl::create(m_buffer, 0, bufferLength)));
+            m_chunkedLength += bufferLength;
+            m_buffer = StringImpl::createUninitialized(chunkLength, m_bufferCharacters);
+            m_string = String();
+            m_length = requiredLength;
+            return m_bufferCharacters;
         }
 
         // We need to realloc the buffer.
-        allocateBuffer(m_buffer->characters(), std::max(requiredLength, m_buffer->length() * 2));
+        allocateBuffer(m_buffer->characters(), std::max(requiredBufferLength, m_buffer->length() * 2));
     } else {
         ASSERT(m_string.length() == m_length);
         allocateBuffer(m_string.characters(), std::max(requiredLength, requiredLength * 2));
     }
 
-    UChar* result = m_bufferCharacters + m_length;
+    UChar* result = m_bufferCharacters + m_length - m_chunkedLength;
     m_length = requiredLength;
     return result;
 }
 
+// Copy the chunks and the buffer into a single new buffer.
+void StringBuilder::joinChunks(unsigned capacity)
+{
+    ASSERT(!m_chunks.isEmpty());
+    ASSERT(capacity >= m_length);
+
+    UChar* characters;
+    RefPtr<StringImpl> buffer = StringImpl::createUninitialized(capacity, characters);
+    UChar* destination = characters;
+    for (size_t i = 0; i < m_chunks.size(); ++i) {
+        memcpy(destination, m_chunks[i].characters(), static_cast<size_t>(m_chunks[i].length()) * sizeof(UChar));
+        destination += m_chunks[i].length();
+    }
+    memcpy(destination, m_bufferCharacters, static_cast<size_t>(m_length - m_chunkedLength) * sizeof(UChar));
+
+    m_chunks.clear();
+    m_chunkedLength = 0;
+    m_buffer = buffer.release();
+    m_bufferCharacters = characters;
+    m_string = String();
+}
+
 void StringBuilder::append(const UChar* characters, unsigned length)
 {
     if (!length)
@@ -160,6 +206,12 @@ void StringBuilder::append(const char* characters, unsigned length)
 
 void StringBuilder::shrinkToFit()
 {
+    // Joining the chunks already makes a buffer of the right size.
+    if (!m_chunks.isEmpty()) {
+        joinChunks(m_length);
+        return;
+    }
+
     // If the buffer is at least 80% full, don't bother copying. Need to tune this heuristic!
     if (m_buffer && m_buffer->length() > (m_length + (m_length >> 2))) {
         UChar* result;
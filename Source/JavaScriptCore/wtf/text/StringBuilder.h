@@ -35,6 +35,8 @@ class StringBuilder {
 public:
     StringBuilder()
         : m_length(0)
+        , m_chunkedLength(0)
+        , m_usesChunks(false)
     {
     }
 
@@ -70,6 +72,13 @@ public:
             return;
         }
 
+        if (!other.m_chunks.isEmpty()) {
+            for (size_t i = 0; i < other.m_chunks.size(); ++i)
+                append(other.m_chunks[i]);
+            append(other.m_bufferCharacters, other.m_length - other.m_chunkedLength);
+            return;
+        }
+
         append(other.characters(), other.m_length);
     }
 
@@ -81,16 +90,20 @@ public:
 
     void append(UChar c)
     {
-        if (m_buffer && m_length < m_buffer->length() && m_string.isNull())
-            m_bufferCharacters[m_length++] = c;
+        if (m_buffer && m_length - m_chunkedLength < m_buffer->length() && m_string.isNull()) {
+            m_bufferCharacters[m_length - m_chunkedLength] = c;
+            ++m_length;
+        }
         else
             append(&c, 1);
     }
 
     void append(char c)
     {
-        if (m_buffer && m_length < m_buffer->length() && m_string.isNull())
-            m_bufferCharacters[m_length++] = (unsigned char)c;
+        if (m_buffer && m_length - m_chunkedLength < m_buffer->length() && m_string.isNull()) {
+            m_bufferCharacters[m_length - m_chunkedLength] = (unsigned char)c;
+            ++m_length;
+        }
         else
             append(&c, 1);
     }
@@ -111,6 +124,13 @@ public:
         return m_string;
     }
 
+    // Builders that may grow very large, such as those serializing a whole
+    // document, can keep their contents in several buffers.  Once the buffer
+    // holds a few thousand characters, appending to it when it is full starts
+    // a new buffer instead of copying everything into a larger one, and the
+    // buffers are joined with a single copy when the string is needed.
+    void setUsesChunks(bool usesChunks) { m_usesChunks = usesChunks; }
+
     unsigned length() const
     {
         return m_length;
@@ -130,9 +150,13 @@ public:
         if (!m_string.isNull())
             return m_string[i];
         ASSERT(m_buffer);
-        return m_buffer->characters()[i];
+        if (i < m_chunkedLength)
+            return characters()[i];
+        return m_bufferCharacters[i - m_chunkedLength];
     }
 
+    // Joins the chunks, if there are any, so avoid calling this while still
+    // appending to a large builder.
     const UChar* characters() const
     {
         if (!m_length)
@@ -140,6 +164,8 @@ public:
         if (!m_string.isNull())
             return m_string.characters();
         ASSERT(m_buffer);
+        if (!m_chunks.isEmpty())
+            const_cast<StringBuilder*>(this)->joinChunks(m_length);
         return m_buffer->characters();
     }
 
@@ -148,17 +174,25 @@ public:
         m_length = 0;
         m_string = String();
         m_buffer = 0;
+        m_chunks.clear();
+        m_chunkedLength = 0;
     }
 
 private:
     void allocateBuffer(const UChar* currentCharacters, unsigned requiredLength);
     UChar* appendUninitialized(unsigned length);
+    void joinChunks(unsigned capacity);
     void reifyString();
 
     unsigned m_length;
     String m_string;
     RefPtr<StringImpl> m_buffer;
     UChar* m_bufferCharacters;
+    // Full buffers that m_buffer follows, when m_usesChunks is set.  m_length
+    // counts their characters too, and m_chunkedLength counts only theirs.
+    Vector<String> m_chunks;
+    unsigned m_chunkedLength;
+    bool m_usesChunks;
 };
 
 } // namespace WTF
@@ -39,7 +39,12 @@ using namespace Unicode;
 
 static const unsigned minLengthToShare = 20;
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+// The ref count no longer shares a word with the flags.
+COMPILE_ASSERT(sizeof(StringImpl) == 2 * sizeof(int) + 4 * sizeof(void*), StringImpl_should_stay_small);
+#else
 COMPILE_ASSERT(sizeof(StringImpl) == 2 * sizeof(int) + 3 * sizeof(void*), StringImpl_should_stay_small);
+#endif
 
 StringImpl::~StringImpl()
 {
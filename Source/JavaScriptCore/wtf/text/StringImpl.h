@@ -227,9 +227,40 @@ public:
     unsigned hash() const { if (!m_hash) m_hash = StringHasher::computeHash(m_data, m_length); return m_hash; }
     unsigned existingHash() const { ASSERT(m_hash); return m_hash; }
 
-    ALWAYS_INLINE void deref() { --m_refCount; if (!m_refCount && !m_static) delete this; }
+    ALWAYS_INLINE void deref()
+    {
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+        if (m_atomic) {
+            if (!atomicDecrement(&m_refCount) && !m_static)
+                delete this;
+            return;
+        }
+#endif
+        --m_refCount;
+        if (!m_refCount && !m_static)
+            delete this;
+    }
     ALWAYS_INLINE bool hasOneRef() const { return (m_refCount == 1 && !m_static); }
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    // For the atomic string table, which can find a string another thread has
+    // just released. Refs the string unless it is already being destroyed.
+    bool tryRef()
+    {
+        ASSERT(m_atomic);
+        // Static strings are never destroyed, whatever their count.
+        if (m_static) {
+            ref();
+            return true;
+        }
+        while (int refCount = m_refCount) {
+            if (atomicCompareAndSwap(&m_refCount, refCount, refCount + 1))
+                return true;
+        }
+        return false;
+    }
+#endif
+
     static StringImpl* empty();
 
     static void copyChars(UChar* destination, const UChar* source, unsigned numCharacters)
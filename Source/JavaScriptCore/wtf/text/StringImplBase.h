@@ -28,6 +28,14 @@
 
 #include <wtf/unicode/Unicode.h>
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+#include <wtf/Atomics.h>
+
+#if !USE(LOCKFREE_ATOMICS)
+#error "SHARED_ATOMIC_STRING_TABLE requires lock-free atomics"
+#endif
+#endif
+
 namespace WTF {
 
 class StringImplBase {
@@ -35,7 +43,17 @@ class StringImplBase {
 public:
     bool isStringImpl() { return !(m_static && m_shouldReportCost); }
     unsigned length() const { return m_length; }
-    void ref() { ++m_refCount; }
+    void ref()
+    {
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+        // Atomic strings can be referenced from any thread.
+        if (m_atomic) {
+            atomicIncrement(&m_refCount);
+            return;
+        }
+#endif
+        ++m_refCount;
+    }
 
 protected:
     enum BufferOwnership {
@@ -101,7 +119,11 @@ protected:
     bool m_shouldReportCost  : 1;
     bool m_identifier : 1;
     unsigned m_bufferOwnership : 2;
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    int volatile m_refCount;
+#else
     unsigned m_refCount : 24;
+#endif
 
     unsigned m_length;
 };
@@ -24,6 +24,7 @@
 
 #include <stdarg.h>
 #include <wtf/ASCIICType.h>
+#include <wtf/MathExtras.h>
 #include <wtf/text/CString.h>
 #include <wtf/StringExtras.h>
 #include <wtf/Vector.h>
@@ -457,6 +458,38 @@ String String::number(unsigned long long n)
     
 String String::number(double n)
 {
+    // Most numbers formatted here, such as CSS lengths, have six significant
+    // digits or fewer.  Their shortest representation is then exactly what
+    // "%.6lg" prints, and dtoa() finds it much faster than printf does.
+    if (!isnan(n) && !isinf(n)) {
+        DtoaBuffer digits;
+        bool sign;
+        int exponent;
+        unsigned precision;
+        dtoa(digits, n, sign, exponent, precision);
+        if (precision <= 6 && exponent >= -4 && exponent < 6) {
+            char buffer[16];
+            unsigned length = 0;
+            // dtoa() drops the sign of zero, but printf keeps it.
+            if (sign || signbit(n))
+                buffer[length++] = '-';
+            if (exponent < 0) {
+                buffer[length++] = '0';
+                buffer[length++] = '.';
+                for (int i = -1; i > exponent; --i)
+                    buffer[length++] = '0';
+                for (unsigned i = 0; i < precision; ++i)
+                    buffer[length++] = digits[i];
+            } else {
+                for (unsigned i = 0; i <= static_cast<unsigned>(exponent) || i < precision; ++i) {
+                    if (i == static_cast<unsigned>(exponent) + 1)
+                        buffer[length++] = '.';
+                    buffer[length++] = i < precision ? digits[i] : '0';
+                }
+            }
+            return String(buffer, length);
+        }
+    }
     return String::format("%.6lg", n);
 }
 
@@ -93,8 +93,10 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 endif
 
 LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
+	css/SelectorFilter.cpp \
 	css/ShadowValue.cpp \
 	css/StyleBase.cpp \
+	css/StyleInvalidationSet.cpp \
 	css/StyleList.cpp \
 	css/StyleMedia.cpp \
 	css/StyleSheet.cpp \
@@ -163,6 +165,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	dom/NameNodeList.cpp \
 	dom/NamedNodeMap.cpp \
 	dom/Node.cpp \
+	dom/NodeArena.cpp \
 	dom/NodeFilter.cpp \
 	dom/NodeFilterCondition.cpp \
 	dom/NodeIterator.cpp \
@@ -919,6 +922,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	rendering/InlineFlowBox.cpp \
 	rendering/InlineTextBox.cpp \
 	rendering/LayoutState.cpp \
+	rendering/LineBreakCache.cpp \
 	rendering/PointerEventsHitRules.cpp \
 	rendering/RenderApplet.cpp \
 	rendering/RenderArena.cpp \
@@ -436,8 +436,10 @@ SOURCES += \
     css/MediaQueryListListener.cpp \
     css/MediaQueryMatcher.cpp \
     css/RGBColor.cpp \
+    css/SelectorFilter.cpp \
     css/ShadowValue.cpp \
     css/StyleBase.cpp \
+    css/StyleInvalidationSet.cpp \
     css/StyleList.cpp \
     css/StyleMedia.cpp \
     css/StyleSheet.cpp \
@@ -508,6 +510,7 @@ SOURCES += \
     dom/NamedNodeMap.cpp \
     dom/NameNodeList.cpp \
     dom/Node.cpp \
+    dom/NodeArena.cpp \
     dom/NodeFilterCondition.cpp \
     dom/NodeFilter.cpp \
     dom/NodeIterator.cpp \
@@ -1088,6 +1091,7 @@ SOURCES += \
     rendering/InlineFlowBox.cpp \
     rendering/InlineTextBox.cpp \
     rendering/LayoutState.cpp \
+    rendering/LineBreakCache.cpp \
     rendering/RenderApplet.cpp \
     rendering/RenderArena.cpp \
     rendering/RenderBlock.cpp \
@@ -1419,8 +1423,10 @@ HEADERS += \
     css/MediaQueryListListener.h \
     css/MediaQueryMatcher.h \
     css/RGBColor.h \
+    css/SelectorFilter.h \
     css/ShadowValue.h \
     css/StyleBase.h \
+    css/StyleInvalidationSet.h \
     css/StyleList.h \
     css/StyleMedia.h \
     css/StyleSheet.h \
@@ -1489,6 +1495,7 @@ HEADERS += \
     dom/MutationEvent.h \
     dom/NamedNodeMap.h \
     dom/NameNodeList.h \
+    dom/NodeArena.h \
     dom/NodeFilterCondition.h \
     dom/NodeFilter.h \
     dom/Node.h \
@@ -2091,6 +2098,7 @@ HEADERS += \
     rendering/InlineFlowBox.h \
     rendering/InlineTextBox.h \
     rendering/LayoutState.h \
+    rendering/LineBreakCache.h \
     rendering/mathml/RenderMathMLBlock.h \
     rendering/mathml/RenderMathMLFenced.h \
     rendering/mathml/RenderMathMLFraction.h \
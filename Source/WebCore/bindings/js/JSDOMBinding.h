@@ -234,7 +234,7 @@ namespace WebCore {
 
     AtomicString identifierToAtomicString(const JSC::Identifier&);
     AtomicString ustringToAtomicString(const JSC::UString&);
-    AtomicStringImpl* findAtomicString(const JSC::Identifier&);
+    PassRefPtr<AtomicStringImpl> findAtomicString(const JSC::Identifier&);
 
     String valueToStringWithNullCheck(JSC::ExecState*, JSC::JSValue); // null if the value is null
     String valueToStringWithUndefinedOrNullCheck(JSC::ExecState*, JSC::JSValue); // null if the value is null or undefined
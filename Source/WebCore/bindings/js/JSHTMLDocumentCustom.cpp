@@ -52,8 +52,8 @@ using namespace HTMLNames;
 
 bool JSHTMLDocument::canGetItemsForName(ExecState*, HTMLDocument* document, const Identifier& propertyName)
 {
-    AtomicStringImpl* atomicPropertyName = findAtomicString(propertyName);
-    return atomicPropertyName && (document->hasNamedItem(atomicPropertyName) || document->hasExtraNamedItem(atomicPropertyName));
+    RefPtr<AtomicStringImpl> atomicPropertyName = findAtomicString(propertyName);
+    return atomicPropertyName && (document->hasNamedItem(atomicPropertyName.get()) || document->hasExtraNamedItem(atomicPropertyName.get()));
 }
 
 JSValue JSHTMLDocument::nameGetter(ExecState* exec, JSValue slotBase, const Identifier& propertyName)
@@ -364,6 +364,29 @@ static inline bool isSimpleLengthPropertyID(int propertyId, bool& acceptsNegativ
     }
 }
 
+// Matches an optional sign followed by the tokenizer's num, [0-9]+|[0-9]*"."[0-9]+.
+// The fast paths check this before charactersToDouble(), which also accepts
+// exponents, hexadecimal, infinity and leading whitespace that the grammar rejects.
+static bool isCSSNumber(const UChar* characters, unsigned length)
+{
+    if (length && (characters[0] == '+' || characters[0] == '-')) {
+        ++characters;
+        --length;
+    }
+    unsigned i = 0;
+    while (i < length && isASCIIDigit(characters[i]))
+        ++i;
+    if (i < length && characters[i] == '.') {
+        ++i;
+        unsigned fractionStart = i;
+        while (i < length && isASCIIDigit(characters[i]))
+            ++i;
+        if (i == fractionStart)
+            return false;
+    }
+    return i && i == length;
+}
+
 static bool parseSimpleLengthValue(CSSMutableStyleDeclaration* declaration, int propertyId, const String& string, bool important, bool strict)
 {
     const UChar* characters = string.characters();
@@ -378,14 +401,16 @@ static bool parseSimpleLengthValue(CSSMutableStyleDeclaration* declaration, int
     if (length > 2 && characters[length - 2] == 'p' && characters[length - 1] == 'x') {
         length -= 2;
         unit = CSSPrimitiveValue::CSS_PX;
+    } else if (length > 2 && characters[length - 2] == 'e' && characters[length - 1] == 'm') {
+        length -= 2;
+        unit = CSSPrimitiveValue::CSS_EMS;
     } else if (length > 1 && characters[length - 1] == '%') {
         length -= 1;
         unit = CSSPrimitiveValue::CSS_PERCENTAGE;
     }
 
-    // We rely on charactersToDouble for validation as well. The function
-    // will set "ok" to "false" if the entire passed-in character range does
-    // not represent a double.
+    if (!isCSSNumber(characters, length))
+        return false;
     bool ok;
     double number = charactersToDouble(characters, length, &ok);
     if (!ok)
@@ -406,12 +431,288 @@ static bool parseSimpleLengthValue(CSSMutableStyleDeclaration* declaration, int
     return true;
 }
 
+static inline bool isKeywordPropertyID(int propertyId)
+{
+    switch (propertyId) {
+    case CSSPropertyBorderBottomStyle:
+    case CSSPropertyBorderCollapse:
+    case CSSPropertyBorderLeftStyle:
+    case CSSPropertyBorderRightStyle:
+    case CSSPropertyBorderTopStyle:
+    case CSSPropertyCaptionSide:
+    case CSSPropertyClear:
+    case CSSPropertyDirection:
+    case CSSPropertyDisplay:
+    case CSSPropertyEmptyCells:
+    case CSSPropertyFloat:
+    case CSSPropertyListStylePosition:
+    case CSSPropertyOutlineStyle:
+    case CSSPropertyOverflowX:
+    case CSSPropertyOverflowY:
+    case CSSPropertyPointerEvents:
+    case CSSPropertyPosition:
+    case CSSPropertyTableLayout:
+    case CSSPropertyTextTransform:
+    case CSSPropertyUnicodeBidi:
+    case CSSPropertyVisibility:
+    case CSSPropertyWebkitBackfaceVisibility:
+    case CSSPropertyWebkitTransformStyle:
+    case CSSPropertyWebkitUserModify:
+    case CSSPropertyWebkitUserSelect:
+    case CSSPropertyWhiteSpace:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Must accept exactly the identifiers the full parser accepts for each property in isKeywordPropertyID.
+static bool isValidKeywordPropertyAndValue(int propertyId, int valueID)
+{
+    switch (propertyId) {
+    case CSSPropertyBorderBottomStyle:
+    case CSSPropertyBorderLeftStyle:
+    case CSSPropertyBorderRightStyle:
+    case CSSPropertyBorderTopStyle:
+        return valueID >= CSSValueNone && valueID <= CSSValueDouble;
+    case CSSPropertyBorderCollapse:
+        return valueID == CSSValueCollapse || valueID == CSSValueSeparate;
+    case CSSPropertyCaptionSide:
+        return valueID == CSSValueLeft || valueID == CSSValueRight || valueID == CSSValueTop || valueID == CSSValueBottom;
+    case CSSPropertyClear:
+        return valueID == CSSValueNone || valueID == CSSValueLeft || valueID == CSSValueRight || valueID == CSSValueBoth;
+    case CSSPropertyDirection:
+        return valueID == CSSValueLtr || valueID == CSSValueRtl;
+    case CSSPropertyDisplay:
+#if ENABLE(WCSS)
+        return (valueID >= CSSValueInline && valueID <= CSSValueWapMarquee) || valueID == CSSValueNone;
+#else
+        return (valueID >= CSSValueInline && valueID <= CSSValueWebkitInlineBox) || valueID == CSSValueNone;
+#endif
+    case CSSPropertyEmptyCells:
+        return valueID == CSSValueShow || valueID == CSSValueHide;
+    case CSSPropertyFloat:
+        return valueID == CSSValueLeft || valueID == CSSValueRight || valueID == CSSValueNone || valueID == CSSValueCenter;
+    case CSSPropertyListStylePosition:
+        return valueID == CSSValueInside || valueID == CSSValueOutside;
+    case CSSPropertyOutlineStyle:
+        return valueID == CSSValueAuto || valueID == CSSValueNone || (valueID >= CSSValueInset && valueID <= CSSValueDouble);
+    case CSSPropertyOverflowX:
+    case CSSPropertyOverflowY:
+        return valueID == CSSValueVisible || valueID == CSSValueHidden || valueID == CSSValueScroll || valueID == CSSValueAuto
+            || valueID == CSSValueOverlay || valueID == CSSValueWebkitMarquee;
+    case CSSPropertyPointerEvents:
+        return valueID == CSSValueVisible || valueID == CSSValueNone || valueID == CSSValueAll || valueID == CSSValueAuto
+            || (valueID >= CSSValueVisiblepainted && valueID <= CSSValueStroke);
+    case CSSPropertyPosition:
+        return valueID == CSSValueStatic || valueID == CSSValueRelative || valueID == CSSValueAbsolute || valueID == CSSValueFixed;
+    case CSSPropertyTableLayout:
+        return valueID == CSSValueAuto || valueID == CSSValueFixed;
+    case CSSPropertyTextTransform:
+        return (valueID >= CSSValueCapitalize && valueID <= CSSValueLowercase) || valueID == CSSValueNone;
+    case CSSPropertyUnicodeBidi:
+        return valueID == CSSValueNormal || valueID == CSSValueEmbed || valueID == CSSValueBidiOverride || valueID == CSSValueWebkitIsolate;
+    case CSSPropertyVisibility:
+        return valueID == CSSValueVisible || valueID == CSSValueHidden || valueID == CSSValueCollapse;
+    case CSSPropertyWebkitBackfaceVisibility:
+        return valueID == CSSValueVisible || valueID == CSSValueHidden;
+    case CSSPropertyWebkitTransformStyle:
+        return valueID == CSSValueFlat || valueID == CSSValuePreserve3d;
+    case CSSPropertyWebkitUserModify:
+        return valueID == CSSValueReadOnly || valueID == CSSValueReadWrite || valueID == CSSValueReadWritePlaintextOnly;
+    case CSSPropertyWebkitUserSelect:
+        return valueID == CSSValueAuto || valueID == CSSValueNone || valueID == CSSValueText;
+    case CSSPropertyWhiteSpace:
+        return valueID == CSSValueNormal || valueID == CSSValuePre || valueID == CSSValuePreWrap || valueID == CSSValuePreLine || valueID == CSSValueNowrap;
+    default:
+        ASSERT_NOT_REACHED();
+        return false;
+    }
+}
+
+static bool parseKeywordValue(CSSMutableStyleDeclaration* declaration, int propertyId, const String& string, bool important)
+{
+    if (!string.length())
+        return false;
+    if (!isKeywordPropertyID(propertyId))
+        return false;
+    CSSParserString cssString;
+    cssString.characters = const_cast<UChar*>(string.characters());
+    cssString.length = string.length();
+    int valueID = cssValueKeywordID(cssString);
+    if (!valueID)
+        return false;
+
+    CSSStyleSheet* stylesheet = static_cast<CSSStyleSheet*>(declaration->stylesheet());
+    if (!stylesheet || !stylesheet->document())
+        return false;
+    RefPtr<CSSValue> value;
+    if (valueID == CSSValueInherit)
+        value = CSSInheritedValue::create();
+    else if (valueID == CSSValueInitial)
+        value = CSSInitialValue::createExplicit();
+    else if (isValidKeywordPropertyAndValue(propertyId, valueID))
+        value = stylesheet->document()->cssPrimitiveValueCache()->createIdentifierValue(valueID);
+    else
+        return false;
+    CSSProperty property(propertyId, value.release(), important);
+    declaration->addParsedProperty(property);
+    return true;
+}
+
+static bool parseOpacityValue(CSSMutableStyleDeclaration* declaration, int propertyId, const String& string, bool important)
+{
+    const UChar* characters = string.characters();
+    unsigned length = string.length();
+    if (!characters || !length)
+        return false;
+    if (propertyId != CSSPropertyOpacity)
+        return false;
+    if (!isCSSNumber(characters, length))
+        return false;
+
+    bool ok;
+    double number = charactersToDouble(characters, length, &ok);
+    if (!ok)
+        return false;
+
+    CSSStyleSheet* stylesheet = static_cast<CSSStyleSheet*>(declaration->stylesheet());
+    if (!stylesheet || !stylesheet->document())
+        return false;
+    CSSProperty property(propertyId, stylesheet->document()->cssPrimitiveValueCache()->createValue(number, CSSPrimitiveValue::CSS_NUMBER), important);
+    declaration->addParsedProperty(property);
+    return true;
+}
+
+static inline bool isCSSWhitespace(UChar c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+static bool parseTransformTranslateArgument(const UChar* characters, unsigned length, bool allowPercentage, double& number, CSSPrimitiveValue::UnitTypes& unit)
+{
+    while (length && isCSSWhitespace(*characters)) {
+        ++characters;
+        --length;
+    }
+    while (length && isCSSWhitespace(characters[length - 1]))
+        --length;
+
+    unit = CSSPrimitiveValue::CSS_NUMBER;
+    if (length > 2 && (characters[length - 2] | 0x20) == 'p' && (characters[length - 1] | 0x20) == 'x') {
+        length -= 2;
+        unit = CSSPrimitiveValue::CSS_PX;
+    } else if (length > 1 && characters[length - 1] == '%' && allowPercentage) {
+        length -= 1;
+        unit = CSSPrimitiveValue::CSS_PERCENTAGE;
+    }
+    if (!isCSSNumber(characters, length))
+        return false;
+
+    bool ok;
+    number = charactersToDouble(characters, length, &ok);
+    if (!ok)
+        return false;
+    // Transform arguments are always parsed strictly, so only zero may omit its unit.
+    if (unit == CSSPrimitiveValue::CSS_NUMBER) {
+        if (number)
+            return false;
+        unit = CSSPrimitiveValue::CSS_PX;
+    }
+    return true;
+}
+
+static bool parseTransformTranslateValue(CSSMutableStyleDeclaration* declaration, int propertyId, const String& string, bool important)
+{
+    const UChar* characters = string.characters();
+    unsigned length = string.length();
+    if (!characters || !length)
+        return false;
+    if (propertyId != CSSPropertyWebkitTransform)
+        return false;
+
+    CSSStyleSheet* stylesheet = static_cast<CSSStyleSheet*>(declaration->stylesheet());
+    if (!stylesheet || !stylesheet->document())
+        return false;
+    RefPtr<CSSPrimitiveValueCache> primitiveValueCache = stylesheet->document()->cssPrimitiveValueCache();
+    if (RefPtr<CSSValue> cachedValue = primitiveValueCache->cachedTransformValue(string)) {
+        CSSProperty property(propertyId, cachedValue.release(), important);
+        declaration->addParsedProperty(property);
+        return true;
+    }
+
+    // Only a single translate function is handled here; lists of functions go through the full parser.
+    static const unsigned maximumArgumentCount = 3;
+    WebKitCSSTransformValue::TransformOperationType type;
+    unsigned minimumArguments = 1;
+    unsigned maximumArguments = 1;
+    unsigned nameLength;
+    if (length > 11 && equalIgnoringCase(characters, "translatex(", 11)) {
+        type = WebKitCSSTransformValue::TranslateXTransformOperation;
+        nameLength = 11;
+    } else if (length > 11 && equalIgnoringCase(characters, "translatey(", 11)) {
+        type = WebKitCSSTransformValue::TranslateYTransformOperation;
+        nameLength = 11;
+    } else if (length > 11 && equalIgnoringCase(characters, "translatez(", 11)) {
+        type = WebKitCSSTransformValue::TranslateZTransformOperation;
+        nameLength = 11;
+    } else if (length > 12 && equalIgnoringCase(characters, "translate3d(", 12)) {
+        type = WebKitCSSTransformValue::Translate3DTransformOperation;
+        minimumArguments = maximumArguments = 3;
+        nameLength = 12;
+    } else if (length > 10 && equalIgnoringCase(characters, "translate(", 10)) {
+        type = WebKitCSSTransformValue::TranslateTransformOperation;
+        maximumArguments = 2;
+        nameLength = 10;
+    } else
+        return false;
+    if (characters[length - 1] != ')')
+        return false;
+
+    double numbers[maximumArgumentCount];
+    CSSPrimitiveValue::UnitTypes units[maximumArgumentCount];
+    unsigned argumentCount = 0;
+    unsigned argumentStart = nameLength;
+    for (unsigned i = nameLength; i < length; ++i) {
+        UChar c = characters[i];
+        if (c != ',' && c != ')')
+            continue;
+        if (argumentCount == maximumArguments || (c == ')' && i != length - 1))
+            return false;
+        // translateZ() and the z component of translate3d() cannot be percentages.
+        bool allowPercentage = type != WebKitCSSTransformValue::TranslateZTransformOperation && argumentCount != 2;
+        if (!parseTransformTranslateArgument(characters + argumentStart, i - argumentStart, allowPercentage, numbers[argumentCount], units[argumentCount]))
+            return false;
+        ++argumentCount;
+        argumentStart = i + 1;
+    }
+    if (argumentCount < minimumArguments)
+        return false;
+
+    RefPtr<WebKitCSSTransformValue> transformValue = WebKitCSSTransformValue::create(type);
+    for (unsigned i = 0; i < argumentCount; ++i)
+        transformValue->append(primitiveValueCache->createValue(numbers[i], units[i]));
+    RefPtr<CSSValueList> list = CSSValueList::createSpaceSeparated();
+    list->append(transformValue.release());
+    primitiveValueCache->addTransformValue(string, list);
+
+    CSSProperty property(propertyId, list.release(), important);
+    declaration->addParsedProperty(property);
+    return true;
+}
+
 bool CSSParser::parseValue(CSSMutableStyleDeclaration* declaration, int propertyId, const String& string, bool important, bool strict)
 {
     if (parseSimpleLengthValue(declaration, propertyId, string, important, strict))
         return true;
     if (parseColorValue(declaration, propertyId, string, important, strict))
         return true;
+    if (parseKeywordValue(declaration, propertyId, string, important))
+        return true;
+    if (parseOpacityValue(declaration, propertyId, string, important))
+        return true;
+    if (parseTransformTranslateValue(declaration, propertyId, string, important))
+        return true;
     CSSParser parser(strict);
     return parser.parseValue(declaration, propertyId, string, important);
 }
@@ -116,4 +116,18 @@ PassRefPtr<CSSPrimitiveValue> CSSPrimitiveValueCache::createValue(double value,
     return entry.first->second;
 }
 
+PassRefPtr<CSSValue> CSSPrimitiveValueCache::cachedTransformValue(const String& string) const
+{
+    return m_transformValueCache.get(string);
+}
+
+void CSSPrimitiveValueCache::addTransformValue(const String& string, PassRefPtr<CSSValue> value)
+{
+    // Animations produce a new string every frame, so keep the cache small.
+    const unsigned maximumTransformCacheSize = 256;
+    if (m_transformValueCache.size() > maximumTransformCacheSize)
+        m_transformValueCache.clear();
+    m_transformValueCache.set(string, value);
+}
+
 }
@@ -30,6 +30,7 @@
 #include "CSSValueKeywords.h"
 #include <wtf/HashMap.h>
 #include <wtf/RefPtr.h>
+#include <wtf/text/StringHash.h>
 
 namespace WebCore {
     
@@ -45,6 +46,10 @@ public:
     PassRefPtr<CSSPrimitiveValue> createValue(double value, CSSPrimitiveValue::UnitTypes);
     PassRefPtr<CSSPrimitiveValue> createValue(String value, CSSPrimitiveValue::UnitTypes type) { return CSSPrimitiveValue::create(value, type); }
     template<typename T> static PassRefPtr<CSSPrimitiveValue> createValue(T value) { return CSSPrimitiveValue::create(value); }
+
+    // Transform values are immutable lists, so a string set repeatedly through the CSSOM can share one parse.
+    PassRefPtr<CSSValue> cachedTransformValue(const String&) const;
+    void addTransformValue(const String&, PassRefPtr<CSSValue>);
     
 private:
     CSSPrimitiveValueCache();
@@ -65,6 +70,9 @@ private:
     IntegerValueCache m_pixelValueCache;
     IntegerValueCache m_percentValueCache;
     IntegerValueCache m_numberValueCache;
+
+    typedef HashMap<String, RefPtr<CSSValue> > TransformValueCache;
+    TransformValueCache m_transformValueCache;
 };
 
 }
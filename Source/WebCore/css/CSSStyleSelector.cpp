@@ -89,6 +89,7 @@
 #include "StyleCachedImage.h"
 #include "StylePendingImage.h"
 #include "StyleGeneratedImage.h"
+#include "StyleInvalidationSet.h"
 #include "StyleSheetList.h"
 #include "Text.h"
 #include "TransformationMatrix.h"
@@ -299,23 +300,20 @@ public:
     bool hasTopSelectorMatchingHTMLBasedOnRuleHash() const { return m_hasTopSelectorMatchingHTMLBasedOnRuleHash; }
     unsigned specificity() const { return m_specificity; }
     
-    // Try to balance between memory usage (there can be lots of RuleData objects) and good filtering performance.
-    static const unsigned maximumIdentifierCount = 4;
     const unsigned* descendantSelectorIdentifierHashes() const { return m_descendantSelectorIdentifierHashes; }
+    unsigned descendantSelectorAttributeHashMask() const { return m_descendantSelectorAttributeHashMask; }
 
 private:
-    void collectDescendantSelectorIdentifierHashes();
-    void collectIdentifierHashes(const CSSSelector*, unsigned& identifierCount);
-    
     CSSStyleRule* m_rule;
     CSSSelector* m_selector;
     unsigned m_specificity;
-    unsigned m_position : 29;
+    unsigned m_position : 25;
     bool m_hasFastCheckableSelector : 1;
     bool m_hasMultipartSelector : 1;
     bool m_hasTopSelectorMatchingHTMLBasedOnRuleHash : 1;
+    unsigned m_descendantSelectorAttributeHashMask : SelectorFilter::maximumIdentifierCount;
     // Use plain array instead of a Vector to minimize memory overhead.
-    unsigned m_descendantSelectorIdentifierHashes[maximumIdentifierCount];
+    unsigned m_descendantSelectorIdentifierHashes[SelectorFilter::maximumIdentifierCount];
 };
 
 class RuleSet {
@@ -603,86 +601,17 @@ static void loadViewSourceStyle()
     defaultViewSourceStyle->addRulesFromSheet(parseUASheet(sourceUserAgentStyleSheet, sizeof(sourceUserAgentStyleSheet)), screenEval());
 }
     
-static inline void collectElementIdentifierHashes(const Element* element, Vector<unsigned, 4>& identifierHashes)
-{
-    identifierHashes.append(element->localName().impl()->existingHash());
-    if (element->hasID())
-        identifierHashes.append(element->idForStyleResolution().impl()->existingHash());
-    const StyledElement* styledElement = element->isStyledElement() ? static_cast<const StyledElement*>(element) : 0;
-    if (styledElement && styledElement->hasClass()) {
-        const SpaceSplitString& classNames = styledElement->classNames();
-        size_t count = classNames.size();
-        for (size_t i = 0; i < count; ++i)
-            identifierHashes.append(classNames[i].impl()->existingHash());
-    }
-}
-
-void CSSStyleSelector::pushParentStackFrame(Element* parent)
-{
-    ASSERT(m_ancestorIdentifierFilter);
-    ASSERT(m_parentStack.isEmpty() || m_parentStack.last().element == parent->parentElement());
-    ASSERT(!m_parentStack.isEmpty() || !parent->parentElement());
-    m_parentStack.append(ParentStackFrame(parent));
-    ParentStackFrame& parentFrame = m_parentStack.last();
-    // Mix tags, class names and ids into some sort of weird bouillabaisse.
-    // The filter is used for fast rejection of child and descendant selectors.
-    collectElementIdentifierHashes(parent, parentFrame.identifierHashes);
-    size_t count = parentFrame.identifierHashes.size();
-    for (size_t i = 0; i < count; ++i)
-        m_ancestorIdentifierFilter->add(parentFrame.identifierHashes[i]);
-}
-
-void CSSStyleSelector::popParentStackFrame()
-{
-    ASSERT(!m_parentStack.isEmpty());
-    ASSERT(m_ancestorIdentifierFilter);
-    const ParentStackFrame& parentFrame = m_parentStack.last();
-    size_t count = parentFrame.identifierHashes.size();
-    for (size_t i = 0; i < count; ++i)
-        m_ancestorIdentifierFilter->remove(parentFrame.identifierHashes[i]);
-    m_parentStack.removeLast();
-    if (m_parentStack.isEmpty()) {
-        ASSERT(m_ancestorIdentifierFilter->likelyEmpty());
-        m_ancestorIdentifierFilter.clear();
-    }
-}
-
 void CSSStyleSelector::pushParent(Element* parent)
 {
-    if (m_parentStack.isEmpty()) {
-        ASSERT(!m_ancestorIdentifierFilter);
-        m_ancestorIdentifierFilter = adoptPtr(new BloomFilter<bloomFilterKeyBits>);
-        // If the element is not the root itself, build the stack starting from the root.
-        if (parent->parentElement()) {
-            Vector<Element*, 30> ancestors;
-            for (Element* ancestor = parent; ancestor; ancestor = ancestor->parentElement())
-                ancestors.append(ancestor);
-            int count = ancestors.size();
-            for (int n = count - 1; n >= 0; --n)
-                pushParentStackFrame(ancestors[n]);
-            return;
-        }
-    } else if (!parent->parentElement()) {
-        // We are not always invoked consistently. For example, script execution can cause us to enter
-        // style recalc in the middle of tree building. Reset the stack if we see a new root element.
-        ASSERT(m_ancestorIdentifierFilter);
-        m_ancestorIdentifierFilter->clear();
-        m_parentStack.resize(0);
-    } else {
-        ASSERT(m_ancestorIdentifierFilter);
-        // We may get invoked for some random elements in some wacky cases during style resolve.
-        // Pause maintaining the stack in this case.
-        if (m_parentStack.last().element != parent->parentElement())
-            return;
-    }
-    pushParentStackFrame(parent);
+    // The filter only follows elements in the document; elementRemoved() keeps it from holding removed ones.
+    if (!parent->inDocument())
+        return;
+    m_selectorFilter.pushParent(parent);
 }
 
 void CSSStyleSelector::popParent(Element* parent)
 {
-    if (m_parentStack.isEmpty() || m_parentStack.last().element != parent)
-        return;
-    popParentStackFrame();
+    m_selectorFilter.popParent(parent);
 }
 
 void CSSStyleSelector::addMatchedDeclaration(CSSMutableStyleDeclaration* decl)
@@ -735,30 +664,29 @@ void CSSStyleSelector::matchRules(RuleSet* rules, int& firstRuleIndex, int& last
     }
 }
 
-inline bool CSSStyleSelector::fastRejectSelector(const RuleData& ruleData) const
-{
-    ASSERT(m_ancestorIdentifierFilter);
-    const unsigned* descendantSelectorIdentifierHashes = ruleData.descendantSelectorIdentifierHashes();
-    for (unsigned n = 0; n < RuleData::maximumIdentifierCount && descendantSelectorIdentifierHashes[n]; ++n) {
-        if (!m_ancestorIdentifierFilter->mayContain(descendantSelectorIdentifierHashes[n]))
-            return true;
-    }
-    return false;
-}
-
 void CSSStyleSelector::matchRulesForList(const Vector<RuleData>* rules, int& firstRuleIndex, int& lastRuleIndex, bool includeEmptyRules)
 {
     if (!rules)
         return;
-    // In some cases we may end up looking up style for random elements in the middle of a recursive tree resolve.
+    // Elements outside the document are resolved without a matching ancestor chain.
     // Ancestor identifier filter won't be up-to-date in that case and we can't use the fast path.
-    bool canUseFastReject = !m_parentStack.isEmpty() && m_parentStack.last().element == m_parentNode;
+    bool canUseFastReject = m_selectorFilter.parentStackIsConsistent(m_parentNode);
 
     unsigned size = rules->size();
     for (unsigned i = 0; i < size; ++i) {
         const RuleData& ruleData = rules->at(i);
-        if (canUseFastReject && fastRejectSelector(ruleData))
+        if (canUseFastReject && m_selectorFilter.fastRejectSelector(ruleData.descendantSelectorIdentifierHashes(), ruleData.descendantSelectorAttributeHashMask())) {
+#ifndef NDEBUG
+            ++SelectorFilter::statistics().fastRejects;
+#endif
             continue;
+        }
+#ifndef NDEBUG
+        if (canUseFastReject)
+            ++SelectorFilter::statistics().filteredChecks;
+        else
+            ++SelectorFilter::statistics().unfilteredChecks;
+#endif
         if (checkSelector(ruleData)) {
             // If the rule has no properties to apply, then ignore it in the non-debug mode.
             CSSStyleRule* rule = ruleData.rule();
@@ -1264,6 +1192,11 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
             return sharedStyle;
     }
 
+    // Style is also resolved outside of tree walks, for example when a subtree is attached or
+    // computed style is requested. Realign the kept ancestor chain so the fast path still applies.
+    if (m_parentNode && m_parentNode == e->parentElement() && e->inDocument() && !m_selectorFilter.parentStackIsConsistent(m_parentNode))
+        m_selectorFilter.pushParent(e->parentElement());
+
     // Compute our style allowing :visited to match first.
     RefPtr<RenderStyle> visitedStyle;
     if (!matchVisitedPseudoClass && m_parentStyle && (m_parentStyle->insideLink() || e->isLink()) && e->document()->usesLinkRules()) {
@@ -3054,50 +2987,9 @@ RuleData::RuleData(CSSStyleRule* rule, CSSSelector* selector, unsigned position)
     , m_hasMultipartSelector(selector->tagHistory())
     , m_hasTopSelectorMatchingHTMLBasedOnRuleHash(isSelectorMatchingHTMLBasedOnRuleHash(selector))
 {
-    collectDescendantSelectorIdentifierHashes();
-}
-
-inline void RuleData::collectIdentifierHashes(const CSSSelector* selector, unsigned& identifierCount)
-{
-    if ((selector->m_match == CSSSelector::Id || selector->m_match == CSSSelector::Class) && !selector->value().isEmpty())
-        m_descendantSelectorIdentifierHashes[identifierCount++] = selector->value().impl()->existingHash();
-    if (identifierCount == maximumIdentifierCount)
-        return;
-    const AtomicString& localName = selector->tag().localName();
-    if (localName != starAtom)
-        m_descendantSelectorIdentifierHashes[identifierCount++] = localName.impl()->existingHash();
-}
-
-inline void RuleData::collectDescendantSelectorIdentifierHashes()
-{
-    unsigned identifierCount = 0;
-    CSSSelector::Relation relation = m_selector->relation();
-    
-    // Skip the topmost selector. It is handled quickly by the rule hashes.    
-    bool skipOverSubselectors = true;
-    for (const CSSSelector* selector = m_selector->tagHistory(); selector; selector = selector->tagHistory()) {
-        // Only collect identifiers that match ancestors.
-        switch (relation) {
-        case CSSSelector::SubSelector:
-            if (!skipOverSubselectors)
-                collectIdentifierHashes(selector, identifierCount);
-            break;
-        case CSSSelector::DirectAdjacent:
-        case CSSSelector::IndirectAdjacent:
-        case CSSSelector::ShadowDescendant:
-            skipOverSubselectors = true;
-            break;
-        case CSSSelector::Descendant:
-        case CSSSelector::Child:
-            skipOverSubselectors = false;
-            collectIdentifierHashes(selector, identifierCount);
-            break;
-        }
-        if (identifierCount == maximumIdentifierCount)
-            return;
-        relation = selector->relation();
-    }
-    m_descendantSelectorIdentifierHashes[identifierCount] = 0;
+    unsigned attributeHashMask;
+    SelectorFilter::collectIdentifierHashes(m_selector, m_descendantSelectorIdentifierHashes, attributeHashMask);
+    m_descendantSelectorAttributeHashMask = attributeHashMask;
 }
 
 RuleSet::RuleSet()
@@ -3242,6 +3134,140 @@ static inline void collectFeaturesFromSelector(CSSStyleSelector::Features& featu
     }
 }
 
+// What an identifier in one compound selector invalidates when it appears on or
+// disappears from an element.
+struct InvalidationTarget {
+    InvalidationTarget()
+        : invalidatesSelf(false)
+        , invalidatesWholeSubtree(false)
+        , siblingReach(0)
+        , descendantClass(0)
+        , descendantId(0)
+        , descendantTagName(0)
+    {
+    }
+
+    bool invalidatesSelf;
+    bool invalidatesWholeSubtree;
+    unsigned siblingReach;
+    AtomicStringImpl* descendantClass;
+    AtomicStringImpl* descendantId;
+    AtomicStringImpl* descendantTagName;
+};
+
+static inline bool isAttributeSelector(const CSSSelector* selector)
+{
+    switch (selector->m_match) {
+    case CSSSelector::Exact:
+    case CSSSelector::Set:
+    case CSSSelector::List:
+    case CSSSelector::Hyphen:
+    case CSSSelector::Contain:
+    case CSSSelector::Begin:
+    case CSSSelector::End:
+        return selector->hasAttribute();
+    default:
+        return false;
+    }
+}
+
+static void addInvalidation(CSSStyleSelector::Features::InvalidationSetMap& map, AtomicStringImpl* key, const InvalidationTarget& target)
+{
+    pair<CSSStyleSelector::Features::InvalidationSetMap::iterator, bool> result = map.add(key, 0);
+    if (result.second)
+        result.first->second = StyleInvalidationSet::create();
+    StyleInvalidationSet* invalidationSet = result.first->second.get();
+    if (target.invalidatesSelf)
+        invalidationSet->setInvalidatesSelf();
+    if (target.invalidatesWholeSubtree)
+        invalidationSet->setInvalidatesWholeSubtree();
+    if (target.siblingReach)
+        invalidationSet->addSiblingReach(target.siblingReach);
+    if (target.descendantClass)
+        invalidationSet->addDescendantClass(target.descendantClass);
+    else if (target.descendantId)
+        invalidationSet->addDescendantId(target.descendantId);
+    else if (target.descendantTagName)
+        invalidationSet->addDescendantTagName(target.descendantTagName);
+}
+
+static void collectInvalidationSetsFromSimpleSelector(CSSStyleSelector::Features& features, const CSSSelector* selector, const InvalidationTarget& target)
+{
+    if (selector->m_match == CSSSelector::Class && !selector->value().isEmpty())
+        addInvalidation(features.classInvalidationSets, selector->value().impl(), target);
+    else if (selector->m_match == CSSSelector::Id && !selector->value().isEmpty())
+        addInvalidation(features.idInvalidationSets, selector->value().impl(), target);
+    else if (isAttributeSelector(selector))
+        addInvalidation(features.attributeInvalidationSets, selector->attribute().localName().lower().impl(), target);
+
+    // The identifiers inside :not() and :-webkit-any() belong to the same compound selector.
+    if (CSSSelectorList* selectorList = selector->selectorList()) {
+        for (CSSSelector* subSelector = selectorList->first(); subSelector; subSelector = CSSSelectorList::next(subSelector)) {
+            for (const CSSSelector* simpleSelector = subSelector; simpleSelector; simpleSelector = simpleSelector->tagHistory())
+                collectInvalidationSetsFromSimpleSelector(features, simpleSelector, target);
+        }
+    }
+}
+
+static void collectInvalidationSets(CSSStyleSelector::Features& features, const CSSSelector* rightmostSelector)
+{
+    // Descendants that may change are found by an identifier of the rightmost compound
+    // selector, preferring the most selective one. Without one, and for rules reaching
+    // into shadow trees, the whole subtree may change.
+    InvalidationTarget descendantTarget;
+    for (const CSSSelector* selector = rightmostSelector; selector; selector = selector->tagHistory()) {
+        if (selector->relation() == CSSSelector::ShadowDescendant)
+            descendantTarget.invalidatesWholeSubtree = true;
+    }
+    if (!descendantTarget.invalidatesWholeSubtree) {
+        for (const CSSSelector* selector = rightmostSelector; selector; selector = selector->tagHistory()) {
+            if (selector->m_match == CSSSelector::Class && !selector->value().isEmpty())
+                descendantTarget.descendantClass = selector->value().impl();
+            else if (selector->m_match == CSSSelector::Id && !selector->value().isEmpty())
+                descendantTarget.descendantId = selector->value().impl();
+            if (selector->tag().localName() != starAtom)
+                descendantTarget.descendantTagName = selector->tag().localName().impl();
+            if (selector->relation() != CSSSelector::SubSelector)
+                break;
+        }
+        if (!descendantTarget.descendantClass && !descendantTarget.descendantId && !descendantTarget.descendantTagName)
+            descendantTarget.invalidatesWholeSubtree = true;
+    }
+
+    InvalidationTarget selfTarget;
+    selfTarget.invalidatesSelf = true;
+
+    const InvalidationTarget* target = &selfTarget;
+    InvalidationTarget siblingTarget;
+    for (const CSSSelector* selector = rightmostSelector; selector; selector = selector->tagHistory()) {
+        collectInvalidationSetsFromSimpleSelector(features, selector, *target);
+
+        // A combinator starts the compound selector to the left. Identifiers there affect
+        // the descendants of their element, or a run of following siblings and everything
+        // below them.
+        switch (selector->relation()) {
+        case CSSSelector::SubSelector:
+            break;
+        case CSSSelector::Descendant:
+        case CSSSelector::Child:
+        case CSSSelector::ShadowDescendant:
+            target = &descendantTarget;
+            break;
+        case CSSSelector::DirectAdjacent:
+            if (target != &siblingTarget)
+                siblingTarget.siblingReach = 0;
+            if (siblingTarget.siblingReach != StyleInvalidationSet::unboundedSiblingReach)
+                ++siblingTarget.siblingReach;
+            target = &siblingTarget;
+            break;
+        case CSSSelector::IndirectAdjacent:
+            siblingTarget.siblingReach = StyleInvalidationSet::unboundedSiblingReach;
+            target = &siblingTarget;
+            break;
+        }
+    }
+}
+
 static void collectFeaturesFromList(CSSStyleSelector::Features& features, const Vector<RuleData>& rules)
 {
     unsigned size = rules.size();
@@ -3265,6 +3291,7 @@ static void collectFeaturesFromList(CSSStyleSelector::Features& features, const
                 features.siblingRules = adoptPtr(new RuleSet);
             features.siblingRules->addRule(ruleData.rule(), ruleData.selector());   
         }
+        collectInvalidationSets(features, ruleData.selector());
     }
 }
 
@@ -4533,6 +4560,7 @@ void CSSStyleSelector::applyProperty(int id, CSSValue *value)
                 didSet = true;
                 // register the fact that the attribute value affects the style
                 m_selectorAttrs.add(attr.localName().impl());
+                m_contentAttrs.add(attr.localName().impl());
                 break;
             }
             case CSSPrimitiveValue::CSS_URI: {
@@ -7018,6 +7046,81 @@ bool CSSStyleSelector::hasSelectorForAttribute(const AtomicString &attrname) con
     return m_selectorAttrs.contains(attrname.impl());
 }
 
+// The default style sheets are not part of m_features, and grow as new kinds of elements
+// are styled. Identifiers they use fall back to a full recalc of the changed element.
+static const CSSStyleSelector::Features& featuresInDefaultStyle()
+{
+    static CSSStyleSelector::Features* features;
+    static unsigned collectedRuleCount;
+    unsigned ruleCount = defaultStyle->m_ruleCount + defaultQuirksStyle->m_ruleCount + defaultPrintStyle->m_ruleCount;
+    if (defaultViewSourceStyle)
+        ruleCount += defaultViewSourceStyle->m_ruleCount;
+    if (!features || ruleCount != collectedRuleCount) {
+        delete features;
+        features = new CSSStyleSelector::Features;
+        defaultStyle->collectFeatures(*features);
+        defaultQuirksStyle->collectFeatures(*features);
+        defaultPrintStyle->collectFeatures(*features);
+        if (defaultViewSourceStyle)
+            defaultViewSourceStyle->collectFeatures(*features);
+        collectedRuleCount = ruleCount;
+    }
+    return *features;
+}
+
+static inline bool collectInvalidationSet(const CSSStyleSelector::Features::InvalidationSetMap& map, const CSSStyleSelector::Features::InvalidationSetMap& defaultStyleMap, AtomicStringImpl* key, Vector<StyleInvalidationSet*, 8>& invalidationSets)
+{
+    if (defaultStyleMap.contains(key))
+        return false;
+    if (StyleInvalidationSet* invalidationSet = map.get(key).get())
+        invalidationSets.append(invalidationSet);
+    return true;
+}
+
+void CSSStyleSelector::invalidateStyleForClassChange(Element* element, const Vector<AtomicString, 8>& changedClasses)
+{
+    const Features& defaultStyleFeatures = featuresInDefaultStyle();
+    Vector<StyleInvalidationSet*, 8> invalidationSets;
+    size_t count = changedClasses.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (!collectInvalidationSet(m_features.classInvalidationSets, defaultStyleFeatures.classInvalidationSets, changedClasses[i].impl(), invalidationSets)) {
+            element->setNeedsStyleRecalc();
+            return;
+        }
+    }
+    if (!invalidationSets.isEmpty())
+        StyleInvalidationSet::invalidate(element, invalidationSets);
+}
+
+void CSSStyleSelector::invalidateStyleForIdChange(Element* element, const AtomicString& oldId, const AtomicString& newId)
+{
+    const Features& defaultStyleFeatures = featuresInDefaultStyle();
+    Vector<StyleInvalidationSet*, 8> invalidationSets;
+    if ((!oldId.isEmpty() && !collectInvalidationSet(m_features.idInvalidationSets, defaultStyleFeatures.idInvalidationSets, oldId.impl(), invalidationSets))
+        || (!newId.isEmpty() && !collectInvalidationSet(m_features.idInvalidationSets, defaultStyleFeatures.idInvalidationSets, newId.impl(), invalidationSets))) {
+        element->setNeedsStyleRecalc();
+        return;
+    }
+    if (!invalidationSets.isEmpty())
+        StyleInvalidationSet::invalidate(element, invalidationSets);
+}
+
+void CSSStyleSelector::invalidateStyleForAttributeChange(Element* element, const QualifiedName& name)
+{
+    if (m_contentAttrs.contains(name.localName().impl())) {
+        element->setNeedsStyleRecalc();
+        return;
+    }
+    Vector<StyleInvalidationSet*, 8> invalidationSets;
+    if (!collectInvalidationSet(m_features.attributeInvalidationSets, featuresInDefaultStyle().attributeInvalidationSets, name.localName().lower().impl(), invalidationSets)) {
+        if (hasSelectorForAttribute(name.localName()))
+            element->setNeedsStyleRecalc();
+        return;
+    }
+    if (!invalidationSets.isEmpty())
+        StyleInvalidationSet::invalidate(element, invalidationSets);
+}
+
 void CSSStyleSelector::addViewportDependentMediaQueryResult(const MediaQueryExp* expr, bool result)
 {
     m_viewportDependentMediaQueryResults.append(new MediaQueryResult(*expr, result));
@@ -27,7 +27,7 @@
 #include "LinkHash.h"
 #include "MediaQueryExp.h"
 #include "RenderStyle.h"
-#include <wtf/BloomFilter.h>
+#include "SelectorFilter.h"
 #include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
 #include <wtf/RefPtr.h>
@@ -60,10 +60,12 @@ class KeyframeList;
 class KeyframeValue;
 class MediaQueryEvaluator;
 class Node;
+class QualifiedName;
 class RuleData;
 class RuleSet;
 class Settings;
 class StyleImage;
+class StyleInvalidationSet;
 class StyleSheet;
 class StyleSheetList;
 class StyledElement;
@@ -96,7 +98,7 @@ public:
         // Using these during tree walk will allow style selector to optimize child and descendant selector lookups.
         void pushParent(Element* parent);
         void popParent(Element* parent);
-
+        SelectorFilter& selectorFilter() { return m_selectorFilter; }
 
         PassRefPtr<RenderStyle> styleForElement(Element* e, RenderStyle* parentStyle = 0, bool allowSharing = true, bool resolveForRootDefault = false, bool matchVisitedPseudoClass = false);
         
@@ -126,9 +128,6 @@ public:
         Node* locateCousinList(Element* parent, unsigned& visitedNodeCount) const;
         Node* findSiblingForStyleSharing(Node*, unsigned& count) const;
         bool canShareStyleWithElement(Node*) const;
-        
-        void pushParentStackFrame(Element* parent);
-        void popParentStackFrame();
 
         PassRefPtr<RenderStyle> styleForKeyframe(const RenderStyle*, const WebKitCSSKeyframeRule*, KeyframeValue&);
 
@@ -165,6 +164,12 @@ public:
         Color getColorFromPrimitiveValue(CSSPrimitiveValue*) const;
 
         bool hasSelectorForAttribute(const AtomicString&) const;
+
+        // Mark only the elements that may start or stop matching a rule because classes,
+        // the id or an attribute changed on the given element.
+        void invalidateStyleForClassChange(Element*, const Vector<AtomicString, 8>& changedClasses);
+        void invalidateStyleForIdChange(Element*, const AtomicString& oldId, const AtomicString& newId);
+        void invalidateStyleForAttributeChange(Element*, const QualifiedName&);
  
         CSSFontSelector* fontSelector() const { return m_fontSelector.get(); }
 
@@ -193,6 +198,11 @@ public:
             bool usesFirstLineRules;
             bool usesBeforeAfterRules;
             bool usesLinkRules;
+            // Keyed by class name, id and lowercased attribute name.
+            typedef HashMap<AtomicStringImpl*, RefPtr<StyleInvalidationSet> > InvalidationSetMap;
+            InvalidationSetMap classInvalidationSets;
+            InvalidationSetMap idInvalidationSets;
+            InvalidationSetMap attributeInvalidationSets;
         };
 
     private:
@@ -210,7 +220,6 @@ public:
 
         void matchRules(RuleSet*, int& firstRuleIndex, int& lastRuleIndex, bool includeEmptyRules);
         void matchRulesForList(const Vector<RuleData>*, int& firstRuleIndex, int& lastRuleIndex, bool includeEmptyRules);
-        bool fastRejectSelector(const RuleData&) const;
         void sortMatchedRules();
         
         bool checkSelector(const RuleData&);
@@ -230,17 +239,7 @@ public:
 
         Features m_features;
 
-        struct ParentStackFrame {
-            ParentStackFrame() {}
-            ParentStackFrame(Element* element) : element(element) {}
-            Element* element;
-            Vector<unsigned, 4> identifierHashes;
-        };
-        Vector<ParentStackFrame> m_parentStack;
-        
-        // With 100 unique strings in the filter, 2^12 slot table has false positive rate of ~0.2%.
-        static const unsigned bloomFilterKeyBits = 12;
-        OwnPtr<BloomFilter<bloomFilterKeyBits> > m_ancestorIdentifierFilter;
+        SelectorFilter m_selectorFilter;
 
         bool m_hasUAAppearance;
         BorderData m_borderData;
@@ -357,6 +356,8 @@ public:
         
         RefPtr<CSSFontSelector> m_fontSelector;
         HashSet<AtomicStringImpl*> m_selectorAttrs;
+        // Attributes read by content: attr(), which the rule invalidation sets do not cover.
+        HashSet<AtomicStringImpl*> m_contentAttrs;
         Vector<CSSMutableStyleDeclaration*> m_additionalAttributeStyleDecls;
         Vector<MediaQueryResult*> m_viewportDependentMediaQueryResults;
 
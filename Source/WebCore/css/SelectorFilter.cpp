@@ -0,0 +1,263 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "SelectorFilter.h"
+
+#include "CSSSelector.h"
+#include "HTMLNames.h"
+#include "NamedNodeMap.h"
+#include "StyledElement.h"
+
+namespace WebCore {
+
+using namespace HTMLNames;
+
+#ifndef NDEBUG
+SelectorFilter::Statistics SelectorFilter::s_statistics;
+#endif
+
+// Keeps attribute names apart from tags, ids and classes with the same text.
+static const unsigned attributeNameSalt = 23;
+
+// Attribute names are matched case-insensitively in HTML documents, so both
+// sides are lowercased. That can only add matches, never lose them.
+static inline unsigned attributeNameHash(const AtomicString& localName)
+{
+    return localName.lower().impl()->existingHash() * attributeNameSalt;
+}
+
+static inline void collectElementIdentifierHashes(const Element* element, Vector<unsigned, 4>& identifierHashes)
+{
+    identifierHashes.append(element->localName().impl()->existingHash());
+    if (element->hasID())
+        identifierHashes.append(element->idForStyleResolution().impl()->existingHash());
+    const StyledElement* styledElement = element->isStyledElement() ? static_cast<const StyledElement*>(element) : 0;
+    if (styledElement && styledElement->hasClass()) {
+        const SpaceSplitString& classNames = styledElement->classNames();
+        size_t count = classNames.size();
+        for (size_t i = 0; i < count; ++i)
+            identifierHashes.append(classNames[i].impl()->existingHash());
+    }
+    if (!element->isHTMLElement())
+        return;
+    // The style attribute is only synchronized with the inline style lazily, so it
+    // is always assumed to be present.
+    identifierHashes.append(attributeNameHash(styleAttr.localName()));
+    if (NamedNodeMap* attributeMap = element->attributeMap()) {
+        size_t count = attributeMap->length();
+        for (size_t i = 0; i < count; ++i)
+            identifierHashes.append(attributeNameHash(attributeMap->attributeItem(i)->localName()));
+    }
+}
+
+SelectorFilter::SelectorFilter()
+    : m_nonHTMLFrameCount(0)
+{
+}
+
+void SelectorFilter::clear()
+{
+    if (m_parentStack.isEmpty())
+        return;
+    m_parentStack.clear();
+    m_ancestorIdentifierFilter.clear();
+    m_nonHTMLFrameCount = 0;
+}
+
+void SelectorFilter::pushParentStackFrame(Element* parent)
+{
+    ASSERT(m_parentStack.isEmpty() || m_parentStack.last().element == parent->parentElement());
+    ASSERT(!m_parentStack.isEmpty() || !parent->parentElement());
+    m_parentStack.append(ParentStackFrame(parent));
+    ParentStackFrame& parentFrame = m_parentStack.last();
+    parentFrame.isHTMLElement = parent->isHTMLElement();
+    if (!parentFrame.isHTMLElement)
+        ++m_nonHTMLFrameCount;
+    // Mix tags, class names, ids and attribute names into some sort of weird bouillabaisse.
+    // The filter is used for fast rejection of child and descendant selectors.
+    collectElementIdentifierHashes(parent, parentFrame.identifierHashes);
+    size_t count = parentFrame.identifierHashes.size();
+    for (size_t i = 0; i < count; ++i)
+        m_ancestorIdentifierFilter.add(parentFrame.identifierHashes[i]);
+}
+
+void SelectorFilter::popParentStackFrame()
+{
+    ASSERT(!m_parentStack.isEmpty());
+    const ParentStackFrame& parentFrame = m_parentStack.last();
+    size_t count = parentFrame.identifierHashes.size();
+    for (size_t i = 0; i < count; ++i)
+        m_ancestorIdentifierFilter.remove(parentFrame.identifierHashes[i]);
+    if (!parentFrame.isHTMLElement)
+        --m_nonHTMLFrameCount;
+    m_parentStack.removeLast();
+    if (m_parentStack.isEmpty()) {
+        ASSERT(m_ancestorIdentifierFilter.likelyEmpty());
+        m_ancestorIdentifierFilter.clear();
+    }
+}
+
+void SelectorFilter::pushParent(Element* parent)
+{
+    // Walks in document order move to a child of the last frame or back up to one of the frames.
+    if (!m_parentStack.isEmpty() && m_parentStack.last().element == parent->parentElement()) {
+        pushParentStackFrame(parent);
+        return;
+    }
+    for (size_t i = m_parentStack.size(); i; --i) {
+        if (m_parentStack[i - 1].element != parent)
+            continue;
+        while (m_parentStack.size() > i)
+            popParentStackFrame();
+        return;
+    }
+
+    Vector<Element*, 32> ancestors;
+    for (Element* ancestor = parent; ancestor; ancestor = ancestor->parentElement())
+        ancestors.append(ancestor);
+
+    // The chain is kept free of removed elements, so comparing pointers is enough.
+    size_t depth = ancestors.size();
+    size_t commonDepth = 0;
+    while (commonDepth < m_parentStack.size() && commonDepth < depth && m_parentStack[commonDepth].element == ancestors[depth - commonDepth - 1])
+        ++commonDepth;
+
+    if (!commonDepth)
+        clear();
+    while (m_parentStack.size() > commonDepth)
+        popParentStackFrame();
+    for (size_t i = commonDepth; i < depth; ++i)
+        pushParentStackFrame(ancestors[depth - i - 1]);
+}
+
+bool SelectorFilter::parentStackIsConsistent(const ContainerNode* parentNode) const
+{
+    return !m_parentStack.isEmpty() && m_parentStack.last().element == parentNode;
+}
+
+void SelectorFilter::popParent(Element* parent)
+{
+    if (m_parentStack.isEmpty() || m_parentStack.last().element != parent)
+        return;
+    popParentStackFrame();
+}
+
+void SelectorFilter::elementRemoved(Element* element)
+{
+    // Ancestors are removed before their descendants, so the first frame found
+    // is the topmost one leaving the tree.
+    for (size_t i = 0; i < m_parentStack.size(); ++i) {
+        if (m_parentStack[i].element != element)
+            continue;
+        while (m_parentStack.size() > i)
+            popParentStackFrame();
+        return;
+    }
+}
+
+void SelectorFilter::parentAttributesChanged(Element* element)
+{
+    for (size_t i = m_parentStack.size(); i; --i) {
+        ParentStackFrame& parentFrame = m_parentStack[i - 1];
+        if (parentFrame.element != element)
+            continue;
+        size_t count = parentFrame.identifierHashes.size();
+        for (size_t j = 0; j < count; ++j)
+            m_ancestorIdentifierFilter.remove(parentFrame.identifierHashes[j]);
+        parentFrame.identifierHashes.shrink(0);
+        collectElementIdentifierHashes(element, parentFrame.identifierHashes);
+        count = parentFrame.identifierHashes.size();
+        for (size_t j = 0; j < count; ++j)
+            m_ancestorIdentifierFilter.add(parentFrame.identifierHashes[j]);
+        return;
+    }
+}
+
+static inline bool isAttributePresenceSelector(const CSSSelector* selector)
+{
+    switch (selector->m_match) {
+    case CSSSelector::Exact:
+    case CSSSelector::Set:
+    case CSSSelector::List:
+    case CSSSelector::Hyphen:
+    case CSSSelector::Contain:
+    case CSSSelector::Begin:
+    case CSSSelector::End:
+        return selector->hasAttribute();
+    default:
+        return false;
+    }
+}
+
+static inline void collectSimpleSelectorHashes(const CSSSelector* selector, unsigned* identifierHashes, unsigned& attributeHashMask, unsigned& identifierCount)
+{
+    if ((selector->m_match == CSSSelector::Id || selector->m_match == CSSSelector::Class) && !selector->value().isEmpty())
+        identifierHashes[identifierCount++] = selector->value().impl()->existingHash();
+    else if (isAttributePresenceSelector(selector)) {
+        attributeHashMask |= 1 << identifierCount;
+        identifierHashes[identifierCount++] = attributeNameHash(selector->attribute().localName());
+    }
+    if (identifierCount == SelectorFilter::maximumIdentifierCount)
+        return;
+    const AtomicString& localName = selector->tag().localName();
+    if (localName != starAtom)
+        identifierHashes[identifierCount++] = localName.impl()->existingHash();
+}
+
+void SelectorFilter::collectIdentifierHashes(const CSSSelector* rightmostSelector, unsigned* identifierHashes, unsigned& attributeHashMask)
+{
+    unsigned identifierCount = 0;
+    attributeHashMask = 0;
+    CSSSelector::Relation relation = rightmostSelector->relation();
+
+    // Skip the topmost selector. It is handled quickly by the rule hashes.
+    bool skipOverSubselectors = true;
+    for (const CSSSelector* selector = rightmostSelector->tagHistory(); selector; selector = selector->tagHistory()) {
+        // Only collect identifiers that match ancestors.
+        switch (relation) {
+        case CSSSelector::SubSelector:
+            if (!skipOverSubselectors)
+                collectSimpleSelectorHashes(selector, identifierHashes, attributeHashMask, identifierCount);
+            break;
+        case CSSSelector::DirectAdjacent:
+        case CSSSelector::IndirectAdjacent:
+        case CSSSelector::ShadowDescendant:
+            skipOverSubselectors = true;
+            break;
+        case CSSSelector::Descendant:
+        case CSSSelector::Child:
+            skipOverSubselectors = false;
+            collectSimpleSelectorHashes(selector, identifierHashes, attributeHashMask, identifierCount);
+            break;
+        }
+        if (identifierCount == maximumIdentifierCount)
+            return;
+        relation = selector->relation();
+    }
+    identifierHashes[identifierCount] = 0;
+}
+
+} // namespace WebCore
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SelectorFilter_h
+#define SelectorFilter_h
+
+#include <wtf/BloomFilter.h>
+#include <wtf/FastAllocBase.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class CSSSelector;
+class ContainerNode;
+class Element;
+
+// Keeps the tags, ids, classes and attribute names of an ancestor chain in a
+// Bloom filter, so that descendant and child selectors that cannot match can
+// be rejected without walking the ancestors.
+//
+// The chain is kept when the tree walk that built it ends, so a later walk or
+// style resolve below the same ancestors only pushes and pops the frames that
+// differ. Owners that keep the chain must report elements leaving the tree and
+// attribute changes through elementRemoved() and parentAttributesChanged().
+class SelectorFilter {
+    WTF_MAKE_NONCOPYABLE(SelectorFilter); WTF_MAKE_FAST_ALLOCATED;
+public:
+    SelectorFilter();
+
+    // Makes the chain end at parent. Walks may start anywhere in the tree, so
+    // this pops back to the frames the current chain shares with parent's
+    // ancestors and pushes the rest.
+    void pushParent(Element* parent);
+    void popParent(Element* parent);
+    void clear();
+
+    bool parentStackIsConsistent(const ContainerNode* parentNode) const;
+
+    void elementRemoved(Element*);
+    void parentAttributesChanged(Element*);
+
+    // Try to balance between memory usage (there can be lots of rules) and good filtering performance.
+    static const unsigned maximumIdentifierCount = 4;
+
+    // Fills identifierHashes with the hashes the ancestors of an element matching
+    // the selector must have, zero terminated unless all slots are used. Bit n
+    // of attributeHashMask is set when hash n is an attribute name.
+    static void collectIdentifierHashes(const CSSSelector*, unsigned* identifierHashes, unsigned& attributeHashMask);
+
+    bool fastRejectSelector(const unsigned* identifierHashes, unsigned attributeHashMask) const
+    {
+        for (unsigned n = 0; n < maximumIdentifierCount && identifierHashes[n]; ++n) {
+            // Only the attribute names of HTML elements are collected.
+            if (m_nonHTMLFrameCount && (attributeHashMask & (1 << n)))
+                continue;
+            if (!m_ancestorIdentifierFilter.mayContain(identifierHashes[n]))
+                return true;
+        }
+        return false;
+    }
+
+#ifndef NDEBUG
+    // Counts selectors rejected by the filter and selectors that needed a full
+    // check, with or without the filter, for style resolution and querySelector.
+    // Debug builds only. Read them around a benchmark run to see how much the
+    // filter saves.
+    struct Statistics {
+        unsigned fastRejects;
+        unsigned filteredChecks;
+        unsigned unfilteredChecks;
+    };
+    static Statistics& statistics() { return s_statistics; }
+#endif
+
+private:
+    void pushParentStackFrame(Element* parent);
+    void popParentStackFrame();
+
+    struct ParentStackFrame {
+        ParentStackFrame() { }
+        ParentStackFrame(Element* element) : element(element), isHTMLElement(false) { }
+        Element* element;
+        bool isHTMLElement;
+        Vector<unsigned, 4> identifierHashes;
+    };
+    Vector<ParentStackFrame> m_parentStack;
+    unsigned m_nonHTMLFrameCount;
+
+    // With 100 unique strings in the filter, 2^12 slot table has false positive rate of ~0.2%.
+    static const unsigned bloomFilterKeyBits = 12;
+    BloomFilter<bloomFilterKeyBits> m_ancestorIdentifierFilter;
+
+#ifndef NDEBUG
+    static Statistics s_statistics;
+#endif
+};
+
+} // namespace WebCore
+
+#endif // SelectorFilter_h
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "StyleInvalidationSet.h"
+
+#include "StyledElement.h"
+
+namespace WebCore {
+
+bool StyleInvalidationSet::invalidatesDescendant(Element* element) const
+{
+    if (!m_descendantTagNames.isEmpty() && m_descendantTagNames.contains(element->localName().impl()))
+        return true;
+    if (!m_descendantIds.isEmpty() && element->hasID() && m_descendantIds.contains(element->idForStyleResolution().impl()))
+        return true;
+    if (!m_descendantClasses.isEmpty() && element->hasClass() && element->isStyledElement()) {
+        const SpaceSplitString& classNames = static_cast<StyledElement*>(element)->classNames();
+        size_t count = classNames.size();
+        for (size_t i = 0; i < count; ++i) {
+            if (m_descendantClasses.contains(classNames[i].impl()))
+                return true;
+        }
+    }
+    return false;
+}
+
+void StyleInvalidationSet::invalidate(Element* element, const Vector<StyleInvalidationSet*, 8>& invalidationSets)
+{
+    bool invalidatesSelf = false;
+    bool invalidatesWholeSubtree = false;
+    bool invalidatesDescendants = false;
+    unsigned siblingReach = 0;
+    size_t setCount = invalidationSets.size();
+    for (size_t i = 0; i < setCount; ++i) {
+        const StyleInvalidationSet* invalidationSet = invalidationSets[i];
+        invalidatesSelf |= invalidationSet->invalidatesSelf();
+        invalidatesWholeSubtree |= invalidationSet->invalidatesWholeSubtree();
+        invalidatesDescendants |= invalidationSet->invalidatesDescendants();
+        siblingReach = std::max(siblingReach, invalidationSet->siblingReach());
+    }
+
+    if (invalidatesWholeSubtree)
+        element->setNeedsStyleRecalc();
+    else {
+        if (invalidatesSelf)
+            element->setNeedsStyleRecalc(InlineStyleChange);
+        if (invalidatesDescendants) {
+            for (Node* node = element->firstChild(); node; node = node->traverseNextNode(element)) {
+                if (!node->isElementNode())
+                    continue;
+                Element* descendant = static_cast<Element*>(node);
+                for (size_t i = 0; i < setCount; ++i) {
+                    if (invalidationSets[i]->invalidatesDescendant(descendant)) {
+                        descendant->setNeedsStyleRecalc(InlineStyleChange);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    for (Node* sibling = element->nextSibling(); sibling && siblingReach; sibling = sibling->nextSibling()) {
+        if (!sibling->isElementNode())
+            continue;
+        sibling->setNeedsStyleRecalc();
+        if (siblingReach != unboundedSiblingReach)
+            --siblingReach;
+    }
+}
+
+} // namespace WebCore
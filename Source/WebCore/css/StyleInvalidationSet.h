@@ -0,0 +1,86 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef StyleInvalidationSet_h
+#define StyleInvalidationSet_h
+
+#include <algorithm>
+#include <wtf/HashSet.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/RefCounted.h>
+#include <wtf/Vector.h>
+#include <wtf/text/AtomicStringImpl.h>
+
+namespace WebCore {
+
+class Element;
+
+// Describes which elements may start or stop matching a rule when a class, id or
+// attribute name appears on or disappears from an element: the element itself,
+// some of its following siblings, and the descendants that have one of a set of
+// classes, ids or tag names.
+class StyleInvalidationSet : public RefCounted<StyleInvalidationSet> {
+public:
+    static PassRefPtr<StyleInvalidationSet> create() { return adoptRef(new StyleInvalidationSet); }
+
+    static const unsigned unboundedSiblingReach = static_cast<unsigned>(-1);
+
+    void setInvalidatesSelf() { m_invalidatesSelf = true; }
+    void setInvalidatesWholeSubtree() { m_invalidatesWholeSubtree = true; }
+    void addSiblingReach(unsigned reach) { m_siblingReach = std::max(m_siblingReach, reach); }
+    void addDescendantClass(AtomicStringImpl* className) { m_descendantClasses.add(className); }
+    void addDescendantId(AtomicStringImpl* id) { m_descendantIds.add(id); }
+    void addDescendantTagName(AtomicStringImpl* localName) { m_descendantTagNames.add(localName); }
+
+    bool invalidatesSelf() const { return m_invalidatesSelf; }
+    bool invalidatesWholeSubtree() const { return m_invalidatesWholeSubtree; }
+    unsigned siblingReach() const { return m_siblingReach; }
+    bool invalidatesDescendants() const { return !m_descendantClasses.isEmpty() || !m_descendantIds.isEmpty() || !m_descendantTagNames.isEmpty(); }
+    bool invalidatesDescendant(Element*) const;
+
+    // Marks element, and the siblings and descendants the sets name, as needing
+    // style recalc. Elements a set names individually only recalc their own style;
+    // siblings and whole subtrees recalc everything below them.
+    static void invalidate(Element*, const Vector<StyleInvalidationSet*, 8>&);
+
+private:
+    StyleInvalidationSet()
+        : m_invalidatesSelf(false)
+        , m_invalidatesWholeSubtree(false)
+        , m_siblingReach(0)
+    {
+    }
+
+    bool m_invalidatesSelf;
+    bool m_invalidatesWholeSubtree;
+    unsigned m_siblingReach;
+    HashSet<AtomicStringImpl*> m_descendantClasses;
+    HashSet<AtomicStringImpl*> m_descendantIds;
+    HashSet<AtomicStringImpl*> m_descendantTagNames;
+};
+
+} // namespace WebCore
+
+#endif // StyleInvalidationSet_h
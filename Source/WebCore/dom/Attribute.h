@@ -26,6 +26,7 @@
 #define Attribute_h
 
 #include "CSSMappedAttributeDeclaration.h"
+#include "NodeArena.h"
 #include "QualifiedName.h"
 
 namespace WebCore {
@@ -39,6 +40,7 @@ class NamedNodeMap;
 // It is an internal representation of the node value of an Attr.
 // The actual Attr with its value as a Text child is allocated only if needed.
 class Attribute : public RefCounted<Attribute> {
+    MAKE_NODE_ARENA_ALLOCATED;
     friend class Attr;
     friend class NamedNodeMap;
 public:
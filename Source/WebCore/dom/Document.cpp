@@ -462,6 +462,10 @@ Document::Document(Frame* frame, const KURL& url, bool isXHTML, bool isHTML)
 
     m_frame = frame;
 
+#if ENABLE(DOM_NODE_ARENA)
+    m_nodeArena = frame && frame->settings() && frame->settings()->domNodeArenaEnabled() ? NodeArena::create() : 0;
+#endif
+
     // We depend on the url getting immediately set in subframes, but we
     // also depend on the url NOT getting immediately set in opened windows.
     // See fast/dom/early-frame-url.html
@@ -587,6 +591,12 @@ Document::~Document()
         m_documentRareData = 0;
         clearFlag(HasRareDataFlag);
     }
+
+#if ENABLE(DOM_NODE_ARENA)
+    // Nodes that outlive the document keep the arena alive until they are freed.
+    if (m_nodeArena)
+        m_nodeArena->detachFromDocument();
+#endif
 }
 
 void Document::removedLastRef()
@@ -744,11 +754,17 @@ PassRefPtr<DocumentFragment> Document::createDocumentFragment()
 
 PassRefPtr<Text> Document::createTextNode(const String& data)
 {
+#if ENABLE(DOM_NODE_ARENA)
+    NodeArena::Scope arenaScope(m_nodeArena);
+#endif
     return Text::create(this, data);
 }
 
 PassRefPtr<Comment> Document::createComment(const String& data)
 {
+#if ENABLE(DOM_NODE_ARENA)
+    NodeArena::Scope arenaScope(m_nodeArena);
+#endif
     return Comment::create(this, data);
 }
 
@@ -956,6 +972,9 @@ bool Document::hasPrefixNamespaceMismatch(const QualifiedName& qName)
 // FIXME: This should really be in a possible ElementFactory class
 PassRefPtr<Element> Document::createElement(const QualifiedName& qName, bool createdByParser)
 {
+#if ENABLE(DOM_NODE_ARENA)
+    NodeArena::Scope arenaScope(m_nodeArena);
+#endif
     RefPtr<Element> e;
 
     // FIXME: Use registered namespaces and look up in a hash to find the right factory.
@@ -550,6 +550,12 @@ public:
 
     RenderArena* renderArena() { return m_renderArena.get(); }
 
+#if ENABLE(DOM_NODE_ARENA)
+    // Null unless Settings::domNodeArenaEnabled() was set when the document was
+    // created. Its statistics report the memory used by this document's nodes.
+    NodeArena* nodeArena() const { return m_nodeArena; }
+#endif
+
     RenderView* renderView() const;
 
     void clearAXObjectCache();
@@ -1293,6 +1299,9 @@ private:
     RefPtr<Element> m_titleElement;
 
     OwnPtr<RenderArena> m_renderArena;
+#if ENABLE(DOM_NODE_ARENA)
+    NodeArena* m_nodeArena;
+#endif
 
 #if !PLATFORM(ANDROID)
     mutable AXObjectCache* m_axObjectCache;
@@ -739,6 +739,9 @@ void Element::attributeChanged(Attribute* attr, bool)
 
 void Element::updateAfterAttributeChanged(Attribute* attr)
 {
+    if (CSSStyleSelector* styleSelector = document()->styleSelectorIfExists())
+        styleSelector->selectorFilter().parentAttributesChanged(this);
+
     if (!AXObjectCache::accessibilityEnabled())
         return;
 
@@ -767,12 +770,13 @@ void Element::updateAfterAttributeChanged(Attribute* attr)
     
 void Element::recalcStyleIfNeededAfterAttributeChanged(Attribute* attr)
 {
-    if (document()->attached() && document()->styleSelector()->hasSelectorForAttribute(attr->name().localName()))
-        setNeedsStyleRecalc();
+    if (document()->attached() && attached())
+        document()->styleSelector()->invalidateStyleForAttributeChange(this, attr->name());
 }
 
 void Element::idAttributeChanged(Attribute* attr)
 {
+    AtomicString oldId = hasID() && attributeMap() ? attributeMap()->idForStyleResolution() : nullAtom;
     setHasID(!attr->isNull());
     if (attributeMap()) {
         if (attr->isNull())
@@ -782,7 +786,11 @@ void Element::idAttributeChanged(Attribute* attr)
         else
             attributeMap()->setIdForStyleResolution(attr->value());
     }
-    setNeedsStyleRecalc();
+    if (!attached())
+        return;
+    AtomicString newId = hasID() && attributeMap() ? attributeMap()->idForStyleResolution() : nullAtom;
+    if (oldId != newId)
+        document()->styleSelector()->invalidateStyleForIdChange(this, oldId, newId);
 }
     
 // Returns true is the given attribute is an event handler.
@@ -952,6 +960,9 @@ void Element::insertedIntoDocument()
 
 void Element::removedFromDocument()
 {
+    if (CSSStyleSelector* styleSelector = document()->styleSelectorIfExists())
+        styleSelector->selectorFilter().elementRemoved(this);
+
     if (hasID()) {
         if (m_attributeMap) {
             Attribute* idItem = m_attributeMap->getAttributeItem(document()->idAttributeName());
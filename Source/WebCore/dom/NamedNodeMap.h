@@ -35,6 +35,7 @@ class Node;
 typedef int ExceptionCode;
 
 class NamedNodeMap : public RefCounted<NamedNodeMap> {
+    MAKE_NODE_ARENA_ALLOCATED;
     friend class Element;
 public:
     static PassRefPtr<NamedNodeMap> create(Element* element = 0)
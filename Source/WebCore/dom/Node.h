@@ -28,6 +28,7 @@
 
 #include "EventTarget.h"
 #include "KURLHash.h"
+#include "NodeArena.h"
 #include "RenderStyleConstants.h"
 #include "ScriptWrappable.h"
 #include "TreeShared.h"
@@ -94,6 +95,7 @@ enum StyleChangeType {
 };
 
 class Node : public EventTarget, public TreeShared<ContainerNode>, public ScriptWrappable {
+    MAKE_NODE_ARENA_ALLOCATED;
     friend class Document;
     friend class TreeScope;
 
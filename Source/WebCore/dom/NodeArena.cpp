@@ -0,0 +1,156 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "NodeArena.h"
+
+#if ENABLE(DOM_NODE_ARENA)
+
+#include <string.h>
+#include <wtf/StdLibExtras.h>
+
+namespace WebCore {
+
+NodeArena::Scope* NodeArena::s_currentScope = 0;
+
+// Keeps the objects that follow it aligned for doubles.
+union NodeArenaHeader {
+    NodeArena* arena;
+    double alignment;
+};
+
+NodeArena::NodeArena()
+    : m_slabPosition(0)
+    , m_slabRemaining(0)
+    , m_detached(false)
+{
+    memset(m_freeLists, 0, sizeof(m_freeLists));
+}
+
+NodeArena::~NodeArena()
+{
+    ASSERT(!m_statistics.liveObjects);
+    for (size_t i = 0; i < m_slabs.size(); ++i)
+        fastFree(m_slabs[i]);
+}
+
+void NodeArena::detachFromDocument()
+{
+    ASSERT(!m_detached);
+    m_detached = true;
+
+    // The document can go away while a Scope for it is still on the stack, such as
+    // the parser's when a script removes the frame. Later allocations in that
+    // Scope fall back to fastMalloc instead of using an arena that may be deleted.
+    for (Scope* scope = s_currentScope; scope; scope = scope->m_previous) {
+        if (scope->m_arena == this)
+            scope->m_arena = 0;
+    }
+
+    if (!m_statistics.liveObjects)
+        delete this;
+}
+
+void* NodeArena::allocate(size_t size)
+{
+    NodeArena* arena = s_currentScope ? s_currentScope->m_arena : 0;
+    size_t cellSize = size + sizeof(NodeArenaHeader);
+    NodeArenaHeader* header = static_cast<NodeArenaHeader*>(arena ? arena->allocateCell(cellSize) : fastMalloc(cellSize));
+    header->arena = arena;
+    return header + 1;
+}
+
+void NodeArena::deallocate(void* p, size_t size)
+{
+    if (!p)
+        return;
+    NodeArenaHeader* header = static_cast<NodeArenaHeader*>(p) - 1;
+    if (NodeArena* arena = header->arena)
+        arena->freeCell(header, size + sizeof(NodeArenaHeader));
+    else
+        fastFree(header);
+}
+
+void* NodeArena::allocateCell(size_t size)
+{
+    size = WTF::roundUpToMultipleOf<granularity>(size);
+    ++m_statistics.liveObjects;
+    m_statistics.liveBytes += size;
+
+    if (size > maximumCellSize) {
+        m_statistics.largeObjectBytes += size;
+        return fastMalloc(size);
+    }
+
+    size_t sizeClass = size / granularity - 1;
+    if (FreeCell* cell = m_freeLists[sizeClass]) {
+        m_freeLists[sizeClass] = cell->next;
+        return cell;
+    }
+
+    if (m_slabRemaining < size) {
+        // Recycle the tail of the current slab rather than dropping it.
+        if (m_slabRemaining)
+            pushFreeCell(m_slabPosition, m_slabRemaining / granularity - 1);
+        m_slabPosition = static_cast<char*>(fastMalloc(slabSize));
+        m_slabRemaining = slabSize;
+        m_slabs.append(m_slabPosition);
+        m_statistics.slabBytes += slabSize;
+    }
+
+    void* cell = m_slabPosition;
+    m_slabPosition += size;
+    m_slabRemaining -= size;
+    return cell;
+}
+
+void NodeArena::freeCell(void* cell, size_t size)
+{
+    size = WTF::roundUpToMultipleOf<granularity>(size);
+    ASSERT(m_statistics.liveObjects);
+    --m_statistics.liveObjects;
+    m_statistics.liveBytes -= size;
+
+    if (size > maximumCellSize) {
+        m_statistics.largeObjectBytes -= size;
+        fastFree(cell);
+    } else
+        pushFreeCell(cell, size / granularity - 1);
+
+    if (m_detached && !m_statistics.liveObjects)
+        delete this;
+}
+
+void NodeArena::pushFreeCell(void* cell, size_t sizeClass)
+{
+    ASSERT(sizeClass < sizeClassCount);
+    FreeCell* freeCell = static_cast<FreeCell*>(cell);
+    freeCell->next = m_freeLists[sizeClass];
+    m_freeLists[sizeClass] = freeCell;
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(DOM_NODE_ARENA)
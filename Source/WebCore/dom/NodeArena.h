@@ -0,0 +1,141 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NodeArena_h
+#define NodeArena_h
+
+#include <wtf/FastAllocBase.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+#if ENABLE(DOM_NODE_ARENA)
+
+// Gives a class NodeArena-backed operator new and delete. A class that also
+// inherits a class-specific operator new from another base, such as
+// CachedResourceClient, must use this again to resolve the ambiguity.
+#define MAKE_NODE_ARENA_ALLOCATED \
+public: \
+    void* operator new(size_t, void* p) { return p; } \
+    void* operator new(size_t size) { return ::WebCore::NodeArena::allocate(size); } \
+    void operator delete(void* p, size_t size) { ::WebCore::NodeArena::deallocate(p, size); } \
+private: \
+typedef int ThisIsHereToForceASemicolonAfterThisMacro
+
+namespace WebCore {
+
+// A per-Document slab allocator for nodes, attributes and attribute maps.
+// Objects are carved out of large slabs and freed objects are kept on
+// per-size-class free lists for reuse, the way RenderArena recycles renderers.
+// Each object is preceded by a pointer to the arena it came from. That lets an
+// object be freed after it has moved to another document, or after its
+// document is gone. The arena deletes itself once its document has been
+// destroyed and its last object has been freed.
+class NodeArena {
+    WTF_MAKE_NONCOPYABLE(NodeArena); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static NodeArena* create() { return new NodeArena; }
+
+    // Called by the owning Document from its destructor.
+    void detachFromDocument();
+
+    struct Statistics {
+        Statistics()
+            : liveObjects(0)
+            , liveBytes(0)
+            , slabBytes(0)
+            , largeObjectBytes(0)
+        {
+        }
+
+        size_t liveObjects;
+        size_t liveBytes;
+        size_t slabBytes;
+        size_t largeObjectBytes;
+    };
+    const Statistics& statistics() const { return m_statistics; }
+
+    // Allocates from the arena of the innermost Scope, or with fastMalloc
+    // when there is none. The size passed to deallocate() must match.
+    static void* allocate(size_t);
+    static void deallocate(void*, size_t);
+
+    // Makes objects allocated while it is alive come from the given arena.
+    // A null arena means fastMalloc. Scopes nest, for example when a script run
+    // by the parser creates nodes for another document.
+    class Scope {
+        WTF_MAKE_NONCOPYABLE(Scope);
+    public:
+        explicit Scope(NodeArena* arena)
+            : m_arena(arena)
+            , m_previous(s_currentScope)
+        {
+            s_currentScope = this;
+        }
+
+        ~Scope() { s_currentScope = m_previous; }
+
+    private:
+        friend class NodeArena;
+
+        NodeArena* m_arena;
+        Scope* m_previous;
+    };
+
+private:
+    NodeArena();
+    ~NodeArena();
+
+    void* allocateCell(size_t);
+    void freeCell(void*, size_t);
+    void pushFreeCell(void*, size_t sizeClass);
+
+    static const size_t granularity = 8;
+    static const size_t maximumCellSize = 512;
+    static const size_t slabSize = 16 * 1024;
+    static const size_t sizeClassCount = maximumCellSize / granularity;
+
+    static Scope* s_currentScope;
+
+    struct FreeCell {
+        FreeCell* next;
+    };
+
+    FreeCell* m_freeLists[sizeClassCount];
+    Vector<char*> m_slabs;
+    char* m_slabPosition;
+    size_t m_slabRemaining;
+    Statistics m_statistics;
+    bool m_detached;
+};
+
+} // namespace WebCore
+
+#else
+
+#define MAKE_NODE_ARENA_ALLOCATED typedef int ThisIsHereToForceASemicolonAfterThisMacro
+
+#endif // ENABLE(DOM_NODE_ARENA)
+
+#endif // NodeArena_h
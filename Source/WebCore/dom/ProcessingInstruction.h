@@ -32,6 +32,7 @@ class StyleSheet;
 class CSSStyleSheet;
 
 class ProcessingInstruction : public ContainerNode, private CachedResourceClient {
+    MAKE_NODE_ARENA_ALLOCATED;
 public:
     static PassRefPtr<ProcessingInstruction> create(Document*, const String& target, const String& data);
     virtual ~ProcessingInstruction();
@@ -36,12 +36,19 @@
 #include "Document.h"
 #include "Element.h"
 #include "HTMLNames.h"
+#include "SelectorFilter.h"
 #include "StaticNodeList.h"
+#include <wtf/OwnPtr.h>
 
 namespace WebCore {
 
 using namespace HTMLNames;
 
+struct QuerySelectorHashes {
+    unsigned identifierHashes[SelectorFilter::maximumIdentifierCount];
+    unsigned attributeHashMask;
+};
+
 PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelectorList& querySelectorList)
 {
     Vector<RefPtr<Node> > nodes;
@@ -62,11 +69,41 @@ PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelec
             querySelectors.append(selector);
         int querySelectorsCount = querySelectors.size();
 
+        // Selectors naming ancestors are first checked against a filter of the identifiers of the
+        // ancestors of each element, which is kept up to date as the walk moves through the tree.
+        Vector<QuerySelectorHashes, 16> querySelectorHashes(querySelectorsCount);
+        bool hasAncestorIdentifiers = false;
+        for (int i = 0; i < querySelectorsCount; i++) {
+            SelectorFilter::collectIdentifierHashes(querySelectors[i], querySelectorHashes[i].identifierHashes, querySelectorHashes[i].attributeHashMask);
+            hasAncestorIdentifiers |= !!querySelectorHashes[i].identifierHashes[0];
+        }
+        OwnPtr<SelectorFilter> selectorFilter;
+        if (hasAncestorIdentifiers)
+            selectorFilter = adoptPtr(new SelectorFilter);
+
         Node* lastNode = rootNode->lastDescendantNode();
         for (Node* n = rootNode->firstChild(); n; n = n->traverseNextNodeFastPath()) {
             if (n->isElementNode()) {
                 Element* element = static_cast<Element*>(n);
+                if (selectorFilter) {
+                    if (Element* parent = element->parentElement())
+                        selectorFilter->pushParent(parent);
+                    else
+                        selectorFilter->clear();
+                }
                 for (int i = 0; i < querySelectorsCount; i++) {
+                    if (selectorFilter && selectorFilter->fastRejectSelector(querySelectorHashes[i].identifierHashes, querySelectorHashes[i].attributeHashMask)) {
+#ifndef NDEBUG
+                        ++SelectorFilter::statistics().fastRejects;
+#endif
+                        continue;
+                    }
+#ifndef NDEBUG
+                    if (selectorFilter)
+                        ++SelectorFilter::statistics().filteredChecks;
+                    else
+                        ++SelectorFilter::statistics().unfilteredChecks;
+#endif
                     if (selectorChecker.checkSelector(querySelectors[i], element)) {
                         nodes.append(n);
                         break;
@@ -220,6 +220,15 @@ void StyledElement::classAttributeChanged(const AtomicString& newClassString)
             break;
     }
     bool hasClass = i < length;
+
+    Vector<AtomicString, 8> changedClasses;
+    if (attached() && this->hasClass()) {
+        const SpaceSplitString& oldClassNames = classNames();
+        size_t count = oldClassNames.size();
+        for (size_t i = 0; i < count; ++i)
+            changedClasses.append(oldClassNames[i]);
+    }
+
     setHasClass(hasClass);
     if (hasClass) {
         attributes()->setClass(newClassString);
@@ -227,7 +236,25 @@ void StyledElement::classAttributeChanged(const AtomicString& newClassString)
             static_cast<ClassList*>(classList)->reset(newClassString);
     } else if (attributeMap())
         attributeMap()->clearClass();
-    setNeedsStyleRecalc();
+
+    if (attached()) {
+        // Only classes added or removed can change which rules match.
+        size_t oldCount = changedClasses.size();
+        if (hasClass) {
+            const SpaceSplitString& newClassNames = classNames();
+            size_t newCount = newClassNames.size();
+            for (size_t i = 0; i < newCount; ++i) {
+                if (changedClasses.find(newClassNames[i]) == notFound)
+                    changedClasses.append(newClassNames[i]);
+            }
+            for (size_t i = oldCount; i; --i) {
+                if (newClassNames.contains(changedClasses[i - 1]))
+                    changedClasses.remove(i - 1);
+            }
+        }
+        if (!changedClasses.isEmpty())
+            document()->styleSelector()->invalidateStyleForClassChange(this, changedClasses);
+    }
     dispatchSubtreeModifiedEvent();
 }
 
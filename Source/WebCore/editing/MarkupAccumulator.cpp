@@ -102,6 +102,9 @@ MarkupAccumulator::MarkupAccumulator(Vector<Node*>* nodes, EAbsoluteURLs shouldR
     , m_range(range)
     , m_shouldResolveURLs(shouldResolveURLs)
 {
+    // Serializing a large subtree would otherwise copy the markup every time
+    // the buffer fills up.
+    m_markup.setUsesChunks(true);
 }
 
 MarkupAccumulator::~MarkupAccumulator()
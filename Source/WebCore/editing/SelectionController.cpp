@@ -86,6 +86,8 @@ SelectionController::SelectionController(Frame* frame, bool isDragCaretControlle
     , m_caretVisible(isDragCaretController)
     , m_caretPaint(true)
 {
+    // A blink up to a sixteenth of a second late is not noticeable.
+    m_caretBlinkTimer.setTolerance(1.0 / 16);
     setIsDirectional(false);
 }
 
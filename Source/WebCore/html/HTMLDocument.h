@@ -34,6 +34,7 @@ class FrameView;
 class HTMLElement;
 
 class HTMLDocument : public Document, public CachedResourceClient {
+    MAKE_NODE_ARENA_ALLOCATED;
 public:
     static PassRefPtr<HTMLDocument> create(Frame* frame, const KURL& url)
     {
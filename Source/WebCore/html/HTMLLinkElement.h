@@ -36,6 +36,7 @@ class CachedResource;
 class KURL;
 
 class HTMLLinkElement : public HTMLElement, public CachedResourceClient {
+    MAKE_NODE_ARENA_ALLOCATED;
 public:
     struct RelAttribute {
         bool m_isStyleSheet;
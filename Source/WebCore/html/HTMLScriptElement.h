@@ -30,6 +30,7 @@
 namespace WebCore {
 
 class HTMLScriptElement : public HTMLElement, public ScriptElement {
+    MAKE_NODE_ARENA_ALLOCATED;
 public:
     static PassRefPtr<HTMLScriptElement> create(const QualifiedName&, Document*, bool wasInsertedByParser);
 
@@ -1288,6 +1288,10 @@ void CanvasRenderingContext2D::drawImage(HTMLImageElement* image, const FloatRec
     if (!cachedImage)
         return;
 
+    // Canvas pixels must match the intrinsic image, so never draw from a
+    // downscaled decode.
+    cachedImage->requestDecodeSize(IntSize());
+
     checkOrigin(image);
 
     FloatRect sourceRect = c->roundToDevicePixels(normalizedSrcRect);
@@ -1533,6 +1537,8 @@ PassRefPtr<CanvasPattern> CanvasRenderingContext2D::createPattern(HTMLImageEleme
     if (!cachedImage || !image->cachedImage()->image())
         return CanvasPattern::create(Image::nullImage(), repeatX, repeatY, true);
 
+    cachedImage->requestDecodeSize(IntSize());
+
     bool originClean = isOriginClean(cachedImage, canvas()->securityOrigin());
     return CanvasPattern::create(cachedImage->image(), repeatX, repeatY, originClean);
 }
@@ -250,6 +250,9 @@ void HTMLDocumentParser::pumpTokenizer(SynchronousMode mode)
     ASSERT(refCount() >= 2);
 
     PumpSession session(m_pumpSessionNestingLevel);
+#if ENABLE(DOM_NODE_ARENA)
+    NodeArena::Scope arenaScope(document()->nodeArena());
+#endif
 
     // We tell the InspectorInstrumentation about every pump, even if we
     // end up pumping nothing.  It can filter out empty pumps itself.
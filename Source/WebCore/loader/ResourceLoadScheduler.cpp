@@ -35,6 +35,7 @@
 #include "ResourceLoader.h"
 #include "ResourceRequest.h"
 #include "SubresourceLoader.h"
+#include <wtf/UnusedParam.h>
 #include <wtf/text/CString.h>
 
 #define REQUEST_MANAGEMENT_ENABLED 1
@@ -50,6 +51,17 @@ static const unsigned maxRequestsInFlightForNonHTTPProtocols = 10000;
 static const unsigned maxRequestsInFlightPerHost = 10000;
 #endif
 
+// Share of a host's connections each priority may occupy, relative to
+// ResourceLoadPriorityHighest. Keeping some connections out of reach of
+// low priority loads means a stylesheet or script discovered late does
+// not have to queue behind a page full of images.
+static const unsigned priorityWeights[ResourceLoadPriorityHighest + 1] = { 1, 2, 3, 3 };
+
+static unsigned maxRequestsInFlightForPriority(unsigned maxRequestsInFlight, ResourceLoadPriority priority)
+{
+    return std::max(1u, maxRequestsInFlight * priorityWeights[priority] / priorityWeights[ResourceLoadPriorityHighest]);
+}
+
 ResourceLoadScheduler::HostInformation* ResourceLoadScheduler::hostForURL(const KURL& url, CreateHostPolicy createHostPolicy)
 {
     if (!url.protocolInHTTPFamily())
@@ -152,6 +164,44 @@ void ResourceLoadScheduler::crossOriginRedirectReceived(ResourceLoader* resource
     oldHost->remove(resourceLoader);
 }
 
+void ResourceLoadScheduler::reprioritize(ResourceLoader* resourceLoader, ResourceLoadPriority priority)
+{
+    ASSERT(resourceLoader);
+    if (priority == ResourceLoadPriorityUnresolved)
+        return;
+#if !REQUEST_MANAGEMENT_ENABLED
+    priority = ResourceLoadPriorityHighest;
+#endif
+
+    HostInformation* host = hostForURL(resourceLoader->url());
+    if (!host || !host->reprioritize(resourceLoader, priority))
+        return;
+
+    LOG(ResourceLoading, "ResourceLoadScheduler::reprioritize resource %p '%s' to %d", resourceLoader, resourceLoader->url().string().latin1().data(), priority);
+    // Callers include painting, so never start loads from here; starting one can re-enter the loader and the render tree.
+    scheduleServePendingRequests();
+}
+
+unsigned ResourceLoadScheduler::perHostConnectionLimit() const
+{
+    return maxRequestsInFlightPerHost;
+}
+
+void ResourceLoadScheduler::setPerHostConnectionLimit(unsigned maxRequestsInFlight)
+{
+    ASSERT(maxRequestsInFlight);
+#if REQUEST_MANAGEMENT_ENABLED
+    maxRequestsInFlightPerHost = maxRequestsInFlight;
+    HostMap::iterator end = m_hosts.end();
+    for (HostMap::iterator iter = m_hosts.begin(); iter != end; ++iter)
+        iter->second->setMaxRequestsInFlight(maxRequestsInFlight);
+    // Raising the limit may let queued requests start right away.
+    scheduleServePendingRequests();
+#else
+    UNUSED_PARAM(maxRequestsInFlight);
+#endif
+}
+
 void ResourceLoadScheduler::servePendingRequests(ResourceLoadPriority minimumPriority)
 {
     LOG(ResourceLoading, "ResourceLoadScheduler::servePendingRequests. m_isSuspendingPendingRequests=%d", m_isSuspendingPendingRequests); 
@@ -272,6 +322,28 @@ void ResourceLoadScheduler::HostInformation::remove(ResourceLoader* resourceLoad
     }
 }
 
+bool ResourceLoadScheduler::HostInformation::reprioritize(ResourceLoader* resourceLoader, ResourceLoadPriority priority)
+{
+    // Loads already handed to the network layer keep their connection.
+    if (m_requestsLoading.contains(resourceLoader))
+        return false;
+
+    for (int oldPriority = ResourceLoadPriorityHighest; oldPriority >= ResourceLoadPriorityLowest; --oldPriority) {
+        RequestQueue::iterator end = m_requestsPending[oldPriority].end();
+        for (RequestQueue::iterator it = m_requestsPending[oldPriority].begin(); it != end; ++it) {
+            if (*it != resourceLoader)
+                continue;
+            if (oldPriority == priority)
+                return false;
+            RefPtr<ResourceLoader> protector = *it;
+            m_requestsPending[oldPriority].remove(it);
+            m_requestsPending[priority].append(protector.release());
+            return true;
+        }
+    }
+    return false;
+}
+
 bool ResourceLoadScheduler::HostInformation::hasRequests() const
 {
     if (!m_requestsLoading.isEmpty())
@@ -287,7 +359,9 @@ bool ResourceLoadScheduler::HostInformation::limitRequests(ResourceLoadPriority
 {
     if (priority == ResourceLoadPriorityVeryLow && !m_requestsLoading.isEmpty())
         return true;
-    return m_requestsLoading.size() >= (resourceLoadScheduler()->isSerialLoadingEnabled() ? 1 : m_maxRequestsInFlight);
+    if (resourceLoadScheduler()->isSerialLoadingEnabled())
+        return !m_requestsLoading.isEmpty();
+    return static_cast<unsigned>(m_requestsLoading.size()) >= maxRequestsInFlightForPriority(m_maxRequestsInFlight, priority);
 }
 
 } // namespace WebCore
@@ -55,6 +55,7 @@ public:
     void addMainResourceLoad(ResourceLoader*);
     void remove(ResourceLoader*);
     void crossOriginRedirectReceived(ResourceLoader*, const KURL& redirectURL);
+    void reprioritize(ResourceLoader*, ResourceLoadPriority);
     
     void servePendingRequests(ResourceLoadPriority minimumPriority = ResourceLoadPriorityVeryLow);
     void suspendPendingRequests();
@@ -63,6 +64,9 @@ public:
     bool isSerialLoadingEnabled() const { return m_isSerialLoadingEnabled; }
     void setSerialLoadingEnabled(bool b) { m_isSerialLoadingEnabled = b; }
 
+    unsigned perHostConnectionLimit() const;
+    void setPerHostConnectionLimit(unsigned);
+
 private:
     ResourceLoadScheduler();
     ~ResourceLoadScheduler();
@@ -81,9 +85,12 @@ private:
         void schedule(ResourceLoader*, ResourceLoadPriority = ResourceLoadPriorityVeryLow);
         void addLoadInProgress(ResourceLoader*);
         void remove(ResourceLoader*);
+        bool reprioritize(ResourceLoader*, ResourceLoadPriority);
         bool hasRequests() const;
         bool limitRequests(ResourceLoadPriority) const;
 
+        void setMaxRequestsInFlight(unsigned maxRequestsInFlight) { m_maxRequestsInFlight = maxRequestsInFlight; }
+
         typedef Deque<RefPtr<ResourceLoader> > RequestQueue;
         RequestQueue& requestsPending(ResourceLoadPriority priority) { return m_requestsPending[priority]; }
 
@@ -92,7 +99,7 @@ private:
         typedef HashSet<RefPtr<ResourceLoader> > RequestMap;
         RequestMap m_requestsLoading;
         const String m_name;
-        const int m_maxRequestsInFlight;
+        unsigned m_maxRequestsInFlight;
     };
 
     enum CreateHostPolicy {
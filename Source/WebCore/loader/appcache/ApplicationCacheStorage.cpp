@@ -49,6 +49,9 @@ namespace WebCore {
 
 static const char flatFileSubdirectory[] = "ApplicationCache";
 
+// Storing a cache runs the same handful of statements for each of its resources.
+static const unsigned statementCacheCapacity = 32;
+
 template <class T>
 class StorageIDJournal {
 public:  
@@ -607,6 +610,8 @@ void ApplicationCacheStorage::openDatabase(bool createIfDoesNotExist)
     
     if (!m_database.isOpen())
         return;
+
+    m_database.setStatementCacheCapacity(statementCacheCapacity);
     
     verifySchemaVersion();
     
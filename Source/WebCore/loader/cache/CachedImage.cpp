@@ -52,13 +52,19 @@ using std::max;
 
 namespace WebCore {
 
+// Dropping decoded data a little late costs nothing, so let the timer wait for
+// other timers to wake us up.
+static const double decodedDataDeletionTolerance = 1.0;
+
 CachedImage::CachedImage(const ResourceRequest& resourceRequest)
     : CachedResource(resourceRequest, ImageResource)
     , m_image(0)
     , m_decodedDataDeletionTimer(this, &CachedImage::decodedDataDeletionTimerFired)
+    , m_needsFullResolutionDecode(false)
     , m_shouldPaintBrokenImage(true)
     , m_autoLoadWasPreventedBySettings(false)
 {
+    m_decodedDataDeletionTimer.setTolerance(decodedDataDeletionTolerance);
     setStatus(Unknown);
 }
 
@@ -66,9 +72,11 @@ CachedImage::CachedImage(Image* image)
     : CachedResource(ResourceRequest(), ImageResource)
     , m_image(image)
     , m_decodedDataDeletionTimer(this, &CachedImage::decodedDataDeletionTimerFired)
+    , m_needsFullResolutionDecode(false)
     , m_shouldPaintBrokenImage(true)
     , m_autoLoadWasPreventedBySettings(false)
 {
+    m_decodedDataDeletionTimer.setTolerance(decodedDataDeletionTolerance);
     setStatus(Cached);
     setLoading(false);
 }
@@ -99,6 +107,10 @@ void CachedImage::didAddClient(CachedResourceClient* c)
 {
     if (m_decodedDataDeletionTimer.isActive())
         m_decodedDataDeletionTimer.stop();
+
+    // A second client may draw the image larger than the first asked for.
+    if (count() > 1 && !m_requestedDecodeSize.isEmpty())
+        requestDecodeSize(IntSize());
     
     if (m_data && !m_image && !errorOccurred()) {
         createImage();
@@ -115,6 +127,11 @@ void CachedImage::allClientsRemoved()
 {
     if (m_image && !errorOccurred())
         m_image->resetAnimation();
+    // The next client to draw the image alone may again ask for a smaller decode.
+    m_requestedDecodeSize = IntSize();
+    m_needsFullResolutionDecode = false;
+    if (m_image)
+        m_image->setDesiredDecodeSize(IntSize());
     if (double interval = memoryCache()->deadDecodedDataDeletionInterval())
         m_decodedDataDeletionTimer.startOneShot(interval);
 }
@@ -144,6 +161,26 @@ void CachedImage::setImageContainerSize(const IntSize& containerSize)
         m_image->setContainerSize(containerSize);
 }
 
+void CachedImage::requestDecodeSize(const IntSize& size)
+{
+    if (m_needsFullResolutionDecode)
+        return;
+
+    // The decoded frames are shared by every client, so only an image drawn by
+    // a single client may be decoded below its intrinsic size. Otherwise a CSS
+    // background or a larger <img> using the same resource would get the
+    // downscaled bitmap.
+    if (size.isEmpty() || count() > 1)
+        m_needsFullResolutionDecode = true;
+    else if (size.width() <= m_requestedDecodeSize.width() && size.height() <= m_requestedDecodeSize.height())
+        return;
+    else
+        m_requestedDecodeSize = m_requestedDecodeSize.expandedTo(size);
+
+    if (m_image)
+        m_image->setDesiredDecodeSize(m_needsFullResolutionDecode ? IntSize() : m_requestedDecodeSize);
+}
+
 bool CachedImage::usesImageContainerSize() const
 {
     if (m_image)
@@ -262,6 +299,8 @@ inline void CachedImage::createImage()
 #if PLATFORM(ANDROID)
     m_image->setURL(url());
 #endif
+    if (!m_needsFullResolutionDecode && !m_requestedDecodeSize.isEmpty())
+        m_image->setDesiredDecodeSize(m_requestedDecodeSize);
 }
 
 size_t CachedImage::maximumDecodedImageSize()
@@ -361,6 +400,14 @@ void CachedImage::didDraw(const Image* image)
     CachedResource::didAccessDecodedData(timeStamp);
 }
 
+void CachedImage::didDecodeFrame(const Image* image, double decodeTime)
+{
+    if (image != m_image)
+        return;
+
+    CachedResource::didDecode(decodeTime);
+}
+
 bool CachedImage::shouldPauseAnimation(const Image* image)
 {
     if (image != m_image)
@@ -51,6 +51,12 @@ public:
 
     // These are only used for SVGImage right now
     void setImageContainerSize(const IntSize&);
+
+    // Clients report the size they draw the image at so that large images
+    // shown small can be decoded at reduced resolution. Only images with a
+    // single client are downscaled; an empty size means a client needs the
+    // full resolution.
+    void requestDecodeSize(const IntSize&);
     bool usesImageContainerSize() const;
     bool imageHasRelativeWidth() const;
     bool imageHasRelativeHeight() const;
@@ -81,6 +87,7 @@ public:
     // ImageObserver
     virtual void decodedSizeChanged(const Image* image, int delta);
     virtual void didDraw(const Image*);
+    virtual void didDecodeFrame(const Image*, double decodeTime);
 
     virtual bool shouldPauseAnimation(const Image*);
     virtual void animationAdvanced(const Image*);
@@ -99,6 +106,8 @@ private:
 
     RefPtr<Image> m_image;
     Timer<CachedImage> m_decodedDataDeletionTimer;
+    IntSize m_requestedDecodeSize;
+    bool m_needsFullResolutionDecode;
     bool m_shouldPaintBrokenImage;
     bool m_autoLoadWasPreventedBySettings;
 };
@@ -85,6 +85,7 @@ CachedResource::CachedResource(const ResourceRequest& request, Type type)
     , m_loadPriority(defaultPriorityForResourceType(type))
     , m_responseTimestamp(currentTime())
     , m_lastDecodedAccessTime(0)
+    , m_decodeCost(0)
     , m_encodedSize(0)
     , m_decodedSize(0)
     , m_accessCount(0)
@@ -359,6 +360,22 @@ void CachedResource::setDecodedSize(unsigned size)
     }
 }
 
+void CachedResource::didDecode(double elapsedTime)
+{
+    // Remember the most expensive decode seen, that is what evicting the decoded data would cost again.
+    if (elapsedTime <= m_decodeCost)
+        return;
+
+    // The cost is part of the LRU list key, so move the object the same way setDecodedSize() does.
+    if (inCache())
+        memoryCache()->removeFromLRUList(this);
+
+    m_decodeCost = elapsedTime;
+
+    if (inCache())
+        memoryCache()->insertInLRUList(this);
+}
+
 void CachedResource::setEncodedSize(unsigned size)
 {
     if (size == m_encodedSize)
@@ -615,9 +632,11 @@ unsigned CachedResource::overheadSize() const
     
 void CachedResource::setLoadPriority(ResourceLoadPriority loadPriority) 
 { 
-    if (loadPriority == ResourceLoadPriorityUnresolved)
+    if (loadPriority == ResourceLoadPriorityUnresolved || loadPriority == m_loadPriority)
         return;
     m_loadPriority = loadPriority;
+    if (m_request)
+        m_request->didChangeLoadPriority(loadPriority);
 }
 
 }
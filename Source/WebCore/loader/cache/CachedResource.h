@@ -147,6 +147,10 @@ public:
     unsigned accessCount() const { return m_accessCount; }
     void increaseAccessCount() { m_accessCount++; }
 
+    // Seconds spent turning the encoded data into its decoded form. The cache weighs
+    // this against size so that resources which are expensive to rebuild live longer.
+    double decodeCost() const { return m_decodeCost; }
+
     // Computes the status of an object after loading.
     // Updates the expire date on the cache entry file
     void finish();
@@ -230,6 +234,7 @@ protected:
     void setEncodedSize(unsigned);
     void setDecodedSize(unsigned);
     void didAccessDecodedData(double timeStamp);
+    void didDecode(double elapsedTime);
 
     bool isSafeToMakePurgeable() const;
 
@@ -257,6 +262,7 @@ private:
     RefPtr<CachedMetadata> m_cachedMetadata;
 
     double m_lastDecodedAccessTime; // Used as a "thrash guard" in the cache
+    double m_decodeCost;
 
     unsigned m_encodedSize;
     unsigned m_decodedSize;
@@ -364,7 +364,11 @@ CachedResource* CachedResourceLoader::requestResource(CachedResource::Type type,
         break;
     case Use:
         memoryCache()->resourceAccessed(resource);
+        memoryCache()->didUseCachedResource(resource);
         notifyLoadedFromMemoryCache(resource);
+        // A load joined while in flight should not finish later than a fresh one would have.
+        if (resource->isLoading() && priority > resource->loadPriority())
+            resource->setLoadPriority(priority);
         break;
     }
 
@@ -136,6 +136,12 @@ PassRefPtr<CachedResourceRequest> CachedResourceRequest::load(CachedResourceLoad
     return request.release();
 }
 
+void CachedResourceRequest::didChangeLoadPriority(ResourceLoadPriority priority)
+{
+    if (m_loader)
+        resourceLoadScheduler()->reprioritize(m_loader.get(), priority);
+}
+
 void CachedResourceRequest::willSendRequest(SubresourceLoader*, ResourceRequest&, const ResourceResponse&)
 {
     m_resource->setRequestedFromNetworkingLayer();
@@ -162,8 +168,11 @@ void CachedResourceRequest::didFinishLoading(SubresourceLoader* loader, double)
     if (!m_resource->errorOccurred()) {
         m_cachedResourceLoader->loadFinishing();
         m_resource->data(loader->resourceData(), true);
-        if (!m_resource->errorOccurred())
+        if (!m_resource->errorOccurred()) {
             m_resource->finish();
+            if (m_resource->inCache())
+                memoryCache()->didLoadResourceFromNetwork(m_resource);
+        }
     }
     m_cachedResourceLoader->loadDone(this);
 }
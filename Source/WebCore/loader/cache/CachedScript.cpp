@@ -32,6 +32,7 @@
 #include "CachedResourceClientWalker.h"
 #include "SharedBuffer.h"
 #include "TextResourceDecoder.h"
+#include <wtf/CurrentTime.h>
 #include <wtf/Vector.h>
 
 #if USE(JSC)  
@@ -84,9 +85,11 @@ const String& CachedScript::script()
     ASSERT(!isPurgeable());
 
     if (!m_script && m_data) {
+        double decodeStartTime = currentTime();
         m_script = m_decoder->decode(m_data->data(), encodedSize());
         m_script += m_decoder->flush();
         setDecodedSize(m_script.length() * sizeof(UChar));
+        didDecode(currentTime() - decodeStartTime);
     }
     m_decodedDataDeletionTimer.startOneShot(0);
     
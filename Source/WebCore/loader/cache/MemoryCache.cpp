@@ -50,6 +50,10 @@ static const int cDefaultCacheCapacity = 8192 * 1024;
 static const double cMinDelayBeforeLiveDecodedPrune = 1; // Seconds.
 static const float cTargetPrunePercentage = .95f; // Percentage of capacity toward which we prune, to avoid immediately pruning again.
 static const double cDefaultDecodedDataDeletionInterval = 0;
+// Decode time, in seconds, that makes a resource count as twice as valuable as its size alone
+// suggests. Expensive resources move to lower LRU lists and so are evicted later (GreedyDual-Size).
+static const double cDecodeCostUnit = 0.005;
+static const unsigned cMaxDecodeCostWeight = 64;
 
 MemoryCache* memoryCache()
 {
@@ -105,13 +109,14 @@ void MemoryCache::revalidationSucceeded(CachedResource* revalidatingResource, co
     ASSERT(resource->isLoaded());
     ASSERT(revalidatingResource->inCache());
     
-    evict(revalidatingResource);
+    evict(revalidatingResource, EvictedOnRequest);
 
     ASSERT(!m_resources.get(resource->url()));
     m_resources.set(resource->url(), resource);
     resource->setInCache(true);
     resource->updateResponseAfterRevalidation(response);
     insertInLRUList(resource);
+    didUseCachedResource(resource);
     int delta = resource->size();
     if (resource->decodedSize() && resource->hasClients())
         insertInLiveDecodedResourcesList(resource);
@@ -137,7 +142,7 @@ CachedResource* MemoryCache::resourceForURL(const KURL& resourceURL)
     bool wasPurgeable = MemoryCache::shouldMakeResourcePurgeableOnEviction() && resource && resource->isPurgeable();
     if (resource && !resource->makePurgeable(false)) {
         ASSERT(!resource->hasClients());
-        evict(resource);
+        evict(resource, EvictedAfterPurge);
         return 0;
     }
     // Add the size back since we had subtracted it when we marked the memory as purgeable.
@@ -226,7 +231,7 @@ void MemoryCache::pruneDeadResources()
                 if (current->wasPurged()) {
                     ASSERT(!current->hasClients());
                     ASSERT(!current->isPreloaded());
-                    evict(current);
+                    evict(current, EvictedAfterPurge);
                 }
                 current = prev;
             }
@@ -264,7 +269,7 @@ void MemoryCache::pruneDeadResources()
             CachedResource* prev = current->m_prevInAllResourcesList;
             if (!current->hasClients() && !current->isPreloaded() && !current->isCacheValidator()) {
                 if (!makeResourcePurgeable(current))
-                    evict(current);
+                    evict(current, EvictedToFreeSpace);
 
                 // If evict() caused pruneDeadResources() to be re-entered, bail out. This can happen when removing an
                 // SVG CachedImage that has subresources.
@@ -321,12 +326,14 @@ bool MemoryCache::makeResourcePurgeable(CachedResource* resource)
     return true;
 }
 
-void MemoryCache::evict(CachedResource* resource)
+void MemoryCache::evict(CachedResource* resource, EvictionReason reason)
 {
     LOG(ResourceLoading, "Evicting resource %p for '%s' from cache", resource, resource->url().string().latin1().data());
     // The resource may have already been removed by someone other than our caller,
     // who needed a fresh copy for a reload. See <http://bugs.webkit.org/show_bug.cgi?id=12479#c6>.
     if (resource->inCache()) {
+        m_accessStatistics.evictions[reason]++;
+
         // Remove from the resource map.
         m_resources.remove(resource->url());
         resource->setInCache(false);
@@ -365,10 +372,16 @@ static inline unsigned fastLog2(unsigned i)
     return log2;
 }
 
+static inline unsigned decodeCostWeight(CachedResource* resource)
+{
+    double weight = 1 + resource->decodeCost() / cDecodeCostUnit;
+    return weight < cMaxDecodeCostWeight ? static_cast<unsigned>(weight) : cMaxDecodeCostWeight;
+}
+
 MemoryCache::LRUList* MemoryCache::lruListFor(CachedResource* resource)
 {
     unsigned accessCount = max(resource->accessCount(), 1U);
-    unsigned queueIndex = fastLog2(resource->size() / accessCount);
+    unsigned queueIndex = fastLog2(resource->size() / (accessCount * decodeCostWeight(resource)));
 #ifndef NDEBUG
     resource->m_lruIndex = queueIndex;
 #endif
@@ -475,6 +488,18 @@ void MemoryCache::resourceAccessed(CachedResource* resource)
     insertInLRUList(resource);
 }
 
+void MemoryCache::didUseCachedResource(CachedResource* resource)
+{
+    m_accessStatistics.hits++;
+    m_accessStatistics.hitBytes += resource->encodedSize();
+}
+
+void MemoryCache::didLoadResourceFromNetwork(CachedResource* resource)
+{
+    m_accessStatistics.misses++;
+    m_accessStatistics.missBytes += resource->encodedSize();
+}
+
 void MemoryCache::removeResourcesWithOrigin(SecurityOrigin* origin)
 {
     Vector<CachedResource*> resourcesWithOrigin;
@@ -606,6 +631,7 @@ void MemoryCache::TypeStatistic::addResource(CachedResource* o)
 MemoryCache::Statistics MemoryCache::getStatistics()
 {
     Statistics stats;
+    stats.accesses = m_accessStatistics;
     CachedResourceMap::iterator e = m_resources.end();
     for (CachedResourceMap::iterator i = m_resources.begin(); i != e; ++i) {
         CachedResource* resource = i->second;
@@ -644,7 +670,7 @@ void MemoryCache::setDisabled(bool disabled)
         CachedResourceMap::iterator i = m_resources.begin();
         if (i == m_resources.end())
             break;
-        evict(i->second);
+        evict(i->second, EvictedOnRequest);
     }
 }
 
@@ -671,6 +697,8 @@ void MemoryCache::dumpStats()
     printf("%-13s %13d %13d %13d %13d %13d %13d\n", "JavaScript", s.scripts.count, s.scripts.size, s.scripts.liveSize, s.scripts.decodedSize, s.scripts.purgeableSize, s.scripts.purgedSize);
     printf("%-13s %13d %13d %13d %13d %13d %13d\n", "Fonts", s.fonts.count, s.fonts.size, s.fonts.liveSize, s.fonts.decodedSize, s.fonts.purgeableSize, s.fonts.purgedSize);
     printf("%-13s %-13s %-13s %-13s %-13s %-13s %-13s\n\n", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------");
+    printf("Hit rate %.1f%%, byte hit rate %.1f%%\n", s.accesses.hitRate() * 100, s.accesses.byteHitRate() * 100);
+    printf("Evictions: %u to free space, %u after purge, %u on request\n\n", s.accesses.evictions[EvictedToFreeSpace], s.accesses.evictions[EvictedAfterPurge], s.accesses.evictions[EvictedOnRequest]);
 }
 
 void MemoryCache::dumpLRULists(bool includeLive) const
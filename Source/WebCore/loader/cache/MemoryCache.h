@@ -77,7 +77,9 @@ class MemoryCache {
 public:
     friend MemoryCache* memoryCache();
 
-    typedef HashMap<String, CachedResource*> CachedResourceMap;
+    // Lookups by URL compare long strings, so let the map reject most
+    // mismatches through its control bytes.
+    typedef HashMap<String, CachedResource*, StringHash, GroupProbingHashTraits<HashTraits<String> > > CachedResourceMap;
 
     struct LRUList {
         CachedResource* m_head;
@@ -96,7 +98,30 @@ public:
         void addResource(CachedResource*);
     };
     
+    enum EvictionReason {
+        EvictedToFreeSpace,
+        EvictedAfterPurge,
+        EvictedOnRequest,
+        NumberOfEvictionReasons
+    };
+
+    struct AccessStatistic {
+        unsigned hits;
+        unsigned misses;
+        unsigned long long hitBytes;
+        unsigned long long missBytes;
+        unsigned evictions[NumberOfEvictionReasons];
+        AccessStatistic() : hits(0), misses(0), hitBytes(0), missBytes(0)
+        {
+            for (unsigned i = 0; i < NumberOfEvictionReasons; ++i)
+                evictions[i] = 0;
+        }
+        double hitRate() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0; }
+        double byteHitRate() const { return hitBytes + missBytes ? static_cast<double>(hitBytes) / (hitBytes + missBytes) : 0; }
+    };
+
     struct Statistics {
+        AccessStatistic accesses;
         TypeStatistic images;
         TypeStatistic cssStyleSheets;
         TypeStatistic scripts;
@@ -109,7 +134,7 @@ public:
     CachedResource* resourceForURL(const KURL&);
     
     bool add(CachedResource* resource);
-    void remove(CachedResource* resource) { evict(resource); }
+    void remove(CachedResource* resource) { evict(resource, EvictedOnRequest); }
 
     static KURL removeFragmentIdentifierIfNeeded(const KURL& originalURL);
     
@@ -167,6 +192,11 @@ public:
     
     void resourceAccessed(CachedResource*);
 
+    // Feed the hit rate counters reported by getStatistics(). A miss is recorded once
+    // the resource has been loaded from the network, when its size is known.
+    void didUseCachedResource(CachedResource*);
+    void didLoadResourceFromNetwork(CachedResource*);
+
     typedef HashSet<RefPtr<SecurityOrigin>, SecurityOriginHash> SecurityOriginSet;
     void removeResourcesWithOrigin(SecurityOrigin*);
     void getOriginsWithCache(SecurityOriginSet& origins);
@@ -188,7 +218,7 @@ private:
     void pruneLiveResources(); // Flush decoded data from resources still referenced by Web pages.
 
     bool makeResourcePurgeable(CachedResource*);
-    void evict(CachedResource*);
+    void evict(CachedResource*, EvictionReason);
 
     bool m_disabled;  // Whether or not the cache is enabled.
     bool m_pruneEnabled;
@@ -212,7 +242,9 @@ private:
     
     // A URL-based map of all resources that are in the cache (including the freshest version of objects that are currently being 
     // referenced by a Web page).
-    HashMap<String, CachedResource*> m_resources;
+    CachedResourceMap m_resources;
+
+    AccessStatistic m_accessStatistics;
 };
 
 inline bool MemoryCache::shouldMakeResourcePurgeableOnEviction()
@@ -975,7 +975,8 @@ void* IconDatabase::iconDatabaseSyncThread()
     makeAllDirectories(m_databaseDirectory);
 
     // Existence of a journal file is evidence of a previous crash/force quit and automatically qualifies
-    // us to do an integrity check
+    // us to do an integrity check. A leftover write-ahead log is not: it survives any exit other than a
+    // clean close, and SQLite replays it safely on open.
     String journalFilename = m_completeDatabasePath + "-journal";
     if (!checkIntegrityOnOpen) {
         AutodrainedPool pool;
@@ -1132,6 +1133,8 @@ void IconDatabase::performOpenInitialization()
                 MutexLocker locker(m_syncLock);
                 // Should've been consumed by SQLite, delete just to make sure we don't see it again in the future;
                 deleteFile(m_completeDatabasePath + "-journal");
+                deleteFile(m_completeDatabasePath + "-wal");
+                deleteFile(m_completeDatabasePath + "-shm");
                 deleteFile(m_completeDatabasePath);
             }
             
@@ -1162,6 +1165,13 @@ void IconDatabase::performOpenInitialization()
     if (!SQLiteStatement(m_syncDB, "PRAGMA cache_size = 200;").executeCommand())         
         LOG_ERROR("SQLite database could not set cache_size");
 
+    // Icons are written a few at a time as pages load. With a write-ahead log those commits
+    // append to the log and are synced at checkpoints, instead of syncing the database each time.
+    if (m_syncDB.enableWriteAheadLogging())
+        m_syncDB.setSynchronous(SQLiteDatabase::SyncNormal);
+    else
+        LOG(IconDatabase, "Could not switch the icon database to a write-ahead log");
+
     // Tell backup software (i.e., Time Machine) to never back up the icon database, because  
     // it's a large file that changes frequently, thus using a lot of backup disk space, and 
     // it's unlikely that many users would be upset about it not being backed up. We could 
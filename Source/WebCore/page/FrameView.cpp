@@ -214,6 +214,8 @@ void FrameView::reset()
     m_borderY = 30;
     m_layoutTimer.stop();
     m_layoutRoot = 0;
+    m_isolatedLayoutRoots.clear();
+    m_laidOutIsolatedRoots.clear();
     m_delayedLayout = false;
     m_doFullRepaint = true;
     m_layoutSchedulingEnabled = true;
@@ -827,6 +829,7 @@ void FrameView::layout(bool allowSubtree)
     if (!allowSubtree && m_layoutRoot) {
         m_layoutRoot->markContainingBlocksForLayout(false);
         m_layoutRoot = 0;
+        clearIsolatedLayoutRoots();
     }
 
     ASSERT(m_frame->view() == this);
@@ -971,6 +974,9 @@ void FrameView::layout(bool allowSubtree)
         if (disableLayoutState)
             view->enableLayoutState();
     }
+
+    if (subtree)
+        layoutIsolatedRoots();
     m_layoutRoot = 0;
 
     m_layoutSchedulingEnabled = true;
@@ -988,6 +994,8 @@ void FrameView::layout(bool allowSubtree)
                                 | RenderLayer::IsCompositingUpdateRoot
                                 | RenderLayer::UpdateCompositingLayers,
                                 subtree ? 0 : &cachedOffset);
+    for (size_t i = 0; i < m_laidOutIsolatedRoots.size(); ++i)
+        m_laidOutIsolatedRoots[i]->enclosingLayer()->updateLayerPositions(RenderLayer::CheckForRepaint | RenderLayer::IsCompositingUpdateRoot | RenderLayer::UpdateCompositingLayers);
     endDeferredRepaints();
 
 #if USE(ACCELERATED_COMPOSITING)
@@ -997,14 +1005,22 @@ void FrameView::layout(bool allowSubtree)
     m_layoutCount++;
 
 #if PLATFORM(MAC) || PLATFORM(CHROMIUM)
-    if (AXObjectCache::accessibilityEnabled())
+    if (AXObjectCache::accessibilityEnabled()) {
         root->document()->axObjectCache()->postNotification(root, AXObjectCache::AXLayoutComplete, true);
+        for (size_t i = 0; i < m_laidOutIsolatedRoots.size(); ++i)
+            root->document()->axObjectCache()->postNotification(m_laidOutIsolatedRoots[i], AXObjectCache::AXLayoutComplete, true);
+    }
 #endif
 #if ENABLE(DASHBOARD_SUPPORT)
     updateDashboardRegions();
 #endif
 
     ASSERT(!root->needsLayout());
+#ifndef NDEBUG
+    for (size_t i = 0; i < m_laidOutIsolatedRoots.size(); ++i)
+        ASSERT(!m_laidOutIsolatedRoots[i]->needsLayout());
+#endif
+    m_laidOutIsolatedRoots.clear();
 
     updateCanBlitOnScrollRecursively();
 
@@ -1730,6 +1746,7 @@ void FrameView::scheduleRelayout()
     if (m_layoutRoot) {
         m_layoutRoot->markContainingBlocksForLayout(false);
         m_layoutRoot = 0;
+        clearIsolatedLayoutRoots();
     }
     if (!m_layoutSchedulingEnabled)
         return;
@@ -1795,12 +1812,16 @@ void FrameView::scheduleRelayoutOfSubtree(RenderObject* relayoutRoot)
                 // Re-root at relayoutRoot
                 m_layoutRoot->markContainingBlocksForLayout(false, relayoutRoot);
                 m_layoutRoot = relayoutRoot;
+                absorbIsolatedLayoutRoots(relayoutRoot);
                 ASSERT(!m_layoutRoot->container() || !m_layoutRoot->container()->needsLayout());
+            } else if (addIsolatedLayoutRoot(relayoutRoot)) {
+                // relayoutRoot will be laid out as a separate subtree after m_layoutRoot.
             } else {
                 // Just do a full relayout
                 if (m_layoutRoot)
                     m_layoutRoot->markContainingBlocksForLayout(false);
                 m_layoutRoot = 0;
+                clearIsolatedLayoutRoots();
                 relayoutRoot->markContainingBlocksForLayout(false);
             }
         }
@@ -1813,6 +1834,106 @@ void FrameView::scheduleRelayoutOfSubtree(RenderObject* relayoutRoot)
     }
 }
 
+bool FrameView::isIsolatedLayoutRoot(RenderObject* root) const
+{
+    Settings* settings = m_frame->settings();
+    if (!settings || !settings->isolatedSubtreeLayoutEnabled())
+        return false;
+
+    // A relayout boundary has a fixed size and clips its overflow, so laying it out
+    // cannot move or resize anything outside of it. Columns, transforms and
+    // reflections above it disable the layout state a subtree layout relies on, and
+    // printing paginates the whole document, so those always take a full layout.
+    RenderView* view = m_frame->contentRenderer();
+    if (!view || root->view() != view || view->printing())
+        return false;
+    if (!objectIsRelayoutBoundary(root) || !root->container() || root->container()->needsLayout())
+        return false;
+    return !view->shouldDisableLayoutStateForSubtree(root);
+}
+
+bool FrameView::addIsolatedLayoutRoot(RenderObject* relayoutRoot)
+{
+    if (!m_layoutRoot || !isIsolatedLayoutRoot(m_layoutRoot) || !isIsolatedLayoutRoot(relayoutRoot))
+        return false;
+
+    for (size_t i = 0; i < m_isolatedLayoutRoots.size(); ++i) {
+        RenderObject* isolatedRoot = m_isolatedLayoutRoots[i];
+        if (isolatedRoot == relayoutRoot)
+            return true;
+        if (isObjectAncestorContainerOf(isolatedRoot, relayoutRoot)) {
+            relayoutRoot->markContainingBlocksForLayout(false, isolatedRoot);
+            return true;
+        }
+    }
+
+    absorbIsolatedLayoutRoots(relayoutRoot);
+    m_isolatedLayoutRoots.append(relayoutRoot);
+    return true;
+}
+
+void FrameView::absorbIsolatedLayoutRoots(RenderObject* newRoot)
+{
+    // Isolated roots inside newRoot are laid out as part of it.
+    for (size_t i = m_isolatedLayoutRoots.size(); i; --i) {
+        RenderObject* isolatedRoot = m_isolatedLayoutRoots[i - 1];
+        if (!isObjectAncestorContainerOf(newRoot, isolatedRoot))
+            continue;
+        if (isolatedRoot != newRoot)
+            isolatedRoot->markContainingBlocksForLayout(false, newRoot);
+        m_isolatedLayoutRoots.remove(i - 1);
+    }
+}
+
+void FrameView::removeIsolatedLayoutRoot(RenderObject* renderer)
+{
+    // Called when a renderer is destroyed, after it was removed from the tree.
+    size_t index = m_isolatedLayoutRoots.find(renderer);
+    if (index != notFound)
+        m_isolatedLayoutRoots.remove(index);
+    index = m_laidOutIsolatedRoots.find(renderer);
+    if (index != notFound)
+        m_laidOutIsolatedRoots.remove(index);
+}
+
+void FrameView::clearIsolatedLayoutRoots()
+{
+    for (size_t i = 0; i < m_isolatedLayoutRoots.size(); ++i)
+        m_isolatedLayoutRoots[i]->markContainingBlocksForLayout(false);
+    m_isolatedLayoutRoots.clear();
+}
+
+void FrameView::layoutIsolatedRoots()
+{
+    // Layout of one root may schedule more roots or fall back to a full layout, so
+    // take the roots one at a time rather than iterating over a snapshot.
+    while (m_layoutRoot && !m_isolatedLayoutRoots.isEmpty()) {
+        RenderObject* root = m_isolatedLayoutRoots[0];
+        m_isolatedLayoutRoots.remove(0);
+
+        if (!root->needsLayout())
+            continue;
+        if (!isIsolatedLayoutRoot(root)) {
+            // Something outside the root changed since it was scheduled. Leave it to
+            // the full layout that follows this one.
+            root->markContainingBlocksForLayout(false);
+            continue;
+        }
+
+        m_layoutRoot = root;
+        m_laidOutIsolatedRoots.append(root);
+
+        RenderView* view = root->view();
+        view->pushLayoutState(root);
+        m_inLayout = true;
+        beginDeferredRepaints();
+        root->layout();
+        endDeferredRepaints();
+        m_inLayout = false;
+        view->popLayoutState(root);
+    }
+}
+
 bool FrameView::layoutPending() const
 {
     return m_layoutTimer.isActive();
@@ -93,6 +93,7 @@ public:
     bool isInLayout() const { return m_inLayout; }
 
     RenderObject* layoutRoot(bool onlyDuringLayout = false) const;
+    void removeIsolatedLayoutRoot(RenderObject*);
     int layoutCount() const { return m_layoutCount; }
 
     bool needsLayout() const;
@@ -306,6 +307,12 @@ private:
 
     void performPostLayoutTasks();
 
+    bool isIsolatedLayoutRoot(RenderObject*) const;
+    bool addIsolatedLayoutRoot(RenderObject*);
+    void absorbIsolatedLayoutRoots(RenderObject* newRoot);
+    void clearIsolatedLayoutRoots();
+    void layoutIsolatedRoots();
+
     virtual void repaintContentRectangle(const IntRect&, bool immediate);
     virtual void contentsResized();
     virtual void visibleContentsResized();
@@ -376,6 +383,12 @@ private:
     Timer<FrameView> m_layoutTimer;
     bool m_delayedLayout;
     RenderObject* m_layoutRoot;
+    // Relayout boundaries unrelated to m_layoutRoot that are laid out as separate
+    // subtrees after it. Only used when isolated subtree layout is enabled.
+    Vector<RenderObject*> m_isolatedLayoutRoots;
+    // Isolated roots laid out by the current layout(), kept until its layer position
+    // and accessibility updates have covered them.
+    Vector<RenderObject*> m_laidOutIsolatedRoots;
     
     bool m_layoutSchedulingEnabled;
     bool m_inLayout;
@@ -203,6 +203,10 @@ Settings::Settings(Page* page)
 #endif
     , m_mediaPlaybackRequiresUserGesture(false)
     , m_mediaPlaybackAllowsInline(true)
+    , m_isolatedSubtreeLayoutEnabled(false)
+#if ENABLE(DOM_NODE_ARENA)
+    , m_domNodeArenaEnabled(false)
+#endif
 {
     // A Frame may not have been created yet, so we initialize the AtomicString 
     // hash before trying to use it.
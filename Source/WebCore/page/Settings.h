@@ -334,6 +334,18 @@ namespace WebCore {
         void setMaximumDecodedImageSize(size_t size) { m_maximumDecodedImageSize = size; }
         size_t maximumDecodedImageSize() const { return m_maximumDecodedImageSize; }
 
+        // Experimental. When enabled, FrameView keeps several unrelated relayout
+        // boundaries pending as separate subtree layouts instead of falling back
+        // to a full layout.
+        void setIsolatedSubtreeLayoutEnabled(bool flag) { m_isolatedSubtreeLayoutEnabled = flag; }
+        bool isolatedSubtreeLayoutEnabled() const { return m_isolatedSubtreeLayoutEnabled; }
+
+#if ENABLE(DOM_NODE_ARENA)
+        // Takes effect for documents created after it is set.
+        void setDOMNodeArenaEnabled(bool flag) { m_domNodeArenaEnabled = flag; }
+        bool domNodeArenaEnabled() const { return m_domNodeArenaEnabled; }
+#endif
+
 #if USE(SAFARI_THEME)
         // Windows debugging pref (global) for switching between the Aqua look and a native windows look.
         static void setShouldPaintNativeControls(bool);
@@ -642,6 +654,10 @@ namespace WebCore {
         bool m_mediaPlaybackRequiresUserGesture : 1;
         bool m_mediaPlaybackAllowsInline : 1;
         bool m_passwordEchoEnabled : 1;
+        bool m_isolatedSubtreeLayoutEnabled : 1;
+#if ENABLE(DOM_NODE_ARENA)
+        bool m_domNodeArenaEnabled : 1;
+#endif
 
 #if USE(SAFARI_THEME)
         static bool gShouldPaintNativeControls;
@@ -50,6 +50,7 @@ static MainThreadSharedTimer* mainThreadSharedTimer()
 
 ThreadTimers::ThreadTimers()
     : m_sharedTimer(0)
+    , m_sharedTimerFireTime(0)
     , m_firingTimers(false)
 {
     if (isMainThread())
@@ -66,6 +67,7 @@ void ThreadTimers::setSharedTimer(SharedTimer* sharedTimer)
     }
     
     m_sharedTimer = sharedTimer;
+    m_sharedTimerFireTime = 0;
     
     if (sharedTimer) {
         m_sharedTimer->setFiredFunction(ThreadTimers::sharedTimerFired);
@@ -77,11 +79,26 @@ void ThreadTimers::updateSharedTimer()
 {
     if (!m_sharedTimer)
         return;
-        
-    if (m_firingTimers || m_timerHeap.isEmpty())
-        m_sharedTimer->stop();
-    else
-        m_sharedTimer->setFireTime(m_timerHeap.first()->m_nextFireTime);
+
+    // The shared timer has just fired, and sharedTimerFiredInternal() sets it
+    // again once it has fired all the timers that are due.
+    if (m_firingTimers)
+        return;
+
+    if (m_timerHeap.isEmpty()) {
+        if (m_sharedTimerFireTime) {
+            m_sharedTimer->stop();
+            m_sharedTimerFireTime = 0;
+        }
+        return;
+    }
+
+    double fireTime = m_timerHeap.first()->m_nextFireTime;
+    if (fireTime == m_sharedTimerFireTime)
+        return;
+    m_sharedTimerFireTime = fireTime;
+    ++m_wakeUpStatistics.sharedTimerUpdates;
+    m_sharedTimer->setFireTime(fireTime);
 }
 
 void ThreadTimers::sharedTimerFired()
@@ -92,21 +109,29 @@ void ThreadTimers::sharedTimerFired()
 
 void ThreadTimers::sharedTimerFiredInternal()
 {
+    // The shared timer is one-shot, so it is no longer set.
+    m_sharedTimerFireTime = 0;
+
     // Do a re-entrancy check.
     if (m_firingTimers)
         return;
     m_firingTimers = true;
+    ++m_wakeUpStatistics.wakeUps;
 
     double fireTime = currentTime();
     double timeToQuit = fireTime + maxDurationOfFiringTimers;
 
     while (!m_timerHeap.isEmpty() && m_timerHeap.first()->m_nextFireTime <= fireTime) {
         TimerBase* timer = m_timerHeap.first();
-        timer->m_nextFireTime = 0;
-        timer->heapDeleteMin();
-
         double interval = timer->repeatInterval();
-        timer->setNextFireTime(interval ? fireTime + interval : 0);
+        if (interval) {
+            // Move a repeating timer to its next fire time without taking it out of the heap.
+            timer->setNextFireTime(timer->alignedFireTime(fireTime + interval));
+        } else {
+            timer->m_nextFireTime = 0;
+            timer->heapDeleteMin();
+        }
+        ++m_wakeUpStatistics.timersFired;
 
         // Once the timer has been fired, it may be deleted, so do nothing else with it after this point.
         timer->fired();
@@ -125,6 +150,8 @@ void ThreadTimers::fireTimersInNestedEventLoop()
 {
     // Reset the reentrancy guard so the timers can fire again.
     m_firingTimers = false;
+    // The shared timer was not kept up to date while timers were firing.
+    m_sharedTimerFireTime = 0;
     updateSharedTimer();
 }
 
@@ -50,6 +50,17 @@ namespace WebCore {
         void updateSharedTimer();
         void fireTimersInNestedEventLoop();
 
+        // Counts of how often timers woke up this thread, for measuring the
+        // effect of timer tolerances on power use.
+        struct WakeUpStatistics {
+            WakeUpStatistics() : wakeUps(0), timersFired(0), sharedTimerUpdates(0) { }
+            unsigned wakeUps; // Times the shared timer fired.
+            unsigned timersFired;
+            unsigned sharedTimerUpdates; // Times the shared timer was set to a new fire time.
+        };
+        const WakeUpStatistics& wakeUpStatistics() const { return m_wakeUpStatistics; }
+        void resetWakeUpStatistics() { m_wakeUpStatistics = WakeUpStatistics(); }
+
     private:
         static void sharedTimerFired();
 
@@ -58,7 +69,9 @@ namespace WebCore {
 
         Vector<TimerBase*> m_timerHeap;
         SharedTimer* m_sharedTimer; // External object, can be a run loop on a worker thread. Normally set/reset by worker thread.
+        double m_sharedTimerFireTime; // 0 if the shared timer is not set.
         bool m_firingTimers; // Reentrancy guard.
+        WakeUpStatistics m_wakeUpStatistics;
     };
 
 }
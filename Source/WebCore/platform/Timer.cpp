@@ -35,6 +35,7 @@
 #include <math.h>
 #include <wtf/CurrentTime.h>
 #include <wtf/HashSet.h>
+#include <wtf/StdLibExtras.h>
 #include <wtf/Vector.h>
 
 using namespace std;
@@ -160,9 +161,14 @@ inline int operator-(TimerHeapIterator a, TimerHeapIterator b) { return a.index(
 
 // ----------------
 
+// Timers with a tolerance fire on the coarsest of these boundaries that their
+// tolerance allows, so that timers started at different times fire together.
+static const double timerAlignmentIntervals[] = { 1.0, 0.25, 1.0 / 16, 1.0 / 64 };
+
 TimerBase::TimerBase()
     : m_nextFireTime(0)
     , m_repeatInterval(0)
+    , m_tolerance(0)
     , m_heapIndex(-1)
 #ifndef NDEBUG
     , m_thread(currentThread())
@@ -181,7 +187,10 @@ void TimerBase::start(double nextFireInterval, double repeatInterval)
     ASSERT(m_thread == currentThread());
 
     m_repeatInterval = repeatInterval;
-    setNextFireTime(currentTime() + nextFireInterval);
+    // A zero interval asks for the timer to fire as soon as possible, for example
+    // to drop decoded data under memory pressure, so the tolerance doesn't apply.
+    double fireTime = currentTime() + nextFireInterval;
+    setNextFireTime(nextFireInterval > 0 ? alignedFireTime(fireTime) : fireTime);
 }
 
 void TimerBase::stop()
@@ -248,8 +257,30 @@ void TimerBase::heapDeleteMin()
 inline void TimerBase::heapIncreaseKey()
 {
     ASSERT(m_nextFireTime != 0);
-    heapPop();
-    heapDecreaseKey();
+    checkHeapIndex();
+
+    // Sift the timer down in place. Repeating timers go through here every
+    // time they fire, so this saves a removal and a reinsertion.
+    Vector<TimerBase*>& heap = timerHeap();
+    int size = heap.size();
+    int index = m_heapIndex;
+    while (true) {
+        int child = 2 * index + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && TimerHeapElement(child) < TimerHeapElement(child + 1))
+            ++child;
+        // Stop once this timer fires before the earlier of its children.
+        if (!(TimerHeapElement(index) < TimerHeapElement(child)))
+            break;
+        heap[index] = heap[child];
+        heap[index]->m_heapIndex = index;
+        heap[child] = this;
+        m_heapIndex = child;
+        index = child;
+    }
+
+    checkHeapIndex();
 }
 
 inline void TimerBase::heapInsert()
@@ -310,6 +341,18 @@ void TimerBase::setNextFireTime(double newTime)
     checkConsistency();
 }
 
+double TimerBase::alignedFireTime(double fireTime) const
+{
+    if (!m_tolerance)
+        return fireTime;
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(timerAlignmentIntervals); ++i) {
+        double interval = timerAlignmentIntervals[i];
+        if (interval <= m_tolerance)
+            return ceil(fireTime / interval) * interval;
+    }
+    return fireTime;
+}
+
 void TimerBase::fireTimersInNestedEventLoop()
 {
     // Redirect to ThreadTimers.
@@ -55,6 +55,13 @@ public:
     void augmentFireInterval(double delta) { setNextFireTime(m_nextFireTime + delta); }
     void augmentRepeatInterval(double delta) { augmentFireInterval(delta); m_repeatInterval += delta; }
 
+    // How late the timer may fire.  Timers with a tolerance are aligned onto
+    // common fire times so that they wake up the thread together.  Takes
+    // effect the next time the timer is started with a non-zero interval or
+    // repeats.
+    double tolerance() const { return m_tolerance; }
+    void setTolerance(double tolerance) { m_tolerance = tolerance; }
+
     static void fireTimersInNestedEventLoop();
 
 private:
@@ -64,6 +71,7 @@ private:
     void checkHeapIndex() const;
 
     void setNextFireTime(double);
+    double alignedFireTime(double) const;
 
     bool inHeap() const { return m_heapIndex != -1; }
 
@@ -77,6 +85,7 @@ private:
 
     double m_nextFireTime; // 0 if inactive
     double m_repeatInterval; // 0 if not repeating
+    double m_tolerance; // 0 if the timer must fire on time
     int m_heapIndex; // -1 if not in heap
     unsigned m_heapInsertionOrder; // Used to keep order among equal-fire-time timers
 
@@ -76,8 +76,14 @@ BitmapImage::~BitmapImage()
 void BitmapImage::destroyDecodedData(bool destroyAll)
 {
     int framesCleared = 0;
-    const size_t clearBeforeFrame = destroyAll ? m_frames.size() : m_currentFrame;
+    // If the source can decode dropped frames again, we hold on to nothing
+    // but the frame being shown, which also lets it drop frames from earlier
+    // loops of the animation.
+    const bool keepOnlyCurrentFrame = !destroyAll && m_source.canRedecodeClearedFrames();
+    const size_t clearBeforeFrame = (destroyAll || keepOnlyCurrentFrame) ? m_frames.size() : m_currentFrame;
     for (size_t i = 0; i < clearBeforeFrame; ++i) {
+        if (keepOnlyCurrentFrame && i == m_currentFrame)
+            continue;
         // The underlying frame isn't actually changing (we're just trying to
         // save the memory for the framebuffer data), so we don't need to clear
         // the metadata.
@@ -87,10 +93,25 @@ void BitmapImage::destroyDecodedData(bool destroyAll)
 
     destroyMetadataAndNotify(framesCleared);
 
-    m_source.clear(destroyAll, clearBeforeFrame, data(), m_allDataReceived);
+    m_source.clear(destroyAll, keepOnlyCurrentFrame ? m_currentFrame : clearBeforeFrame, data(), m_allDataReceived);
     return;
 }
 
+void BitmapImage::setDesiredDecodeSize(const IntSize& desiredSize)
+{
+    if (desiredSize == m_desiredDecodeSize)
+        return;
+
+    // Frames already decoded at a smaller size would look blurry at the new
+    // one, so throw them away and let them be decoded again.
+    bool grew = !m_desiredDecodeSize.isEmpty()
+        && (desiredSize.isEmpty() || desiredSize.width() > m_desiredDecodeSize.width() || desiredSize.height() > m_desiredDecodeSize.height());
+    m_desiredDecodeSize = desiredSize;
+    m_source.setDesiredSize(desiredSize);
+    if (grew && m_decodedSize)
+        destroyDecodedData(true);
+}
+
 void BitmapImage::destroyDecodedDataIfNecessary(bool destroyAll)
 {
     // Animated images >5MB are considered large enough that we'll only hang on
@@ -124,7 +145,10 @@ void BitmapImage::cacheFrame(size_t index)
     if (m_frames.size() < numFrames)
         m_frames.grow(numFrames);
 
+    double decodeStartTime = currentTime();
     m_frames[index].m_frame = m_source.createFrameAtIndex(index);
+    if (m_frames[index].m_frame && imageObserver())
+        imageObserver()->didDecodeFrame(this, currentTime() - decodeStartTime);
     if (numFrames == 1 && m_frames[index].m_frame)
         checkForSolidColor();
 
@@ -454,7 +478,9 @@ bool BitmapImage::internalAdvanceAnimation(bool skippingFrames)
             advancedAnimation = false;
         } else {
             m_currentFrame = 0;
-            destroyAll = true;
+            // Starting over means decoding from the first frame again, unless
+            // the source can decode it again from what it has kept.
+            destroyAll = !m_source.canRedecodeClearedFrames();
         }
     }
     destroyDecodedDataIfNecessary(destroyAll);
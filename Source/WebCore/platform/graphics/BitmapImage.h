@@ -123,6 +123,7 @@ public:
     virtual bool getHotSpot(IntPoint&) const;
 
     virtual bool dataChanged(bool allDataReceived);
+    virtual void setDesiredDecodeSize(const IntSize&);
     virtual String filenameExtension() const; 
 
     // It may look unusual that there is no start animation call as public API.  This is because
@@ -266,6 +267,7 @@ protected:
     virtual Color solidColor() const { return m_solidColor; }
     
     ImageSource m_source;
+    IntSize m_desiredDecodeSize;
     mutable IntSize m_size; // The size to use for the overall image (will just be the size of the first image).
     
     size_t m_currentFrame; // The index of the current frame of animation.
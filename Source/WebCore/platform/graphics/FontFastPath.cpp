@@ -446,11 +446,46 @@ void Font::drawEmphasisMarks(GraphicsContext* context, const GlyphBuffer& glyphB
     drawGlyphBuffer(context, markBuffer, startPoint);
 }
 
+// Whether the width of the run depends only on its characters, direction and
+// spacing, and on the fonts its characters are drawn with.
+static bool canUseWidthCache(const Font& font, const TextRun& run)
+{
+    // Expansion is spread over a whole line, and tabs depend on where the run starts.
+    if (run.expansion() || font.isSmallCaps() || font.typesettingFeatures())
+        return false;
+#if ENABLE(SVG)
+    if (run.horizontalGlyphStretch() != 1)
+        return false;
+#endif
+    if (run.allowTabs()) {
+        for (int i = 0; i < run.length(); ++i) {
+            if (run[i] == '\t')
+                return false;
+        }
+    }
+    return true;
+}
+
 float Font::floatWidthForSimpleText(const TextRun& run, GlyphBuffer* glyphBuffer, HashSet<const SimpleFontData*>* fallbackFonts, GlyphOverflow* glyphOverflow) const
 {
+    // Line layout measures the same words over and over, so the widths of short
+    // runs are kept in the primary font's cache.
+    float* cachedWidth = 0;
+    if (!glyphBuffer && !glyphOverflow && run.length() <= static_cast<int>(WidthCache::maximumLength) && canUseWidthCache(*this, run)) {
+        bool hasSpacing = !run.spacingDisabled();
+        cachedWidth = primaryFont()->widthCache().add(run.characters(), run.length(), run.rtl(),
+            hasSpacing ? letterSpacing() : 0, hasSpacing ? wordSpacing() : 0);
+        if (cachedWidth && !isnan(*cachedWidth))
+            return *cachedWidth;
+    }
+
     WidthIterator it(this, run, fallbackFonts, glyphOverflow);
     it.advance(run.length(), glyphBuffer);
 
+    // A width that depends on fallback fonts depends on more than the primary font.
+    if (cachedWidth && it.usedOnlyPrimaryFont())
+        *cachedWidth = it.m_runWidthSoFar;
+
     if (glyphOverflow) {
         glyphOverflow->top = max<int>(glyphOverflow->top, ceilf(-it.minGlyphBoundingBoxY()) - (glyphOverflow->computeBounds ? 0 : fontMetrics().ascent()));
         glyphOverflow->bottom = max<int>(glyphOverflow->bottom, ceilf(it.maxGlyphBoundingBoxY()) - (glyphOverflow->computeBounds ? 0 : fontMetrics().descent()));
@@ -97,6 +97,9 @@ public:
 
     // These are only used for SVGImage right now
     virtual void setContainerSize(const IntSize&) { }
+    // The size the image will be drawn at, as a hint to decode fewer pixels.
+    // An empty size asks for full resolution.
+    virtual void setDesiredDecodeSize(const IntSize&) { }
     virtual bool usesContainerSize() const { return false; }
     virtual bool hasRelativeWidth() const { return false; }
     virtual bool hasRelativeHeight() const { return false; }
@@ -39,6 +39,7 @@ protected:
 public:
     virtual void decodedSizeChanged(const Image*, int delta) = 0;
     virtual void didDraw(const Image*) = 0;
+    virtual void didDecodeFrame(const Image*, double /* decodeTime */) { }
 
     virtual bool shouldPauseAnimation(const Image*) = 0;
     virtual void animationAdvanced(const Image*) = 0;
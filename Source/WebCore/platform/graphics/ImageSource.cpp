@@ -35,6 +35,8 @@
 #include "ImageDecoder.h"
 #endif
 
+#include <wtf/UnusedParam.h>
+
 namespace WebCore {
 
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
@@ -72,6 +74,11 @@ bool ImageSource::initialized() const
     return m_decoder;
 }
 
+bool ImageSource::canRedecodeClearedFrames() const
+{
+    return m_decoder && m_decoder->canRedecodeClearedFrames();
+}
+
 void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
 {
     // Make the decoder by sniffing the bytes.
@@ -83,6 +90,8 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
         if (m_decoder && s_maxPixelsPerDecodedImage)
             m_decoder->setMaxNumPixels(s_maxPixelsPerDecodedImage);
+        if (m_decoder)
+            m_decoder->setDesiredSize(m_desiredSize);
 #endif
     }
 
@@ -90,6 +99,19 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
         m_decoder->setData(data, allDataReceived);
 }
 
+void ImageSource::setDesiredSize(const IntSize& desiredSize)
+{
+    // Only ports that scale downsampled frames back up when drawing (see
+    // ENABLE(IMAGE_DECODER_DOWN_SAMPLING)) can decode below intrinsic size.
+#if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
+    m_desiredSize = desiredSize;
+    if (m_decoder)
+        m_decoder->setDesiredSize(desiredSize);
+#else
+    UNUSED_PARAM(desiredSize);
+#endif
+}
+
 String ImageSource::filenameExtension() const
 {
     return m_decoder ? m_decoder->filenameExtension() : String();
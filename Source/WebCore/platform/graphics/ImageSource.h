@@ -27,6 +27,7 @@
 #ifndef ImageSource_h
 #define ImageSource_h
 
+#include "IntSize.h"
 #include <wtf/Forward.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/Vector.h>
@@ -166,7 +167,8 @@ public:
     // decoded frames.
     //
     // Callers should not call clear(false, n) and subsequently call
-    // createFrameAtIndex(m) with m < n, unless they first call clear(true).
+    // createFrameAtIndex(m) with m < n, unless they first call clear(true)
+    // or canRedecodeClearedFrames() is true.
     // This ensures that stateful ImageSources/decoders will work properly.
     //
     // The |data| and |allDataReceived| parameters should be supplied by callers
@@ -178,11 +180,22 @@ public:
                SharedBuffer* data = NULL,
                bool allDataReceived = false);
 
+    // Whether the ImageSource decodes frames dropped by clear(false, n) again
+    // on demand.  If so, callers may call clear(false, n) while holding only
+    // frame n, the ImageSource may then drop any other frame, and frames
+    // before n may be created again without calling clear(true).
+    bool canRedecodeClearedFrames() const;
+
     bool initialized() const;
 
     void setData(SharedBuffer* data, bool allDataReceived);
     String filenameExtension() const;
 
+    // Hints the size the image is displayed at, so that decoders which can
+    // downscale while decoding don't produce more pixels than will be shown.
+    // Implementations may ignore it.  An empty size asks for full resolution.
+    void setDesiredSize(const IntSize&);
+
     bool isSizeAvailable();
     IntSize size() const;
     IntSize frameSizeAtIndex(size_t) const;
@@ -221,6 +234,7 @@ protected:
     NativeImageSourcePtr m_decoder;
     AlphaOption m_alphaOption;
     GammaAndColorProfileOption m_gammaAndColorProfileOption;
+    IntSize m_desiredSize;
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
     static unsigned s_maxPixelsPerDecodedImage;
 #endif
@@ -32,6 +32,7 @@
 #include "GlyphMetricsMap.h"
 #include "GlyphPageTreeNode.h"
 #include "TypesettingFeatures.h"
+#include "WidthCache.h"
 #include <wtf/OwnPtr.h>
 #include <wtf/PassOwnPtr.h>
 
@@ -115,6 +116,8 @@ public:
 
     float spaceWidth() const { return m_spaceWidth; }
 
+    WidthCache& widthCache() const { return m_widthCache; }
+
 #if USE(CG) || USE(CAIRO) || PLATFORM(WX) || USE(SKIA_ON_MAC_CHROME)
     float syntheticBoldOffset() const { return m_syntheticBoldOffset; }
 #endif
@@ -211,6 +214,7 @@ private:
 
     mutable OwnPtr<GlyphMetricsMap<FloatRect> > m_glyphToBoundsMap;
     mutable GlyphMetricsMap<float> m_glyphToWidthMap;
+    mutable WidthCache m_widthCache;
 
     bool m_treatAsFixedPitch;
 
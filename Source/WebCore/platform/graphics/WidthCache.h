@@ -0,0 +1,142 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WidthCache_h
+#define WidthCache_h
+
+#include <string.h>
+#include <wtf/HashFunctions.h>
+#include <wtf/HashMap.h>
+#include <wtf/HashTraits.h>
+#include <wtf/MathExtras.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/StringHasher.h>
+#include <wtf/unicode/Unicode.h>
+
+namespace WebCore {
+
+// Remembers the widths of short runs of text in one font, such as the words
+// that line layout measures over and over while it looks for line breaks.
+// Font::floatWidthForSimpleText() only stores widths that depend on nothing
+// but the characters, this font, the direction and the spacing in the key.
+// Fonts never change once created, so a font's cache never goes stale; a
+// font that changes, such as a web font that finishes loading, comes with a
+// new SimpleFontData and a new, empty cache.
+class WidthCache {
+    WTF_MAKE_NONCOPYABLE(WidthCache);
+public:
+    static const unsigned maximumLength = 16;
+
+    WidthCache() { }
+
+    // Returns the slot for the width of the text, which is NaN if the width
+    // isn't known yet. Returns 0 if the text is too long to cache. The slot
+    // is only valid until the next call.
+    float* add(const UChar* characters, unsigned length, bool rtl, short letterSpacing, short wordSpacing)
+    {
+        if (!length || length > maximumLength)
+            return 0;
+
+        // Clearing is cheaper than tracking use, and the common words of a
+        // page come back quickly.
+        if (m_widths.size() >= maximumSize)
+            m_widths.clear();
+
+        Key key(characters, length, rtl, letterSpacing, wordSpacing);
+        return &m_widths.add(key, std::numeric_limits<float>::quiet_NaN()).first->second;
+    }
+
+private:
+    static const unsigned maximumSize = 1024;
+
+    class Key {
+    public:
+        Key()
+            : m_hash(0)
+            , m_length(0)
+            , m_rtl(false)
+            , m_letterSpacing(0)
+            , m_wordSpacing(0)
+        {
+        }
+
+        Key(WTF::HashTableDeletedValueType)
+            : m_hash(0)
+            , m_length(deletedLength)
+            , m_rtl(false)
+            , m_letterSpacing(0)
+            , m_wordSpacing(0)
+        {
+        }
+
+        Key(const UChar* characters, unsigned length, bool rtl, short letterSpacing, short wordSpacing)
+            : m_length(length)
+            , m_rtl(rtl)
+            , m_letterSpacing(letterSpacing)
+            , m_wordSpacing(wordSpacing)
+        {
+            ASSERT(length && length <= maximumLength);
+            memcpy(m_characters, characters, length * sizeof(UChar));
+            uint64_t settings = static_cast<uint64_t>(rtl) << 32 | static_cast<unsigned short>(letterSpacing) << 16 | static_cast<unsigned short>(wordSpacing);
+            m_hash = StringHasher::computeHash(characters, length) ^ WTF::intHash(settings);
+        }
+
+        bool isHashTableDeletedValue() const { return m_length == deletedLength; }
+        unsigned hash() const { return m_hash; }
+
+        bool operator==(const Key& other) const
+        {
+            return m_hash == other.m_hash && m_length == other.m_length && m_rtl == other.m_rtl
+                && m_letterSpacing == other.m_letterSpacing && m_wordSpacing == other.m_wordSpacing
+                && (m_length == deletedLength || !memcmp(m_characters, other.m_characters, m_length * sizeof(UChar)));
+        }
+
+    private:
+        static const unsigned short deletedLength = 0xffff;
+
+        unsigned m_hash;
+        unsigned short m_length;
+        bool m_rtl;
+        short m_letterSpacing;
+        short m_wordSpacing;
+        UChar m_characters[maximumLength];
+    };
+
+    struct KeyHash {
+        static unsigned hash(const Key& key) { return key.hash(); }
+        static bool equal(const Key& a, const Key& b) { return a == b; }
+        static const bool safeToCompareToEmptyOrDeleted = true;
+    };
+
+    struct KeyTraits : WTF::SimpleClassHashTraits<Key> {
+        static const bool needsDestruction = false;
+    };
+
+    HashMap<Key, float, KeyHash, KeyTraits> m_widths;
+};
+
+} // namespace WebCore
+
+#endif // WidthCache_h
@@ -55,6 +55,7 @@ WidthIterator::WidthIterator(const Font* font, const TextRun& run, HashSet<const
     , m_firstGlyphOverflow(0)
     , m_lastGlyphOverflow(0)
     , m_forTextEmphasis(forTextEmphasis)
+    , m_usedOnlyPrimaryFont(true)
 {
     // If the padding is non-zero, count the number of spaces in the run
     // and divide that by the padding for per space addition.
@@ -125,6 +126,8 @@ void WidthIterator::advance(int offset, GlyphBuffer* glyphBuffer)
         const SimpleFontData* fontData = glyphData.fontData;
 
         ASSERT(fontData);
+        if (fontData != primaryFont)
+            m_usedOnlyPrimaryFont = false;
 
         // Now that we have a glyph and font data, get its width.
         float width;
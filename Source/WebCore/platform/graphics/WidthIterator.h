@@ -43,6 +43,9 @@ struct WidthIterator {
     float firstGlyphOverflow() const { ASSERT(m_accountForGlyphBounds); return m_firstGlyphOverflow; }
     float lastGlyphOverflow() const { ASSERT(m_accountForGlyphBounds); return m_lastGlyphOverflow; }
 
+    // Whether every character so far was drawn with the primary font.
+    bool usedOnlyPrimaryFont() const { return m_usedOnlyPrimaryFont; }
+
     const Font* m_font;
 
     const TextRun& m_run;
@@ -64,6 +67,7 @@ private:
     float m_firstGlyphOverflow;
     float m_lastGlyphOverflow;
     bool m_forTextEmphasis;
+    bool m_usedOnlyPrimaryFont;
 };
 
 }
@@ -155,6 +155,35 @@ static int computeSampleSize(const SkBitmap& bitmap) {
     return sampleSize;
 }
 
+bool ImageSource::canRedecodeClearedFrames() const
+{
+#ifdef ANDROID_ANIMATED_GIF
+    return m_decoder.m_gifDecoder && m_decoder.m_gifDecoder->canRedecodeClearedFrames();
+#else
+    return false;
+#endif
+}
+
+// Returns the largest power of two subsampling that still leaves the image at
+// least as large as |desiredSize| in both dimensions.
+static int computeDesiredSampleSize(int origWidth, int origHeight, const IntSize& desiredSize)
+{
+    if (desiredSize.isEmpty())
+        return 1;
+
+    int sampleSize = 1;
+    while (origWidth / (sampleSize << 1) >= desiredSize.width()
+            && origHeight / (sampleSize << 1) >= desiredSize.height())
+        sampleSize <<= 1;
+    return sampleSize;
+}
+
+void ImageSource::setDesiredSize(const IntSize& desiredSize)
+{
+    // Takes effect when the pixels are allocated, once all data is received.
+    m_desiredSize = desiredSize;
+}
+
 void ImageSource::clearURL() 
 {
     m_decoder.m_url.reset(); 
@@ -259,6 +288,25 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
     if (allDataReceived && decoder && !decoder->fAllDataReceived) {
         decoder->fAllDataReceived = true;
 
+        // By now the image has usually been laid out, so we know whether it
+        // is shown much smaller than its intrinsic size. If so, decode fewer
+        // pixels than the memory cap alone would allow.
+        int desiredSampleSize = computeDesiredSampleSize(decoder->origWidth(), decoder->origHeight(), m_desiredSize);
+        if (desiredSampleSize > decoder->fSampleSize) {
+            SkMemoryStream stream(data->data(), data->size(), false);
+            SkImageDecoder* codec = SkImageDecoder::Factory(&stream);
+            if (codec) {
+                SkAutoTDelete<SkImageDecoder> ad(codec);
+                codec->setPrefConfigTable(gPrefConfigTable);
+                codec->setSampleSize(desiredSampleSize);
+                SkBitmap tmp;
+                if (codec->decode(&stream, &tmp, SkImageDecoder::kDecodeBounds_Mode)) {
+                    decoder->bitmap() = tmp;
+                    decoder->fSampleSize = desiredSampleSize;
+                }
+            }
+        }
+
         SkBitmap* bm = &decoder->bitmap();
 
         BitmapAllocatorAndroid alloc(data, decoder->fSampleSize);
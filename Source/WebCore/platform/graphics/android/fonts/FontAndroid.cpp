@@ -53,10 +53,15 @@
 #include "HarfbuzzSkia.h"
 #include <unicode/normlzr.h>
 #include <unicode/uchar.h>
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
 #include <wtf/OwnArrayPtr.h>
 #include <wtf/OwnPtr.h>
 #include <wtf/PassOwnArrayPtr.h>
 #include <wtf/PassOwnPtr.h>
+#include <wtf/RefCounted.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
 #include <wtf/unicode/CharacterNames.h>
 #include <wtf/unicode/Unicode.h>
 #endif
@@ -404,6 +409,83 @@ static int truncateFixedPointToInteger(HB_Fixed value)
     return value >> 6;
 }
 
+// The output of shaping one word: glyphs in logical order, and the cluster log
+// relative to the start of the word.
+class ShapedWord : public RefCounted<ShapedWord> {
+public:
+    static PassRefPtr<ShapedWord> create(const HB_ShaperItem& item)
+    {
+        return adoptRef(new ShapedWord(item));
+    }
+
+    unsigned length() const { return m_glyphs.size(); }
+    const HB_Glyph* glyphs() const { return m_glyphs.data(); }
+    const HB_GlyphAttributes* attributes() const { return m_attributes.data(); }
+    const HB_Fixed* advances() const { return m_advances.data(); }
+    const HB_FixedPoint* offsets() const { return m_offsets.data(); }
+    const Vector<unsigned short>& logClusters() const { return m_logClusters; }
+
+private:
+    ShapedWord(const HB_ShaperItem& item)
+    {
+        m_glyphs.append(item.glyphs, item.num_glyphs);
+        m_attributes.append(item.attributes, item.num_glyphs);
+        m_advances.append(item.advances, item.num_glyphs);
+        m_offsets.append(item.offsets, item.num_glyphs);
+        m_logClusters.append(item.log_clusters, item.item.length);
+    }
+
+    Vector<HB_Glyph> m_glyphs;
+    Vector<HB_GlyphAttributes> m_attributes;
+    Vector<HB_Fixed> m_advances;
+    Vector<HB_FixedPoint> m_offsets;
+    Vector<unsigned short> m_logClusters;
+};
+
+// Layout measures each word for line breaking, and then measures and paints
+// the lines made of them, so complex text would be shaped several times over.
+// This keeps the most recently shaped words, keyed by the font, script,
+// direction and characters.
+class ShapedWordCache {
+public:
+    // Longer words, such as script runs in languages that don't separate words
+    // with spaces, are shaped without being cached.
+    static const unsigned maximumWordLength = 64;
+
+    PassRefPtr<ShapedWord> get(const String& key)
+    {
+        RefPtr<ShapedWord> word = m_words.get(key);
+        if (word) {
+            // Move it to the end of the eviction order.
+            m_order.remove(key);
+            m_order.add(key);
+        }
+        return word.release();
+    }
+
+    void add(const String& key, PassRefPtr<ShapedWord> word)
+    {
+        if (m_words.size() >= capacity) {
+            m_words.remove(m_order.first());
+            m_order.remove(m_order.begin());
+        }
+        m_words.set(key, word);
+        m_order.add(key);
+    }
+
+private:
+    static const unsigned capacity = 2048;
+
+    HashMap<String, RefPtr<ShapedWord> > m_words;
+    ListHashSet<String> m_order;
+};
+
+static ShapedWordCache& shapedWordCache()
+{
+    DEFINE_STATIC_LOCAL(ShapedWordCache, cache, ());
+    return cache;
+}
+
 // TextRunWalker walks a TextRun and presents each script run in sequence. A
 // TextRun is a sequence of code-points with the same embedding level (i.e. they
 // are all left-to-right or right-to-left). A script run is a subsequence where
@@ -499,6 +581,8 @@ private:
     void createGlyphArrays(int);
     void resetGlyphArrays();
     void shapeGlyphs();
+    PassRefPtr<ShapedWord> shapeWord(unsigned pos, unsigned length);
+    String shapedWordKey(unsigned pos, unsigned length);
     void setGlyphPositions(bool);
 
     static void normalizeSpacesAndMirrorChars(const UChar* source, bool rtl,
@@ -794,6 +878,72 @@ void TextRunWalker::resetGlyphArrays()
 
 void TextRunWalker::shapeGlyphs()
 {
+    // Shape the script run a word at a time, so that the words can be cached
+    // and shared between measuring and painting. Words are split at spaces,
+    // which the shapers don't form clusters or ligatures across.
+    const unsigned runStart = m_item.item.pos;
+    const unsigned runLength = m_item.item.length;
+
+    Vector<RefPtr<ShapedWord>, 16> words;
+    unsigned numGlyphs = 0;
+    unsigned wordStart = runStart;
+    while (wordStart < runStart + runLength) {
+        bool isSpace = isCodepointSpace(m_item.string[wordStart]);
+        unsigned wordEnd = wordStart + 1;
+        while (wordEnd < runStart + runLength && isCodepointSpace(m_item.string[wordEnd]) == isSpace)
+            ++wordEnd;
+
+        unsigned wordLength = wordEnd - wordStart;
+        RefPtr<ShapedWord> word;
+        if (wordLength <= ShapedWordCache::maximumWordLength) {
+            String key = shapedWordKey(wordStart, wordLength);
+            word = shapedWordCache().get(key);
+            if (!word) {
+                word = shapeWord(wordStart, wordLength);
+                shapedWordCache().add(key, word);
+            }
+        } else
+            word = shapeWord(wordStart, wordLength);
+
+        numGlyphs += word->length();
+        words.append(word.release());
+        wordStart = wordEnd;
+    }
+
+    m_item.item.pos = runStart;
+    m_item.item.length = runLength;
+
+    if (numGlyphs > m_glyphsArrayCapacity) {
+        deleteGlyphArrays();
+        createGlyphArrays(numGlyphs);
+    }
+    m_item.num_glyphs = numGlyphs;
+    resetGlyphArrays();
+
+    // Lay the words out one after another, as if the run had been shaped whole.
+    unsigned glyphOffset = 0;
+    unsigned clusterOffset = 0;
+    for (size_t i = 0; i < words.size(); ++i) {
+        const ShapedWord* word = words[i].get();
+        unsigned length = word->length();
+        memcpy(m_item.glyphs + glyphOffset, word->glyphs(), length * sizeof(HB_Glyph));
+        memcpy(m_item.attributes + glyphOffset, word->attributes(), length * sizeof(HB_GlyphAttributes));
+        memcpy(m_item.advances + glyphOffset, word->advances(), length * sizeof(HB_Fixed));
+        memcpy(m_item.offsets + glyphOffset, word->offsets(), length * sizeof(HB_FixedPoint));
+        const Vector<unsigned short>& logClusters = word->logClusters();
+        for (size_t j = 0; j < logClusters.size(); ++j)
+            m_item.log_clusters[clusterOffset + j] = logClusters[j] + glyphOffset;
+
+        glyphOffset += length;
+        clusterOffset += logClusters.size();
+    }
+}
+
+PassRefPtr<ShapedWord> TextRunWalker::shapeWord(unsigned pos, unsigned length)
+{
+    m_item.item.pos = pos;
+    m_item.item.length = length;
+
     // HB_ShapeItem() resets m_item.num_glyphs. If the previous call to
     // HB_ShapeItem() used less space than was available, the capacity of
     // the array may be larger than the current value of m_item.num_glyphs.
@@ -807,6 +957,28 @@ void TextRunWalker::shapeGlyphs()
         createGlyphArrays(m_item.num_glyphs << 1);
         resetGlyphArrays();
     }
+
+    return ShapedWord::create(m_item);
+}
+
+String TextRunWalker::shapedWordKey(unsigned pos, unsigned length)
+{
+    // The font and shaping state go in front of the characters.
+    const FontPlatformData* platformData = fontPlatformDataForScriptRun();
+    uint32_t fontID = platformData->uniqueID();
+    uint32_t size = bitwise_cast<uint32_t>(platformData->size());
+    unsigned flags = platformData->isFakeBold() | platformData->isFakeItalic() << 1
+        | platformData->orientation() << 2 | m_item.item.bidiLevel << 3;
+
+    Vector<UChar, 64> key;
+    key.append(static_cast<UChar>(fontID >> 16));
+    key.append(static_cast<UChar>(fontID));
+    key.append(static_cast<UChar>(size >> 16));
+    key.append(static_cast<UChar>(size));
+    key.append(static_cast<UChar>(flags));
+    key.append(static_cast<UChar>(m_item.item.script));
+    key.append(m_item.string + pos, length);
+    return String::adopt(key);
 }
 
 void TextRunWalker::setGlyphPositions(bool isRTL)
@@ -81,6 +81,16 @@ ImageSource::~ImageSource()
     clear(true);
 }
 
+bool ImageSource::canRedecodeClearedFrames() const
+{
+    return false;
+}
+
+void ImageSource::setDesiredSize(const IntSize&)
+{
+    // ImageIO decodes at intrinsic size.
+}
+
 void ImageSource::clear(bool destroyAllFrames, size_t, SharedBuffer* data, bool allDataReceived)
 {
 #if !defined(BUILDING_ON_TIGER) && !defined(BUILDING_ON_LEOPARD)
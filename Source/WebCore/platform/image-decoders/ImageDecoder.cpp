@@ -284,20 +284,59 @@ template <MatchType type> int getScaledValue(const Vector<int>& scaledValues, in
 
 }
 
+void ImageDecoder::setDesiredSize(const IntSize& desiredSize)
+{
+    if (desiredSize == m_desiredSize)
+        return;
+    m_desiredSize = desiredSize;
+
+    if (m_sizeAvailable && !hasStartedDecodingFrames())
+        prepareScaleDataIfNecessary();
+}
+
+bool ImageDecoder::hasStartedDecodingFrames() const
+{
+    for (size_t i = 0; i < m_frameBufferCache.size(); ++i) {
+        if (m_frameBufferCache[i].status() != ImageFrame::FrameEmpty)
+            return true;
+    }
+    return false;
+}
+
+int ImageDecoder::maxNumPixelsForDecode() const
+{
+    if (m_desiredSize.isEmpty())
+        return m_maxNumPixels;
+
+    int desiredNumPixels = m_desiredSize.width() * m_desiredSize.height();
+    return m_maxNumPixels > 0 ? std::min(m_maxNumPixels, desiredNumPixels) : desiredNumPixels;
+}
+
 void ImageDecoder::prepareScaleDataIfNecessary()
+{
+    prepareScaleData(size());
+}
+
+void ImageDecoder::prepareScaleData(const IntSize& sourceSize)
 {
     m_scaled = false;
     m_scaledColumns.clear();
     m_scaledRows.clear();
 
-    int width = size().width();
-    int height = size().height();
+    // |sourceSize| differs from size() when the decoding library has already
+    // downscaled; the tables must then describe its output even if no
+    // further scaling is needed, so that scaledSize() is right.
+    bool sourceIsDownscaled = sourceSize != size();
+    int width = sourceSize.width();
+    int height = sourceSize.height();
     int numPixels = height * width;
-    if (m_maxNumPixels <= 0 || numPixels <= m_maxNumPixels)
+    int maxNumPixels = maxNumPixelsForDecode();
+    bool needsScaling = maxNumPixels > 0 && numPixels > maxNumPixels;
+    if (!needsScaling && !sourceIsDownscaled)
         return;
 
     m_scaled = true;
-    double scale = sqrt(m_maxNumPixels / (double)numPixels);
+    double scale = needsScaling ? sqrt(maxNumPixels / (double)numPixels) : 1;
     fillScaledValues(m_scaledColumns, scale, width);
     fillScaledValues(m_scaledRows, scale, height);
 }
@@ -317,15 +317,32 @@ namespace WebCore {
 
         // Clears decoded pixel data from before the provided frame unless that
         // data may be needed to decode future frames (e.g. due to GIF frame
-        // compositing).
+        // compositing).  Decoders that canRedecodeClearedFrames() may instead
+        // clear any frame but the provided one.
         virtual void clearFrameBufferCache(size_t) { }
 
+        // Whether frames dropped by clearFrameBufferCache() are decoded again
+        // on demand by frameBufferAtIndex(), so callers may ask for earlier
+        // frames again without resetting the decoder.
+        virtual bool canRedecodeClearedFrames() const { return false; }
+
 #if ENABLE(IMAGE_DECODER_DOWN_SAMPLING)
         void setMaxNumPixels(int m) { m_maxNumPixels = m; }
 #endif
 
+        // Asks the decoder not to produce frames with more pixels than
+        // |desiredSize| covers, for images displayed smaller than their
+        // intrinsic size.  Frames that have already started decoding keep
+        // their resolution.  An empty size asks for full resolution.
+        void setDesiredSize(const IntSize&);
+
     protected:
-        void prepareScaleDataIfNecessary();
+        // Subclasses whose decoding library already downscales (e.g. JPEG DCT
+        // scaling) override this to build the tables over the library's output.
+        virtual void prepareScaleDataIfNecessary();
+        void prepareScaleData(const IntSize& sourceSize);
+        int maxNumPixelsForDecode() const;
+        bool hasStartedDecodingFrames() const;
         int upperBoundScaledX(int origX, int searchStart = 0);
         int lowerBoundScaledX(int origX, int searchStart = 0);
         int upperBoundScaledY(int origY, int searchStart = 0);
@@ -352,6 +369,7 @@ namespace WebCore {
         }
 
         IntSize m_size;
+        IntSize m_desiredSize;
         bool m_sizeAvailable;
         int m_maxNumPixels;
         bool m_isAllDataReceived;
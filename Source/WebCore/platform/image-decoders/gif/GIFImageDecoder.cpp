@@ -26,15 +26,21 @@
 #include "config.h"
 #include "GIFImageDecoder.h"
 #include "GIFImageReader.h"
+#include <wtf/CurrentTime.h>
 
 namespace WebCore {
 
+size_t GIFImageDecoder::s_frameCacheBudget = 2 * 1024 * 1024;
+GIFImageDecoder::RedecodeStatistics GIFImageDecoder::s_redecodeStatistics = { 0, 0, 0 };
+
 GIFImageDecoder::GIFImageDecoder(ImageSource::AlphaOption alphaOption,
                                  ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption)
     : ImageDecoder(alphaOption, gammaAndColorProfileOption)
     , m_alreadyScannedThisDataForFrameCount(true)
     , m_repetitionCount(cAnimationLoopOnce)
     , m_readOffset(0)
+    , m_decodeFromFrame(0)
+    , m_redecoding(false)
 {
 }
 
@@ -82,7 +88,16 @@ size_t GIFImageDecoder::frameCount()
         // all the data.  Note that this is no worse than what ImageIO does on
         // Mac right now (it also crawls all the data again).
         GIFImageReader reader(0);
-        reader.read((const unsigned char*)m_data->data(), m_data->size(), GIFFrameCountQuery, static_cast<unsigned>(-1));
+        const char* segment;
+        unsigned offset = 0;
+        while (unsigned segmentLength = m_data->getSomeData(segment, offset)) {
+            offset += segmentLength;
+            if (reader.read(reinterpret_cast<const unsigned char*>(segment), segmentLength, GIFFrameCountQuery, static_cast<unsigned>(-1)))
+                break;
+            // Later segments can't be parsed once the reader has hit corrupt data.
+            if (reader.failed())
+                break;
+        }
         m_alreadyScannedThisDataForFrameCount = true;
         m_frameBufferCache.resize(reader.images_count);
         for (int i = 0; i < reader.images_count; ++i)
@@ -124,8 +139,12 @@ ImageFrame* GIFImageDecoder::frameBufferAtIndex(size_t index)
         return 0;
 
     ImageFrame& frame = m_frameBufferCache[index];
-    if (frame.status() != ImageFrame::FrameComplete)
-        decode(index + 1, GIFFullQuery);
+    if (frame.status() != ImageFrame::FrameComplete) {
+        if (readerHasPassedFrame(index))
+            redecodeFrame(index);
+        else
+            decode(index + 1, GIFFullQuery);
+    }
     return &frame;
 }
 
@@ -135,59 +154,123 @@ bool GIFImageDecoder::setFailed()
     return ImageDecoder::setFailed();
 }
 
-void GIFImageDecoder::clearFrameBufferCache(size_t clearBeforeFrame)
+void GIFImageDecoder::clearFrameBufferCache(size_t currentFrame)
 {
     // In some cases, like if the decoder was destroyed while animating, we
     // can be asked to clear more frames than we currently have.
     if (m_frameBufferCache.isEmpty())
         return; // Nothing to do.
 
-    // The "-1" here is tricky.  It does not mean that |clearBeforeFrame| is the
-    // last frame we wish to preserve, but rather that we never want to clear
-    // the very last frame in the cache: it's empty (so clearing it is
-    // pointless), it's partial (so we don't want to clear it anyway), or the
-    // cache could be enlarged with a future setData() call and it could be
-    // needed to construct the next frame (see comments below).  Callers can
-    // always use ImageSource::clear(true, ...) to completely free the memory in
-    // this case.
-    clearBeforeFrame = std::min(clearBeforeFrame, m_frameBufferCache.size() - 1);
-    const Vector<ImageFrame>::iterator end(m_frameBufferCache.begin() + clearBeforeFrame);
-
-    // We need to preserve frames such that:
-    //   * We don't clear |end|
-    //   * We don't clear the frame we're currently decoding
-    //   * We don't clear any frame from which a future initFrameBuffer() call
-    //     will copy bitmap data
-    // All other frames can be cleared.  Because of the constraints on when
-    // ImageSource::clear() can be called (see ImageSource.h), we're guaranteed
-    // not to have non-empty frames after the frame we're currently decoding.
-    // So, scan backwards from |end| as follows:
-    //   * If the frame is empty, we're still past any frames we care about.
-    //   * If the frame is complete, but is DisposeOverwritePrevious, we'll
-    //     skip over it in future initFrameBuffer() calls.  We can clear it
-    //     unless it's |end|, and keep scanning.  For any other disposal method,
-    //     stop scanning, as we've found the frame initFrameBuffer() will need
-    //     next.
-    //   * If the frame is partial, we're decoding it, so don't clear it; if it
-    //     has a disposal method other than DisposeOverwritePrevious, stop
-    //     scanning, as we'll only need this frame when decoding the next one.
-    Vector<ImageFrame>::iterator i(end);
-    for (; (i != m_frameBufferCache.begin()) && ((i->status() == ImageFrame::FrameEmpty) || (i->disposalMethod() == ImageFrame::DisposeOverwritePrevious)); --i) {
-        if ((i->status() == ImageFrame::FrameComplete) && (i != end))
-            i->clearPixelData();
+    // Since we can decode any frame again on demand (see redecodeFrame()), the
+    // caller only holds on to |currentFrame|.  Beyond that we must keep:
+    //   * the frame the next frame is composited onto, so playing forward
+    //     never has to re-decode;
+    //   * partial frames, which we're still decoding;
+    //   * as many key frames as fit in the budget.  A key frame is one that a
+    //     later frame is composited onto; frames after a disposal boundary
+    //     (see frameIsIndependent()) start from scratch and need none.  Key
+    //     frames are spread evenly over the animation, so re-decoding any
+    //     frame only has to start from a nearby one.
+    currentFrame = std::min(currentFrame, m_frameBufferCache.size() - 1);
+    const size_t nextFrame = currentFrame + 1;
+    const size_t nextStartFrame = (nextFrame < m_frameBufferCache.size()) ? requiredPreviousFrame(nextFrame) : currentFrame;
+
+    const size_t frameBytes = static_cast<size_t>(scaledSize().width()) * scaledSize().height() * sizeof(ImageFrame::PixelData);
+    const size_t keyFramesInBudget = frameBytes ? s_frameCacheBudget / frameBytes : 0;
+    const size_t keyFrameInterval = keyFramesInBudget ? (m_frameBufferCache.size() + keyFramesInBudget - 1) / keyFramesInBudget : 0;
+    size_t keyFramesKept = 0;
+    size_t nextKeyFrame = 0;
+
+    for (size_t i = 0; i < m_frameBufferCache.size(); ++i) {
+        ImageFrame& frame = m_frameBufferCache[i];
+        if (frame.status() != ImageFrame::FrameComplete || i == currentFrame || i == nextStartFrame)
+            continue;
+
+        bool isKeyFrame = frame.disposalMethod() != ImageFrame::DisposeOverwritePrevious
+            && (i + 1 >= m_frameBufferCache.size() || !frameIsIndependent(i + 1));
+        if (isKeyFrame && keyFrameInterval && i >= nextKeyFrame && keyFramesKept < keyFramesInBudget) {
+            ++keyFramesKept;
+            nextKeyFrame = i + keyFrameInterval;
+            continue;
+        }
+
+        frame.clearPixelData();
     }
+}
+
+size_t GIFImageDecoder::requiredPreviousFrame(size_t frameIndex) const
+{
+    ASSERT(frameIndex);
+    size_t previousFrame = frameIndex - 1;
+    while (previousFrame && (m_frameBufferCache[previousFrame].disposalMethod() == ImageFrame::DisposeOverwritePrevious))
+        --previousFrame;
+    return previousFrame;
+}
+
+bool GIFImageDecoder::frameIsIndependent(size_t frameIndex) const
+{
+    if (!frameIndex)
+        return true;
 
-    // Now |i| holds the last frame we need to preserve; clear prior frames.
-    for (Vector<ImageFrame>::iterator j(m_frameBufferCache.begin()); j != i; ++j) {
-        ASSERT(j->status() != ImageFrame::FramePartial);
-        if (j->status() != ImageFrame::FrameEmpty)
-            j->clearPixelData();
+    size_t previousFrame = requiredPreviousFrame(frameIndex);
+    const ImageFrame& prevBuffer = m_frameBufferCache[previousFrame];
+    ImageFrame::FrameDisposalMethod prevMethod = prevBuffer.disposalMethod();
+    if ((prevMethod == ImageFrame::DisposeNotSpecified) || (prevMethod == ImageFrame::DisposeKeep))
+        return false;
+    return !previousFrame || prevBuffer.originalFrameRect().contains(IntRect(IntPoint(), scaledSize()));
+}
+
+bool GIFImageDecoder::readerHasPassedFrame(size_t frameIndex) const
+{
+    // gifComplete() deletes the reader once it has read everything.
+    if (!m_reader)
+        return m_readOffset > 0;
+    return frameIndex < m_reader->images_decoded;
+}
+
+void GIFImageDecoder::redecodeFrame(size_t frameIndex)
+{
+    // Walk back to the first frame we need to decode: one that can be decoded
+    // on its own, or whose starting frame we still have.
+    size_t startFrame = frameIndex;
+    while (!frameIsIndependent(startFrame)) {
+        size_t previousFrame = requiredPreviousFrame(startFrame);
+        if (m_frameBufferCache[previousFrame].status() == ImageFrame::FrameComplete)
+            break;
+        startFrame = previousFrame;
     }
+
+    // A partially decoded frame would be drawn over itself by the new reader;
+    // let it start again from a fresh buffer.
+    for (size_t i = startFrame; i < m_frameBufferCache.size(); ++i) {
+        if (m_frameBufferCache[i].status() == ImageFrame::FramePartial)
+            m_frameBufferCache[i].clearPixelData();
+    }
+
+    double startTime = currentTime();
+    ++s_redecodeStatistics.redecodes;
+
+    m_reader.set(new GIFImageReader(this));
+    m_readOffset = 0;
+    m_decodeFromFrame = startFrame;
+    m_redecoding = true;
+    decode(frameIndex + 1, GIFFullQuery);
+    m_redecoding = false;
+
+    s_redecodeStatistics.redecodeTime += currentTime() - startTime;
+}
+
+bool GIFImageDecoder::shouldDecodeFrame(unsigned frameIndex) const
+{
+    if (frameIndex < m_decodeFromFrame)
+        return false;
+    return (frameIndex >= m_frameBufferCache.size()) || (m_frameBufferCache[frameIndex].status() != ImageFrame::FrameComplete);
 }
 
 void GIFImageDecoder::decodingHalted(unsigned bytesLeft)
 {
-    m_readOffset = m_data->size() - bytesLeft;
+    // decode() has already advanced m_readOffset past the segment being read.
+    m_readOffset -= bytesLeft;
 }
 
 bool GIFImageDecoder::haveDecodedRow(unsigned frameIndex, unsigned char* rowBuffer, unsigned char* rowEnd, unsigned rowNumber, unsigned repeatCount, bool writeTransparentPixels)
@@ -262,6 +345,8 @@ bool GIFImageDecoder::frameComplete(unsigned frameIndex, unsigned frameDuration,
     buffer.setStatus(ImageFrame::FrameComplete);
     buffer.setDuration(frameDuration);
     buffer.setDisposalMethod(disposalMethod);
+    if (m_redecoding)
+        ++s_redecodeStatistics.framesRedecoded;
 
     if (!m_currentBufferSawAlpha) {
         // The whole frame was non-transparent, so it's possible that the entire
@@ -314,9 +399,21 @@ void GIFImageDecoder::decode(unsigned haltAtFrame, GIFQuery query)
     if (!m_reader)
         m_reader.set(new GIFImageReader(this));
 
-    // If we couldn't decode the image but we've received all the data, decoding
-    // has failed.
-    if (!m_reader->read((const unsigned char*)m_data->data() + m_readOffset, m_data->size() - m_readOffset, query, haltAtFrame) && isAllDataReceived())
+    // Feed the reader one contiguous segment at a time rather than flattening
+    // the SharedBuffer; the reader keeps partial blocks in its hold buffer.
+    const char* segment;
+    while (unsigned segmentLength = m_data->getSomeData(segment, m_readOffset)) {
+        m_readOffset += segmentLength;
+        if (m_reader->read(reinterpret_cast<const unsigned char*>(segment), segmentLength, query, haltAtFrame))
+            return;
+        // The reader may have failed, or completed and been cleared by gifComplete().
+        if (failed() || !m_reader)
+            return;
+    }
+
+    // If we've received all the data but couldn't decode even part of a frame,
+    // decoding has failed. A truncated image still shows the frames it has.
+    if (isAllDataReceived() && !m_reader->images_count)
         setFailed();
 }
 
@@ -358,10 +455,12 @@ bool GIFImageDecoder::initFrameBuffer(unsigned frameIndex)
             prevBuffer = &m_frameBufferCache[--frameIndex];
             prevMethod = prevBuffer->disposalMethod();
         }
-        ASSERT(prevBuffer->status() == ImageFrame::FrameComplete);
+        // The previous frame's pixels may have been dropped from the cache
+        // (see clearFrameBufferCache()) if this frame doesn't need them.
 
         if ((prevMethod == ImageFrame::DisposeNotSpecified) || (prevMethod == ImageFrame::DisposeKeep)) {
             // Preserve the last frame as the starting state for this frame.
+            ASSERT(prevBuffer->status() == ImageFrame::FrameComplete);
             if (!buffer->copyBitmapData(*prevBuffer))
                 return setFailed();
         } else {
@@ -376,6 +475,7 @@ bool GIFImageDecoder::initFrameBuffer(unsigned frameIndex)
                     return setFailed();
             } else {
               // Copy the whole previous buffer, then clear just its frame.
+              ASSERT(prevBuffer->status() == ImageFrame::FrameComplete);
               if (!buffer->copyBitmapData(*prevBuffer))
                   return setFailed();
               for (int y = prevRect.y(); y < prevRect.maxY(); ++y) {
@@ -53,9 +53,26 @@ namespace WebCore {
         // accessing deleted memory, especially when calling this from inside
         // GIFImageReader!
         virtual bool setFailed();
-        virtual void clearFrameBufferCache(size_t clearBeforeFrame);
+        virtual void clearFrameBufferCache(size_t currentFrame);
+        virtual bool canRedecodeClearedFrames() const { return true; }
+
+        // Bytes of decoded frames each animated GIF may keep, beyond the
+        // frames needed to show the current frame and decode the next, so
+        // that dropped frames can be decoded again from a nearby key frame
+        // rather than from the start of the image.
+        static size_t frameCacheBudget() { return s_frameCacheBudget; }
+        static void setFrameCacheBudget(size_t bytes) { s_frameCacheBudget = bytes; }
+
+        // Totals across all GIF decoders, for measuring what re-decoding costs.
+        struct RedecodeStatistics {
+            unsigned redecodes; // Times a dropped frame had to be decoded again.
+            unsigned framesRedecoded; // Frames decoded again, including those leading up to the requested one.
+            double redecodeTime; // Seconds spent decoding them.
+        };
+        static const RedecodeStatistics& redecodeStatistics() { return s_redecodeStatistics; }
 
         // Callbacks from the GIF reader.
+        bool shouldDecodeFrame(unsigned frameIndex) const;
         void decodingHalted(unsigned bytesLeft);
         bool haveDecodedRow(unsigned frameIndex, unsigned char* rowBuffer, unsigned char* rowEnd, unsigned rowNumber, unsigned repeatCount, bool writeTransparentPixels);
         bool frameComplete(unsigned frameIndex, unsigned frameDuration, ImageFrame::FrameDisposalMethod disposalMethod);
@@ -73,11 +90,31 @@ namespace WebCore {
         // failure, this will mark the image as failed.
         bool initFrameBuffer(unsigned frameIndex);
 
+        // The frame whose pixels are the starting state of |frameIndex|, the
+        // way initFrameBuffer() picks it.  |frameIndex| must not be 0.
+        size_t requiredPreviousFrame(size_t frameIndex) const;
+        // Whether |frameIndex| starts from a transparent image rather than
+        // from an earlier frame, so it can be decoded on its own.
+        bool frameIsIndependent(size_t frameIndex) const;
+
+        // Whether the reader has already read past |frameIndex| in the data.
+        bool readerHasPassedFrame(size_t frameIndex) const;
+        // Decodes a frame the reader has already read past by starting a new
+        // reader from the beginning of the data, only decompressing frames
+        // from the nearest frame we still have (or can do without) onwards.
+        void redecodeFrame(size_t frameIndex);
+
+        static size_t s_frameCacheBudget;
+        static RedecodeStatistics s_redecodeStatistics;
+
         bool m_alreadyScannedThisDataForFrameCount;
         bool m_currentBufferSawAlpha;
         mutable int m_repetitionCount;
         OwnPtr<GIFImageReader> m_reader;
         unsigned m_readOffset;
+        // Frames before this one are skipped by the current reader.
+        size_t m_decodeFromFrame;
+        bool m_redecoding;
     };
 
 } // namespace WebCore
@@ -293,7 +293,7 @@ bool GIFImageReader::do_lzw(const unsigned char *q)
         /* end-of-stream should only appear after all image data */
         if (!rows_remaining)
           return true;
-        return clientptr ? clientptr->setFailed() : false;
+        return setFailed();
       }
 
       if (oldcode == -1) {
@@ -311,13 +311,13 @@ bool GIFImageReader::do_lzw(const unsigned char *q)
         code = oldcode;
 
         if (stackp == stack + MAX_BITS)
-          return clientptr ? clientptr->setFailed() : false;
+          return setFailed();
       }
 
       while (code >= clear_code)
       {
         if (code >= MAX_BITS || code == prefix[code])
-          return clientptr ? clientptr->setFailed() : false;
+          return setFailed();
 
         // Even though suffix[] only holds characters through suffix[avail - 1],
         // allowing code >= avail here lets us be more tolerant of malformed
@@ -327,7 +327,7 @@ bool GIFImageReader::do_lzw(const unsigned char *q)
         code = prefix[code];
 
         if (stackp == stack + MAX_BITS)
-          return clientptr ? clientptr->setFailed() : false;
+          return setFailed();
       }
 
       *stackp++ = firstchar = suffix[code];
@@ -378,6 +378,14 @@ bool GIFImageReader::do_lzw(const unsigned char *q)
 }
 
 
+// Marks the stream as corrupt before telling the client, which may delete
+// this reader; frame count scans have no client and check failed() instead.
+bool GIFImageReader::setFailed()
+{
+  state = gif_error;
+  return clientptr ? clientptr->setFailed() : false;
+}
+
 /******************************************************************************/
 /*
  * process data arriving from the stream for the gif decoder
@@ -386,6 +394,9 @@ bool GIFImageReader::do_lzw(const unsigned char *q)
 bool GIFImageReader::read(const unsigned char *buf, unsigned len, 
                      GIFImageDecoder::GIFQuery query, unsigned haltAtFrame)
 {
+  if (state == gif_error)
+    return false;
+
   if (!len) {
     // No new data has come in since the last call, just ignore this call.
     return true;
@@ -443,7 +454,7 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
     switch (state)
     {
     case gif_lzw:
-      if (!do_lzw(q))
+      if (!skip_current_frame && !do_lzw(q))
         return false; // If do_lzw() encountered an error, it has already called
                       // clientptr->setFailed().
       GETN(1, gif_sub_block);
@@ -457,10 +468,10 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
       // that our datasize is strictly less than the MAX_LZW_BITS value (12).
       // This sets the largest possible codemask correctly at 4095.
       if (datasize >= MAX_LZW_BITS)
-        return clientptr ? clientptr->setFailed() : false;
+        return setFailed();
       int clear_code = 1 << datasize;
       if (clear_code >= MAX_BITS)
-        return clientptr ? clientptr->setFailed() : false;
+        return setFailed();
 
       if (frame_reader) {
         frame_reader->datasize = datasize;
@@ -497,7 +508,7 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
       else if (!strncmp((char*)q, "GIF87a", 6))
         version = 87;
       else
-        return clientptr ? clientptr->setFailed() : false;
+        return setFailed();
       GETN(7, gif_global_header);
     }
     break;
@@ -573,7 +584,7 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
        * until we find an image separator, but GIF89a says such
        * a file is corrupt. We follow GIF89a and bail out. */
       if (*q != ',')
-        return clientptr ? clientptr->setFailed() : false;
+        return setFailed();
 
       GETN(9, gif_image_header);
     }
@@ -703,7 +714,7 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
         GETN(1, gif_netscape_extension_block);
       } else {
         // 0,3-7 are yet to be defined netscape extension codes
-        return clientptr ? clientptr->setFailed() : false;
+        return setFailed();
       }
 
       break;
@@ -745,7 +756,7 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
         height = screen_height;
         width = screen_width;
         if (!height || !width)
-          return clientptr ? clientptr->setFailed() : false;
+          return setFailed();
       }
 
       if (query == GIFImageDecoder::GIFSizeQuery || haltAtFrame == images_decoded) {
@@ -759,6 +770,10 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
       
       images_count = images_decoded + 1;
 
+      // CALLBACK: Frames the decoder still has, or doesn't need, are parsed
+      // but not decompressed.
+      skip_current_frame = clientptr && !clientptr->shouldDecodeFrame(images_decoded);
+
       if (query == GIFImageDecoder::GIFFullQuery && !frame_reader)
         frame_reader = new GIFFrameReader();
 
@@ -782,7 +797,7 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
         }
 
         if (!frame_reader->rowbuf)
-          return clientptr ? clientptr->setFailed() : false;
+          return setFailed();
         if (screen_height < height)
           screen_height = height;
 
@@ -824,7 +839,7 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
           delete []map;
           map = new unsigned char[size];
           if (!map)
-            return clientptr ? clientptr->setFailed() : false;
+            return setFailed();
         }
 
         /* Switch to the new local palette after it loads */
@@ -876,7 +891,7 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
         images_decoded++;
 
         // CALLBACK: The frame is now complete.
-        if (clientptr && frame_reader && !clientptr->frameComplete(images_decoded - 1, frame_reader->delay_time, frame_reader->disposal_method))
+        if (clientptr && frame_reader && !skip_current_frame && !clientptr->frameComplete(images_decoded - 1, frame_reader->delay_time, frame_reader->disposal_method))
           return false; // frameComplete() has already called
                         // clientptr->setFailed().
 
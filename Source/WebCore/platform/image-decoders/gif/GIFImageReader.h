@@ -73,7 +73,8 @@ typedef enum {
     gif_application_extension,
     gif_netscape_extension_block,
     gif_consume_netscape_extension,
-    gif_consume_comment
+    gif_consume_comment,
+    gif_error
 } gstate;
 
 struct GIFFrameReader {
@@ -175,6 +176,7 @@ struct GIFImageReader {
     int count;                  /* Remaining # bytes in sub-block */
     
     GIFFrameReader* frame_reader;
+    bool skip_current_frame;    /* Parse the current frame without decompressing it */
 
     GIFImageReader(WebCore::GIFImageDecoder* client = 0) {
         clientptr = client;
@@ -189,6 +191,7 @@ struct GIFImageReader {
         global_colormap_size = images_decoded = images_count = 0;
         loop_count = cLoopCountNotSeen;
         count = 0;
+        skip_current_frame = false;
     }
 
     ~GIFImageReader() {
@@ -201,8 +204,11 @@ struct GIFImageReader {
     bool read(const unsigned char * buf, unsigned int numbytes, 
               WebCore::GIFImageDecoder::GIFQuery query = WebCore::GIFImageDecoder::GIFFullQuery, unsigned haltAtFrame = -1);
 
+    bool failed() const { return state == gif_error; }
+
 private:
     bool output_row();
+    bool setFailed();
     bool do_lzw(const unsigned char *q);
 };
 
@@ -40,6 +40,7 @@
 #include "config.h"
 #include "JPEGImageDecoder.h"
 #include <stdio.h>  // Needed by jpeglib.h for FILE.
+#include <wtf/MathExtras.h>
 
 #if OS(WINCE) || PLATFORM(BREWMP_SIMULATOR)
 // Remove warning: 'FAR' macro redefinition
@@ -115,8 +116,12 @@ class JPEGImageReader
 public:
     JPEGImageReader(JPEGImageDecoder* decoder)
         : m_decoder(decoder)
-        , m_bufferLength(0)
-        , m_bytesToSkip(0)
+        , m_data(0)
+        , m_nextReadPosition(0)
+        , m_restartPosition(0)
+        , m_lastSetByte(0)
+        , m_needsRestart(false)
+        , m_outputSizeChosen(false)
         , m_state(JPEG_HEADER)
         , m_samples(0)
     {
@@ -171,30 +176,67 @@ public:
 
     void skipBytes(long numBytes)
     {
-        decoder_source_mgr* src = (decoder_source_mgr*)m_info.src;
-        long bytesToSkip = std::min(numBytes, (long)src->pub.bytes_in_buffer);
-        src->pub.bytes_in_buffer -= (size_t)bytesToSkip;
-        src->pub.next_input_byte += bytesToSkip;
+        if (numBytes <= 0)
+            return;
+
+        size_t bytesToSkip = static_cast<size_t>(numBytes);
+        if (bytesToSkip < m_info.src->bytes_in_buffer) {
+            // The next byte needed is in the current segment.
+            m_info.src->bytes_in_buffer -= bytesToSkip;
+            m_info.src->next_input_byte += bytesToSkip;
+        } else {
+            // Skip past the current segment; fillBuffer() picks up from there, possibly once more data arrives.
+            m_nextReadPosition += bytesToSkip - m_info.src->bytes_in_buffer;
+            clearBuffer();
+        }
 
-        m_bytesToSkip = std::max(numBytes - bytesToSkip, static_cast<long>(0));
+        // libjpeg never backtracks over skipped data, so this is a valid restart position.
+        m_restartPosition = m_nextReadPosition - m_info.src->bytes_in_buffer;
+        m_lastSetByte = m_info.src->next_input_byte;
     }
 
-    bool decode(const SharedBuffer& data, bool onlySize)
+    // Hands libjpeg the next contiguous segment of the encoded data, so the
+    // SharedBuffer never has to be flattened. When libjpeg suspends for lack
+    // of data it expects to be fed again from the start of the marker or MCU
+    // it was working on, which may lie in an earlier segment; we remember
+    // that position in m_restartPosition.
+    bool fillBuffer()
     {
-        m_decodingSizeOnly = onlySize;
+        if (m_needsRestart) {
+            m_needsRestart = false;
+            m_nextReadPosition = m_restartPosition;
+        } else
+            updateRestartPosition();
+
+        const char* segment;
+        unsigned bytes = m_data->getSomeData(segment, m_nextReadPosition);
+        if (!bytes) {
+            // Resume from the restart position once more data is available.
+            m_needsRestart = true;
+            clearBuffer();
+            return false;
+        }
 
-        unsigned newByteCount = data.size() - m_bufferLength;
-        unsigned readOffset = m_bufferLength - m_info.src->bytes_in_buffer;
+        m_nextReadPosition += bytes;
+        m_info.src->bytes_in_buffer = bytes;
+        m_info.src->next_input_byte = reinterpret_cast<const JOCTET*>(segment);
+        m_lastSetByte = m_info.src->next_input_byte;
+        return true;
+    }
 
-        m_info.src->bytes_in_buffer += newByteCount;
-        m_info.src->next_input_byte = (JOCTET*)(data.data()) + readOffset;
+    bool decode(const SharedBuffer& data, bool onlySize)
+    {
+        m_decodingSizeOnly = onlySize;
 
-        // If we still have bytes to skip, try to skip those now.
-        if (m_bytesToSkip)
-            skipBytes(m_bytesToSkip);
+        // Segments may have been moved since the last call, so never keep pointers into
+        // them across calls: rewind to the first unread byte and refetch through fillBuffer().
+        m_data = &data;
+        if (!m_needsRestart) {
+            m_nextReadPosition -= m_info.src->bytes_in_buffer;
+            m_restartPosition = m_nextReadPosition;
+            clearBuffer();
+        }
 
-        m_bufferLength = data.size();
-        
         // We need to do the setjmp here. Otherwise bad things will happen
         if (setjmp(m_err.setjmp_buffer))
             return m_decoder->setFailed();
@@ -256,10 +298,7 @@ public:
                 m_decoder->setColorProfile(readColorProfile(info()));
 
             if (m_decodingSizeOnly) {
-                // We can stop here.  Reduce our buffer length and available
-                // data.
-                m_bufferLength -= m_info.src->bytes_in_buffer;
-                m_info.src->bytes_in_buffer = 0;
+                // We can stop here. The unread bytes are presented again by the next decode().
                 return true;
             }
         // FALL THROUGH
@@ -274,6 +313,18 @@ public:
             m_info.enable_2pass_quant = false;
             m_info.do_block_smoothing = true;
 
+            // Let libjpeg downscale in the DCT when the image is wanted
+            // smaller than its intrinsic size; that is far cheaper than
+            // decoding every pixel and dropping most of them.  This may only
+            // be set before jpeg_start_decompress() is first called.
+            if (!m_outputSizeChosen) {
+                m_info.scale_num = 1;
+                m_info.scale_denom = m_decoder->scaleDenominator();
+                jpeg_calc_output_dimensions(&m_info);
+                m_decoder->setOutputSize(m_info.output_width, m_info.output_height);
+                m_outputSizeChosen = true;
+            }
+
             // Start decompressor.
             if (!jpeg_start_decompress(&m_info))
                 return false; // I/O suspension.
@@ -359,9 +410,28 @@ public:
     JPEGImageDecoder* decoder() { return m_decoder; }
 
 private:
+    void clearBuffer()
+    {
+        m_info.src->bytes_in_buffer = 0;
+        m_info.src->next_input_byte = 0;
+        m_lastSetByte = 0;
+    }
+
+    void updateRestartPosition()
+    {
+        // libjpeg only moves next_input_byte when it has finished with a unit of
+        // data, so a change since we last set it marks a new restart position.
+        if (m_lastSetByte != m_info.src->next_input_byte)
+            m_restartPosition = m_nextReadPosition - m_info.src->bytes_in_buffer;
+    }
+
     JPEGImageDecoder* m_decoder;
-    unsigned m_bufferLength;
-    int m_bytesToSkip;
+    const SharedBuffer* m_data;
+    unsigned m_nextReadPosition;
+    unsigned m_restartPosition;
+    const JOCTET* m_lastSetByte;
+    bool m_needsRestart;
+    bool m_outputSizeChosen;
     bool m_decodingSizeOnly;
     bool m_initialized;
 
@@ -392,10 +462,9 @@ void skip_input_data(j_decompress_ptr jd, long num_bytes)
 
 boolean fill_input_buffer(j_decompress_ptr jd)
 {
-    // Our decode step always sets things up properly, so if this method is ever
-    // called, then we have hit the end of the buffer.  A return value of false
-    // indicates that we have no data to supply yet.
-    return false;
+    // A return value of false indicates that we have no data to supply yet.
+    decoder_source_mgr *src = (decoder_source_mgr *)jd->src;
+    return src->decoder->fillBuffer();
 }
 
 void term_source(j_decompress_ptr jd)
@@ -431,6 +500,32 @@ bool JPEGImageDecoder::setSize(unsigned width, unsigned height)
     return true;
 }
 
+unsigned JPEGImageDecoder::scaleDenominator() const
+{
+    int maxNumPixels = maxNumPixelsForDecode();
+    int numPixels = size().width() * size().height();
+    if (maxNumPixels <= 0 || numPixels <= maxNumPixels)
+        return 1;
+
+    double scale = sqrt(maxNumPixels / static_cast<double>(numPixels));
+    unsigned denominator = 1;
+    while (denominator < 8 && scale * denominator * 2 <= 1)
+        denominator *= 2;
+    return denominator;
+}
+
+void JPEGImageDecoder::setOutputSize(unsigned width, unsigned height)
+{
+    m_outputSize = IntSize(width, height);
+    prepareScaleDataIfNecessary();
+}
+
+void JPEGImageDecoder::prepareScaleDataIfNecessary()
+{
+    // Once libjpeg has been told to downscale, the tables index its output.
+    prepareScaleData(m_outputSize.isEmpty() ? size() : m_outputSize);
+}
+
 ImageFrame* JPEGImageDecoder::frameBufferAtIndex(size_t index)
 {
     if (index)
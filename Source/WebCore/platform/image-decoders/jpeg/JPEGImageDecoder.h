@@ -53,15 +53,24 @@ namespace WebCore {
         bool outputScanlines();
         void jpegComplete();
 
+        // Returns the libjpeg DCT scaling denominator (1, 2, 4 or 8) that gets
+        // closest to the desired size without going below it.
+        unsigned scaleDenominator() const;
+        // Called once libjpeg has computed its (possibly downscaled) output size.
+        void setOutputSize(unsigned width, unsigned height);
+
         void setColorProfile(const ColorProfile& colorProfile) { m_colorProfile = colorProfile; }
 
     private:
+        virtual void prepareScaleDataIfNecessary();
+
         // Decodes the image.  If |onlySize| is true, stops decoding after
         // calculating the image size.  If decoding fails but there is no more
         // data coming, sets the "decode failure" flag.
         void decode(bool onlySize);
 
         OwnPtr<JPEGImageReader> m_reader;
+        IntSize m_outputSize;
     };
 
 } // namespace WebCore
@@ -40,11 +40,14 @@ WEBPImageDecoder::WEBPImageDecoder(ImageSource::AlphaOption alphaOption,
     : ImageDecoder(alphaOption, gammaAndColorProfileOption)
     , m_decoder(0)
     , m_lastVisibleRow(0)
+    , m_consumedDataSize(0)
 {
 }
 
 WEBPImageDecoder::~WEBPImageDecoder()
 {
+    if (m_decoder)
+        WebPIDelete(m_decoder);
 }
 
 bool WEBPImageDecoder::isSizeAvailable()
@@ -86,9 +89,25 @@ bool WEBPImageDecoder::decode(bool onlySize)
     if (dataSize < sizeOfHeader)
         return true;
 
+    // Data arriving in small network chunks can leave the header split across
+    // segments; gather it into one buffer before parsing it.
     int width, height;
-    const uint8_t* dataBytes = reinterpret_cast<const uint8_t*>(m_data->data());
-    if (!WebPGetInfo(dataBytes, dataSize, &width, &height))
+    const char* header;
+    unsigned headerLength = m_data->getSomeData(header, 0);
+    char headerBuffer[sizeOfHeader];
+    if (headerLength < sizeOfHeader) {
+        headerLength = 0;
+        const char* segment;
+        while (headerLength < sizeOfHeader) {
+            unsigned segmentLength = m_data->getSomeData(segment, headerLength);
+            ASSERT(segmentLength);
+            segmentLength = std::min<unsigned>(segmentLength, sizeOfHeader - headerLength);
+            memcpy(headerBuffer + headerLength, segment, segmentLength);
+            headerLength += segmentLength;
+        }
+        header = headerBuffer;
+    }
+    if (!WebPGetInfo(reinterpret_cast<const uint8_t*>(header), headerLength, &width, &height))
         return setFailed();
     if (!ImageDecoder::isSizeAvailable() && !setSize(width, height))
         return setFailed();
@@ -111,24 +130,26 @@ bool WEBPImageDecoder::decode(bool onlySize)
         m_rgbOutput.resize(height * stride);
     }
     int newLastVisibleRow = 0; // Last completed row.
-    if (allDataReceived) {
-        if (!WebPDecodeRGBInto(dataBytes, dataSize, m_rgbOutput.data(), m_rgbOutput.size(), stride))
+    if (!m_decoder) {
+        m_decoder = WebPINewRGB(MODE_RGB, m_rgbOutput.data(), m_rgbOutput.size(), stride);
+        if (!m_decoder)
             return setFailed();
-        newLastVisibleRow = height;
-    } else {
-        if (!m_decoder) {
-            m_decoder = WebPINewRGB(MODE_RGB, m_rgbOutput.data(), m_rgbOutput.size(), stride);
-            if (!m_decoder)
-                return setFailed();
-        }
-        const VP8StatusCode status = WebPIUpdate(m_decoder, dataBytes, dataSize);
+    }
+    // Only hand libwebp the bytes that arrived since the last call, one
+    // contiguous segment at a time, so the SharedBuffer is never flattened.
+    const char* segment;
+    while (unsigned segmentLength = m_data->getSomeData(segment, m_consumedDataSize)) {
+        const VP8StatusCode status = WebPIAppend(m_decoder, reinterpret_cast<const uint8_t*>(segment), segmentLength);
         if (status != VP8_STATUS_OK && status != VP8_STATUS_SUSPENDED)
             return setFailed();
-        if (!WebPIDecGetRGB(m_decoder, &newLastVisibleRow, 0, 0, 0))
-            return setFailed();
-        ASSERT(newLastVisibleRow >= 0);
-        ASSERT(newLastVisibleRow <= height);
+        m_consumedDataSize += segmentLength;
     }
+    if (!WebPIDecGetRGB(m_decoder, &newLastVisibleRow, 0, 0, 0))
+        return setFailed();
+    ASSERT(newLastVisibleRow >= 0);
+    ASSERT(newLastVisibleRow <= height);
+    if (allDataReceived && newLastVisibleRow < height)
+        return setFailed();
     // FIXME: remove this data copy.
     for (int y = m_lastVisibleRow; y < newLastVisibleRow; ++y) {
         const uint8_t* const src = &m_rgbOutput[y * stride];
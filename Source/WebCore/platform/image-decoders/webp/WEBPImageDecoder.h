@@ -50,8 +50,9 @@ private:
     // Returns false in case of decoding failure.
     bool decode(bool onlySize);
 
-    WebPIDecoder* m_decoder; // This is only used when we want to decode() but not all data is available yet.
+    WebPIDecoder* m_decoder;
     int m_lastVisibleRow;
+    unsigned m_consumedDataSize; // Number of bytes of m_data already appended to m_decoder.
     Vector<uint8_t> m_rgbOutput;
 };
 
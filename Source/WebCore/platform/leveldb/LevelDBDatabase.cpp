@@ -33,9 +33,14 @@
 #include "LevelDBSlice.h"
 #include <leveldb/comparator.h>
 #include <leveldb/db.h>
+#include <leveldb/iterator.h>
 #include <leveldb/slice.h>
+#include <leveldb/write_batch.h>
+#include <map>
 #include <string>
 #include <wtf/PassOwnPtr.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/RefCounted.h>
 #include <wtf/text/CString.h>
 #include <wtf/text/WTFString.h>
 
@@ -87,8 +92,260 @@ private:
 };
 }
 
+// Iterators hold on to the buffer, so it stays alive until they are gone even
+// if the batch is committed or rolled back first.
+class LevelDBDatabase::WriteBuffer : public RefCounted<WriteBuffer> {
+public:
+    static PassRefPtr<WriteBuffer> create(const leveldb::Comparator* comparator)
+    {
+        return adoptRef(new WriteBuffer(comparator));
+    }
+
+    void put(const leveldb::Slice& key, const leveldb::Slice& value)
+    {
+        Write& write = m_writes[key.ToString()];
+        write.removed = false;
+        write.value.assign(value.data(), value.size());
+    }
+
+    void remove(const leveldb::Slice& key)
+    {
+        Write& write = m_writes[key.ToString()];
+        write.removed = true;
+        write.value.clear();
+    }
+
+    // Returns false if nothing was written to the key since the last flush.
+    bool get(const leveldb::Slice& key, bool& removed, std::string& value) const
+    {
+        WriteMap::const_iterator it = m_writes.find(key.ToString());
+        if (it == m_writes.end())
+            return false;
+        removed = it->second.removed;
+        value = it->second.value;
+        return true;
+    }
+
+    bool isEmpty() const { return m_writes.empty(); }
+
+    void fill(leveldb::WriteBatch& batch) const
+    {
+        for (WriteMap::const_iterator it = m_writes.begin(); it != m_writes.end(); ++it) {
+            if (it->second.removed)
+                batch.Delete(it->first);
+            else
+                batch.Put(it->first, it->second.value);
+        }
+    }
+
+    const leveldb::Comparator* comparator() const { return m_writes.key_comp().m_comparator; }
+
+    struct Write {
+        Write() : removed(false) { }
+        bool removed;
+        std::string value;
+    };
+
+    // Keys that the database considers equal must share an entry, so they are
+    // ordered with its comparator rather than byte by byte.
+    struct KeyLess {
+        explicit KeyLess(const leveldb::Comparator* comparator) : m_comparator(comparator) { }
+        bool operator()(const std::string& a, const std::string& b) const { return m_comparator->Compare(a, b) < 0; }
+        const leveldb::Comparator* m_comparator;
+    };
+
+    // Entries are never erased from the map, only marked as removed, so that
+    // a WriteBufferIterator's position stays valid while writes are buffered.
+    typedef std::map<std::string, Write, KeyLess> WriteMap;
+    const WriteMap& writes() const { return m_writes; }
+
+private:
+    explicit WriteBuffer(const leveldb::Comparator* comparator)
+        : m_writes(KeyLess(comparator))
+    {
+    }
+
+    WriteMap m_writes;
+};
+
+// Iterates over the database with the buffered writes applied: a buffered
+// write replaces the database's entry for its key, and a buffered remove
+// hides it.
+class LevelDBDatabase::WriteBufferIterator : public leveldb::Iterator {
+public:
+    WriteBufferIterator(PassRefPtr<WriteBuffer> writeBuffer, leveldb::Iterator* databaseIterator)
+        : m_writeBuffer(writeBuffer)
+        , m_databaseIterator(databaseIterator)
+        , m_bufferIterator(m_writeBuffer->writes().end())
+        , m_current(None)
+        , m_direction(Forward)
+    {
+    }
+
+    virtual bool Valid() const { return m_current != None; }
+
+    virtual void SeekToFirst()
+    {
+        m_databaseIterator->SeekToFirst();
+        m_bufferIterator = writes().begin();
+        m_direction = Forward;
+        findNextEntry();
+    }
+
+    virtual void SeekToLast()
+    {
+        m_databaseIterator->SeekToLast();
+        m_bufferIterator = writes().end();
+        if (!writes().empty())
+            --m_bufferIterator;
+        m_direction = Reverse;
+        findPreviousEntry();
+    }
+
+    virtual void Seek(const leveldb::Slice& target)
+    {
+        m_databaseIterator->Seek(target);
+        m_bufferIterator = writes().lower_bound(target.ToString());
+        m_direction = Forward;
+        findNextEntry();
+    }
+
+    virtual void Next()
+    {
+        ASSERT(Valid());
+        if (m_direction == Reverse) {
+            // Move both iterators to the first entry after the current key.
+            std::string key = this->key().ToString();
+            m_databaseIterator->Seek(key);
+            if (m_databaseIterator->Valid() && !compare(m_databaseIterator->key(), key))
+                m_databaseIterator->Next();
+            m_bufferIterator = writes().upper_bound(key);
+            m_direction = Forward;
+        } else if (m_current == Database)
+            m_databaseIterator->Next();
+        else
+            ++m_bufferIterator;
+        findNextEntry();
+    }
+
+    virtual void Prev()
+    {
+        ASSERT(Valid());
+        if (m_direction == Forward) {
+            // Move both iterators to the last entry before the current key.
+            std::string key = this->key().ToString();
+            m_databaseIterator->Seek(key);
+            if (m_databaseIterator->Valid())
+                m_databaseIterator->Prev();
+            else
+                m_databaseIterator->SeekToLast();
+            m_bufferIterator = writes().lower_bound(key);
+            stepBufferBackward();
+            m_direction = Reverse;
+        } else if (m_current == Database)
+            m_databaseIterator->Prev();
+        else
+            stepBufferBackward();
+        findPreviousEntry();
+    }
+
+    virtual leveldb::Slice key() const
+    {
+        ASSERT(Valid());
+        if (m_current == Database)
+            return m_databaseIterator->key();
+        return m_bufferIterator->first;
+    }
+
+    virtual leveldb::Slice value() const
+    {
+        ASSERT(Valid());
+        if (m_current == Database)
+            return m_databaseIterator->value();
+        return m_bufferIterator->second.value;
+    }
+
+    virtual leveldb::Status status() const { return m_databaseIterator->status(); }
+
+private:
+    enum Current { None, Database, Buffer };
+    enum Direction { Forward, Reverse };
+
+    const WriteBuffer::WriteMap& writes() const { return m_writeBuffer->writes(); }
+    bool bufferIsValid() const { return m_bufferIterator != writes().end(); }
+    int compare(const leveldb::Slice& a, const leveldb::Slice& b) const { return m_writeBuffer->comparator()->Compare(a, b); }
+
+    // The end of the map marks a buffer iterator that has run off either end.
+    void stepBufferBackward()
+    {
+        if (m_bufferIterator == writes().begin())
+            m_bufferIterator = writes().end();
+        else
+            --m_bufferIterator;
+    }
+
+    // Both iterators are at or after the position to return; pick the
+    // smaller key, skipping database entries the buffer replaces.
+    void findNextEntry()
+    {
+        while (true) {
+            bool databaseIsValid = m_databaseIterator->Valid();
+            if (!databaseIsValid && !bufferIsValid()) {
+                m_current = None;
+                return;
+            }
+
+            int result = !bufferIsValid() ? -1 : !databaseIsValid ? 1 : compare(m_databaseIterator->key(), m_bufferIterator->first);
+            if (result < 0) {
+                m_current = Database;
+                return;
+            }
+            if (!result)
+                m_databaseIterator->Next();
+            if (!m_bufferIterator->second.removed) {
+                m_current = Buffer;
+                return;
+            }
+            ++m_bufferIterator;
+        }
+    }
+
+    // As findNextEntry(), but both iterators are at or before the position to
+    // return, and the larger key wins.
+    void findPreviousEntry()
+    {
+        while (true) {
+            bool databaseIsValid = m_databaseIterator->Valid();
+            if (!databaseIsValid && !bufferIsValid()) {
+                m_current = None;
+                return;
+            }
+
+            int result = !bufferIsValid() ? 1 : !databaseIsValid ? -1 : compare(m_databaseIterator->key(), m_bufferIterator->first);
+            if (result > 0) {
+                m_current = Database;
+                return;
+            }
+            if (!result)
+                m_databaseIterator->Prev();
+            if (!m_bufferIterator->second.removed) {
+                m_current = Buffer;
+                return;
+            }
+            stepBufferBackward();
+        }
+    }
+
+    RefPtr<WriteBuffer> m_writeBuffer;
+    OwnPtr<leveldb::Iterator> m_databaseIterator;
+    WriteBuffer::WriteMap::const_iterator m_bufferIterator;
+    Current m_current;
+    Direction m_direction;
+};
+
 LevelDBDatabase::LevelDBDatabase()
     : m_db(0)
+    , m_modificationCount(0)
 {
 }
 
@@ -119,9 +376,20 @@ LevelDBDatabase* LevelDBDatabase::open(const String& fileName, const LevelDBComp
     return result;
 }
 
+bool LevelDBDatabase::destroy(const String& fileName)
+{
+    // DestroyDB fails without deleting anything if another process holds the database open.
+    return leveldb::DestroyDB(fileName.utf8().data(), leveldb::Options()).ok();
+}
 
 bool LevelDBDatabase::put(const LevelDBSlice& key, const Vector<char>& value)
 {
+    ++m_modificationCount;
+    if (m_writeBuffer) {
+        m_writeBuffer->put(makeSlice(key), makeSlice(value));
+        return true;
+    }
+
     leveldb::WriteOptions writeOptions;
     writeOptions.sync = false;
 
@@ -130,6 +398,12 @@ bool LevelDBDatabase::put(const LevelDBSlice& key, const Vector<char>& value)
 
 bool LevelDBDatabase::remove(const LevelDBSlice& key)
 {
+    ++m_modificationCount;
+    if (m_writeBuffer) {
+        m_writeBuffer->remove(makeSlice(key));
+        return true;
+    }
+
     leveldb::WriteOptions writeOptions;
     writeOptions.sync = false;
 
@@ -139,6 +413,14 @@ bool LevelDBDatabase::remove(const LevelDBSlice& key)
 bool LevelDBDatabase::get(const LevelDBSlice& key, Vector<char>& value)
 {
     std::string result;
+    bool removed;
+    if (m_writeBuffer && m_writeBuffer->get(makeSlice(key), removed, result)) {
+        if (removed)
+            return false;
+        value = makeVector(result);
+        return true;
+    }
+
     if (!m_db->Get(leveldb::ReadOptions(), makeSlice(key), &result).ok())
         return false;
 
@@ -151,9 +433,46 @@ LevelDBIterator* LevelDBDatabase::newIterator()
     leveldb::Iterator* i = m_db->NewIterator(leveldb::ReadOptions());
     if (!i) // FIXME: Double check if we actually need to check this.
         return 0;
+    if (m_writeBuffer && !m_writeBuffer->isEmpty())
+        return new LevelDBIterator(new WriteBufferIterator(m_writeBuffer, i));
     return new LevelDBIterator(i);
 }
 
+void LevelDBDatabase::beginWriteBatch()
+{
+    ASSERT(!m_writeBuffer);
+    m_writeBuffer = WriteBuffer::create(m_comparatorAdapter.get());
+}
+
+bool LevelDBDatabase::commitWriteBatch()
+{
+    if (!m_writeBuffer)
+        return true;
+
+    RefPtr<WriteBuffer> writeBuffer = m_writeBuffer.release();
+    if (writeBuffer->isEmpty())
+        return true;
+
+    leveldb::WriteBatch batch;
+    writeBuffer->fill(batch);
+
+    leveldb::WriteOptions writeOptions;
+    writeOptions.sync = false;
+
+    return m_db->Write(writeOptions, &batch).ok();
+}
+
+void LevelDBDatabase::rollbackWriteBatch()
+{
+    if (!m_writeBuffer)
+        return;
+
+    // Reads may have seen the discarded writes.
+    if (!m_writeBuffer->isEmpty())
+        ++m_modificationCount;
+    m_writeBuffer = 0;
+}
+
 } // namespace WebCore
 
 #endif // ENABLE(LEVELDB)
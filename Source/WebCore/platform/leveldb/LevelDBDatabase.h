@@ -30,6 +30,7 @@
 
 #include "PlatformString.h"
 #include <OwnPtr.h>
+#include <RefPtr.h>
 #include <Vector.h>
 
 namespace leveldb {
@@ -46,6 +47,7 @@ class LevelDBSlice;
 class LevelDBDatabase {
 public:
     static LevelDBDatabase* open(const String& fileName, const LevelDBComparator*);
+    static bool destroy(const String& fileName);
     ~LevelDBDatabase();
 
     bool put(const LevelDBSlice& key, const Vector<char>& value);
@@ -53,11 +55,32 @@ public:
     bool get(const LevelDBSlice& key, Vector<char>& value);
     LevelDBIterator* newIterator();
 
+    // Between beginWriteBatch() and commitWriteBatch(), put() and remove() are
+    // buffered, and then applied atomically as one leveldb::WriteBatch. Later
+    // writes to the same key replace earlier ones in the buffer. get() and
+    // iterators see the buffered writes merged over the database. An iterator
+    // may or may not see writes made after it was created, and the slices it
+    // returns don't outlive the next write, so reopen it when
+    // modificationCount() changes.
+    void beginWriteBatch();
+    bool commitWriteBatch();
+    void rollbackWriteBatch();
+    bool isInWriteBatch() const { return !!m_writeBuffer; }
+
+    // Changes with every write, so that a reader can tell when an iterator is
+    // out of date.
+    unsigned long long modificationCount() const { return m_modificationCount; }
+
 private:
     LevelDBDatabase();
 
+    class WriteBuffer;
+    class WriteBufferIterator;
+
     OwnPtr<leveldb::DB> m_db;
     OwnPtr<leveldb::Comparator> m_comparatorAdapter;
+    RefPtr<WriteBuffer> m_writeBuffer;
+    unsigned long long m_modificationCount;
 };
 
 } // namespace WebCore
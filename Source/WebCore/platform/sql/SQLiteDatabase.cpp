@@ -54,6 +54,7 @@ SQLiteDatabase::SQLiteDatabase()
     , m_sharable(false)
     , m_openingThread(0)
     , m_interrupted(false)
+    , m_statementCacheCapacity(0)
 {
 }
 
@@ -94,6 +95,7 @@ void SQLiteDatabase::close()
     if (m_db) {
         // FIXME: This is being called on themain thread during JS GC. <rdar://problem/5739818>
         // ASSERT(currentThread() == m_openingThread);
+        clearStatementCache();
         sqlite3* db = m_db;
         {
             MutexLocker locker(m_databaseClosingMutex);
@@ -229,6 +231,69 @@ void SQLiteDatabase::setSynchronous(SynchronousPragma sync)
     executeCommand(makeString("PRAGMA synchronous = ", String::number(sync)));
 }
 
+bool SQLiteDatabase::enableWriteAheadLogging()
+{
+#if SQLITE_VERSION_NUMBER >= 3007000
+    SQLiteStatement statement(*this, "PRAGMA journal_mode = WAL");
+    return equalIgnoringCase(statement.getColumnText(0), "wal");
+#else
+    return false;
+#endif
+}
+
+void SQLiteDatabase::setStatementCacheCapacity(unsigned capacity)
+{
+    ASSERT(!capacity || !m_authorizer);
+    m_statementCacheCapacity = capacity;
+    trimStatementCache();
+}
+
+sqlite3_stmt* SQLiteDatabase::takeCachedStatement(const String& query)
+{
+    if (m_statementCache.isEmpty())
+        return 0;
+
+    HashMap<String, sqlite3_stmt*>::iterator it = m_statementCache.find(query);
+    if (it == m_statementCache.end())
+        return 0;
+
+    sqlite3_stmt* statement = it->second;
+    m_statementCache.remove(it);
+    m_statementCacheOrder.remove(query);
+    return statement;
+}
+
+void SQLiteDatabase::cacheStatement(const String& query, sqlite3_stmt* statement)
+{
+    ASSERT(cachesStatements());
+
+    // Another statement with the same SQL may have been finalized first.
+    if (!m_statementCache.add(query, statement).second) {
+        sqlite3_finalize(statement);
+        return;
+    }
+
+    m_statementCacheOrder.add(query);
+    trimStatementCache();
+}
+
+void SQLiteDatabase::trimStatementCache()
+{
+    while (m_statementCacheOrder.size() > m_statementCacheCapacity) {
+        sqlite3_finalize(m_statementCache.take(m_statementCacheOrder.first()));
+        m_statementCacheOrder.remove(m_statementCacheOrder.begin());
+    }
+}
+
+void SQLiteDatabase::clearStatementCache()
+{
+    HashMap<String, sqlite3_stmt*>::iterator end = m_statementCache.end();
+    for (HashMap<String, sqlite3_stmt*>::iterator it = m_statementCache.begin(); it != end; ++it)
+        sqlite3_finalize(it->second);
+    m_statementCache.clear();
+    m_statementCacheOrder.clear();
+}
+
 void SQLiteDatabase::setBusyTimeout(int ms)
 {
     if (m_db)
@@ -421,6 +486,9 @@ void SQLiteDatabase::setAuthorizer(PassRefPtr<DatabaseAuthorizer> auth)
         return;
     }
 
+    // Cached statements would skip the authorizer.
+    ASSERT(!cachesStatements());
+
     MutexLocker locker(m_authorizerLock);
 
     m_authorizer = auth;
@@ -28,13 +28,17 @@
 #define SQLiteDatabase_h
 
 #include "PlatformString.h"
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
 #include <wtf/Threading.h>
+#include <wtf/text/StringHash.h>
 
 #if COMPILER(MSVC)
 #pragma warning(disable: 4800)
 #endif
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace WebCore {
 
@@ -52,6 +56,7 @@ extern const int SQLResultInterrupt;
 
 class SQLiteDatabase {
     WTF_MAKE_NONCOPYABLE(SQLiteDatabase);
+    friend class SQLiteStatement;
     friend class SQLiteTransaction;
 public:
     SQLiteDatabase();
@@ -98,6 +103,18 @@ public:
     // OFF - Calls return immediately after the data has been passed to disk
     enum SynchronousPragma { SyncOff = 0, SyncNormal = 1, SyncFull = 2 };
     void setSynchronous(SynchronousPragma);
+
+    // Switches the database to a write-ahead log, so that a commit appends to
+    // the log instead of rewriting pages through a rollback journal. Returns
+    // false if the database stays in its current journal mode.
+    bool enableWriteAheadLogging();
+
+    // Keeps up to the given number of statements prepared after they are
+    // finalized, keyed by their SQL, so running the same SQL again skips
+    // compiling it. The least recently used statement is dropped first.
+    // Statements are authorized when compiled, so only databases without an
+    // authorizer should use this.
+    void setStatementCacheCapacity(unsigned);
     
     int lastError();
     const char* lastErrorMsg();
@@ -138,6 +155,12 @@ private:
     void enableAuthorizer(bool enable);
     
     int pageSize();
+
+    bool cachesStatements() const { return m_statementCacheCapacity; }
+    sqlite3_stmt* takeCachedStatement(const String& query);
+    void cacheStatement(const String& query, sqlite3_stmt*);
+    void trimStatementCache();
+    void clearStatementCache();
     
     sqlite3* m_db;
     int m_pageSize;
@@ -153,6 +176,10 @@ private:
 
     Mutex m_databaseClosingMutex;
     bool m_interrupted;
+
+    HashMap<String, sqlite3_stmt*> m_statementCache;
+    ListHashSet<String> m_statementCacheOrder;
+    unsigned m_statementCacheCapacity;
 }; // class SQLiteDatabase
 
 } // namespace WebCore
@@ -115,6 +115,9 @@ bool SQLiteFileSystem::deleteEmptyDatabaseDirectory(const String& path)
 
 bool SQLiteFileSystem::deleteDatabaseFile(const String& fileName)
 {
+    // A database that used a write-ahead log may have left it behind.
+    deleteFile(fileName + "-wal");
+    deleteFile(fileName + "-shm");
     return deleteFile(fileName);
 }
 
@@ -46,10 +46,12 @@ static inline int sqlite3_prepare16_v2(sqlite3* db, const void* zSql, int nBytes
 
 #endif
 
-SQLiteStatement::SQLiteStatement(SQLiteDatabase& db, const String& sql)
+SQLiteStatement::SQLiteStatement(SQLiteDatabase& db, const String& sql, CachePolicy cachePolicy)
     : m_database(db)
     , m_query(sql)
     , m_statement(0)
+    , m_cachePolicy(cachePolicy)
+    , m_canBeCached(false)
 #ifndef NDEBUG
     , m_isPrepared(false)
 #endif
@@ -69,6 +71,18 @@ int SQLiteStatement::prepare()
     if (m_database.isInterrupted())
         return SQLITE_INTERRUPT;
 
+    if (m_cachePolicy == MayBeCached && m_database.cachesStatements()) {
+        m_statement = m_database.takeCachedStatement(m_query);
+        if (m_statement) {
+            LOG(SQLDatabase, "SQL - prepare (cached) - %s", m_query.ascii().data());
+            m_canBeCached = true;
+#ifndef NDEBUG
+            m_isPrepared = true;
+#endif
+            return SQLITE_OK;
+        }
+    }
+
     const void* tail = 0;
     LOG(SQLDatabase, "SQL - prepare - %s", m_query.ascii().data());
     String strippedQuery = m_query.stripWhiteSpace();
@@ -87,6 +101,7 @@ int SQLiteStatement::prepare()
     const UChar* ch = static_cast<const UChar*>(tail);
     if (ch && *ch)
         error = SQLITE_ERROR;
+    m_canBeCached = error == SQLITE_OK && m_cachePolicy == MayBeCached;
 #ifndef NDEBUG
     m_isPrepared = error == SQLITE_OK;
 #endif
@@ -120,9 +135,19 @@ int SQLiteStatement::finalize()
 #endif
     if (!m_statement)
         return SQLITE_OK;
-    LOG(SQLDatabase, "SQL - finalize - %s", m_query.ascii().data());
-    int result = sqlite3_finalize(m_statement);
+
+    int result;
+    if (m_canBeCached && m_database.cachesStatements() && m_database.isOpen()) {
+        LOG(SQLDatabase, "SQL - finalize (cached) - %s", m_query.ascii().data());
+        result = sqlite3_reset(m_statement);
+        sqlite3_clear_bindings(m_statement);
+        m_database.cacheStatement(m_query, m_statement);
+    } else {
+        LOG(SQLDatabase, "SQL - finalize - %s", m_query.ascii().data());
+        result = sqlite3_finalize(m_statement);
+    }
     m_statement = 0;
+    m_canBeCached = false;
     return result;
 }
 
@@ -37,7 +37,10 @@ class SQLValue;
 class SQLiteStatement {
     WTF_MAKE_NONCOPYABLE(SQLiteStatement); WTF_MAKE_FAST_ALLOCATED;
 public:
-    SQLiteStatement(SQLiteDatabase&, const String&);
+    // Statements are kept compiled in the database's statement cache, if it has
+    // one, unless the query is unlikely to be run again.
+    enum CachePolicy { MayBeCached, NeverCached };
+    SQLiteStatement(SQLiteDatabase&, const String&, CachePolicy = MayBeCached);
     ~SQLiteStatement();
     
     int prepare();
@@ -97,6 +100,8 @@ private:
     SQLiteDatabase& m_database;
     String m_query;
     sqlite3_stmt* m_statement;
+    CachePolicy m_cachePolicy;
+    bool m_canBeCached;
 #ifndef NDEBUG
     bool m_isPrepared;
 #endif
@@ -29,6 +29,7 @@
 #if ENABLE(DATABASE)
 
 #include "SQLiteDatabase.h"
+#include "SQLiteStatement.h"
 
 namespace WebCore {
 
@@ -102,5 +103,49 @@ bool SQLiteTransaction::wasRolledBackBySqlite() const
     return m_inProgress && m_db.isAutoCommitOn();
 }
 
+SQLiteWriteBatch::SQLiteWriteBatch(SQLiteDatabase& db)
+    : m_db(db)
+    , m_transaction(db)
+    , m_writeCount(0)
+    , m_failed(false)
+{
+}
+
+void SQLiteWriteBatch::beginIfNeeded()
+{
+    if (!m_writeCount++ && !m_db.transactionInProgress())
+        m_transaction.begin();
+}
+
+bool SQLiteWriteBatch::step(SQLiteStatement& statement)
+{
+    beginIfNeeded();
+    int result = statement.step();
+    statement.reset();
+    if (result == SQLResultDone)
+        return true;
+    m_failed = true;
+    return false;
+}
+
+bool SQLiteWriteBatch::executeCommand(const String& sql)
+{
+    beginIfNeeded();
+    if (m_db.executeCommand(sql))
+        return true;
+    m_failed = true;
+    return false;
+}
+
+bool SQLiteWriteBatch::commit()
+{
+    if (m_transaction.wasRolledBackBySqlite()) {
+        m_transaction.stop();
+        return false;
+    }
+    m_transaction.commit();
+    return !m_failed && !m_transaction.inProgress();
+}
+
 } // namespace WebCore
 #endif // ENABLE(DATABASE)
@@ -27,11 +27,13 @@
 #define SQLiteTransaction_h
 
 #include <wtf/FastAllocBase.h>
+#include <wtf/Forward.h>
 #include <wtf/Noncopyable.h>
 
 namespace WebCore {
 
 class SQLiteDatabase;
+class SQLiteStatement;
 
 class SQLiteTransaction {
     WTF_MAKE_NONCOPYABLE(SQLiteTransaction); WTF_MAKE_FAST_ALLOCATED;
@@ -52,6 +54,34 @@ private:
     bool m_readOnly;
 };
 
+// Runs a series of writes in one transaction, so that they reach the disk
+// with one sync instead of one per statement. The transaction begins with the
+// first write, or is left to the caller if one is already in progress.
+class SQLiteWriteBatch {
+    WTF_MAKE_NONCOPYABLE(SQLiteWriteBatch); WTF_MAKE_FAST_ALLOCATED;
+public:
+    SQLiteWriteBatch(SQLiteDatabase&);
+
+    // Steps a prepared statement that returns no rows, and resets it so that
+    // it can be bound for the next write.
+    bool step(SQLiteStatement&);
+    bool executeCommand(const String&);
+
+    // Commits the writes that succeeded. Returns false if any write failed or
+    // if the commit did. A batch destroyed before commit() is rolled back.
+    bool commit();
+
+    unsigned writeCount() const { return m_writeCount; }
+
+private:
+    void beginIfNeeded();
+
+    SQLiteDatabase& m_db;
+    SQLiteTransaction m_transaction;
+    unsigned m_writeCount;
+    bool m_failed;
+};
+
 } // namespace WebCore
 
 #endif // SQLiteTransation_H
@@ -28,6 +28,13 @@
 #define TextCodecASCIIFastPath_h
 
 #include <stdint.h>
+#include <wtf/UnusedParam.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif CPU(ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace WebCore {
 
@@ -91,6 +98,120 @@ template<typename T> inline T* alignToMachineWord(T* pointer)
     return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(pointer) & ~machineWordAlignmentMask);
 }
 
+// The vector fast paths below each handle whole 16-byte blocks for as long as
+// every block passes their check, and return the number of bytes (or, when
+// narrowing, code units) handled.  They return 0 where no vector instructions
+// are available, so callers always finish up with the scalar code.
+const size_t characterVectorSize = 16;
+
+#if CPU(ARM_NEON) && !defined(__SSE2__)
+inline bool isAnyByteSet(uint8x16_t vector)
+{
+    uint8x8_t folded = vorr_u8(vget_low_u8(vector), vget_high_u8(vector));
+    return vget_lane_u64(vreinterpret_u64_u8(folded), 0);
+}
+#endif
+
+// Widens bytes to UTF-16 while they are all ASCII.
+inline size_t copyASCIIVectors(UChar* destination, const uint8_t* source, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + characterVectorSize <= length; i += characterVectorSize) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        if (_mm_movemask_epi8(bytes))
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+#elif CPU(ARM_NEON)
+    const uint8x16_t nonASCIIMask = vdupq_n_u8(0x80);
+    for (; i + characterVectorSize <= length; i += characterVectorSize) {
+        uint8x16_t bytes = vld1q_u8(source + i);
+        if (isAnyByteSet(vandq_u8(bytes, nonASCIIMask)))
+            break;
+        uint16_t* output = reinterpret_cast<uint16_t*>(destination + i);
+        vst1q_u16(output, vmovl_u8(vget_low_u8(bytes)));
+        vst1q_u16(output + 8, vmovl_u8(vget_high_u8(bytes)));
+    }
+#else
+    UNUSED_PARAM(destination);
+    UNUSED_PARAM(source);
+    UNUSED_PARAM(length);
+#endif
+    return i;
+}
+
+// Widens bytes to UTF-16 while none of them is in the range 0x80-0x9F, the
+// only bytes that Windows Latin-1 does not map to the code point of the same
+// value.
+inline size_t copyLatin1Vectors(UChar* destination, const uint8_t* source, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i topBitsMask = _mm_set1_epi8(static_cast<char>(0xE0));
+    const __m128i c1ControlBits = _mm_set1_epi8(static_cast<char>(0x80));
+    for (; i + characterVectorSize <= length; i += characterVectorSize) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(bytes, topBitsMask), c1ControlBits)))
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+#elif CPU(ARM_NEON)
+    const uint8x16_t topBitsMask = vdupq_n_u8(0xE0);
+    const uint8x16_t c1ControlBits = vdupq_n_u8(0x80);
+    for (; i + characterVectorSize <= length; i += characterVectorSize) {
+        uint8x16_t bytes = vld1q_u8(source + i);
+        if (isAnyByteSet(vceqq_u8(vandq_u8(bytes, topBitsMask), c1ControlBits)))
+            break;
+        uint16_t* output = reinterpret_cast<uint16_t*>(destination + i);
+        vst1q_u16(output, vmovl_u8(vget_low_u8(bytes)));
+        vst1q_u16(output + 8, vmovl_u8(vget_high_u8(bytes)));
+    }
+#else
+    UNUSED_PARAM(destination);
+    UNUSED_PARAM(source);
+    UNUSED_PARAM(length);
+#endif
+    return i;
+}
+
+// Narrows UTF-16 code units to bytes while they are all ASCII.
+inline size_t copyASCIIVectorsToBytes(uint8_t* destination, const UChar* source, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i nonASCIIMask = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + characterVectorSize <= length; i += characterVectorSize) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 8));
+        __m128i nonASCIIBits = _mm_and_si128(_mm_or_si128(low, high), nonASCIIMask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonASCIIBits, zero)) != 0xFFFF)
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(low, high));
+    }
+#elif CPU(ARM_NEON)
+    const uint16x8_t nonASCIIMask = vdupq_n_u16(0xFF80);
+    for (; i + characterVectorSize <= length; i += characterVectorSize) {
+        const uint16_t* input = reinterpret_cast<const uint16_t*>(source + i);
+        uint16x8_t low = vld1q_u16(input);
+        uint16x8_t high = vld1q_u16(input + 8);
+        if (isAnyByteSet(vreinterpretq_u8_u16(vandq_u16(vorrq_u16(low, high), nonASCIIMask))))
+            break;
+        vst1q_u8(destination + i, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+    }
+#else
+    UNUSED_PARAM(destination);
+    UNUSED_PARAM(source);
+    UNUSED_PARAM(length);
+#endif
+    return i;
+}
+
 } // namespace WebCore
 
 #endif // TextCodecASCIIFastPath_h
@@ -125,8 +125,20 @@ String TextCodecLatin1::decode(const char* bytes, size_t length, bool, bool, boo
     const uint8_t* end = reinterpret_cast<const uint8_t*>(bytes + length);
     const uint8_t* alignedEnd = alignToMachineWord(end);
     UChar* destination = characters;
+    // Vector blocks are only retried once past the byte that stopped the last one.
+    const uint8_t* vectorRetryPoint = source;
 
     while (source < end) {
+        if (source >= vectorRetryPoint) {
+            // Fast path for everything but the C1 range, which is all the table changes.
+            size_t widenedLength = copyLatin1Vectors(destination, source, end - source);
+            source += widenedLength;
+            destination += widenedLength;
+            if (source == end)
+                break;
+            vectorRetryPoint = source + characterVectorSize;
+        }
+
         if (isASCII(*source)) {
             // Fast path for ASCII. Most Latin-1 text will be ASCII.
             if (isAlignedToMachineWord(source)) {
@@ -196,8 +208,9 @@ CString TextCodecLatin1::encode(const UChar* characters, size_t length, Unencoda
         CString string = CString::newUninitialized(length, bytes);
 
         // Convert the string a fast way and simultaneously do an efficient check to see if it's all ASCII.
+        size_t i = copyASCIIVectorsToBytes(reinterpret_cast<uint8_t*>(bytes), characters, length);
         UChar ored = 0;
-        for (size_t i = 0; i < length; ++i) {
+        for (; i < length; ++i) {
             UChar c = characters[i];
             bytes[i] = c;
             ored |= c;
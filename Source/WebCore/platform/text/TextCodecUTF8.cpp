@@ -137,6 +137,109 @@ static inline int decodeNonASCIISequence(const uint8_t* sequence, unsigned lengt
     return ((sequence[0] << 18) + (sequence[1] << 12) + (sequence[2] << 6) + sequence[3]) - 0x03C82080;
 }
 
+// Decodes blocks of complete two-byte sequences, as in runs of Cyrillic, Greek,
+// Hebrew or Arabic text.  Only sequences that are certainly valid are taken;
+// anything else, including ASCII, is left to the scalar decoder so that errors
+// are handled the same way.  Returns the number of bytes decoded, which is
+// twice the number of characters written.
+static inline size_t decodeTwoByteSequenceVectors(UChar* destination, const uint8_t* source, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    // Each 16-bit lane holds one sequence, lead byte in the low half.
+    const __m128i lowByteMask = _mm_set1_epi16(0x00FF);
+    const __m128i minimumLeadMinusOne = _mm_set1_epi16(0xC1);
+    const __m128i maximumLeadPlusOne = _mm_set1_epi16(0xE0);
+    const __m128i continuationTopBits = _mm_set1_epi16(0xC0);
+    const __m128i continuationMarker = _mm_set1_epi16(0x80);
+    const __m128i leadPayloadMask = _mm_set1_epi16(0x1F);
+    const __m128i continuationPayloadMask = _mm_set1_epi16(0x3F);
+    for (; i + characterVectorSize <= length; i += characterVectorSize) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i leads = _mm_and_si128(block, lowByteMask);
+        __m128i continuations = _mm_srli_epi16(block, 8);
+        __m128i validLeads = _mm_and_si128(_mm_cmpgt_epi16(leads, minimumLeadMinusOne), _mm_cmplt_epi16(leads, maximumLeadPlusOne));
+        __m128i validContinuations = _mm_cmpeq_epi16(_mm_and_si128(continuations, continuationTopBits), continuationMarker);
+        if (_mm_movemask_epi8(_mm_and_si128(validLeads, validContinuations)) != 0xFFFF)
+            break;
+        __m128i characters = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(leads, leadPayloadMask), 6), _mm_and_si128(continuations, continuationPayloadMask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i / 2), characters);
+    }
+#elif CPU(ARM_NEON)
+    // vld2 splits 32 bytes into 16 lead bytes and 16 continuation bytes.
+    const size_t blockSize = 2 * characterVectorSize;
+    const uint8x16_t minimumLead = vdupq_n_u8(0xC2);
+    const uint8x16_t leadRange = vdupq_n_u8(0xDF - 0xC2);
+    const uint8x16_t continuationTopBits = vdupq_n_u8(0xC0);
+    const uint8x16_t continuationMarker = vdupq_n_u8(0x80);
+    const uint8x16_t leadPayloadMask = vdupq_n_u8(0x1F);
+    const uint8x16_t continuationPayloadMask = vdupq_n_u8(0x3F);
+    for (; i + blockSize <= length; i += blockSize) {
+        uint8x16x2_t block = vld2q_u8(source + i);
+        uint8x16_t validLeads = vcleq_u8(vsubq_u8(block.val[0], minimumLead), leadRange);
+        uint8x16_t validContinuations = vceqq_u8(vandq_u8(block.val[1], continuationTopBits), continuationMarker);
+        if (isAnyByteSet(vmvnq_u8(vandq_u8(validLeads, validContinuations))))
+            break;
+        uint8x16_t leads = vandq_u8(block.val[0], leadPayloadMask);
+        uint8x16_t continuations = vandq_u8(block.val[1], continuationPayloadMask);
+        uint16_t* output = reinterpret_cast<uint16_t*>(destination + i / 2);
+        vst1q_u16(output, vorrq_u16(vshll_n_u8(vget_low_u8(leads), 6), vmovl_u8(vget_low_u8(continuations))));
+        vst1q_u16(output + 8, vorrq_u16(vshll_n_u8(vget_high_u8(leads), 6), vmovl_u8(vget_high_u8(continuations))));
+    }
+#else
+    UNUSED_PARAM(destination);
+    UNUSED_PARAM(source);
+    UNUSED_PARAM(length);
+#endif
+    return i;
+}
+
+// Decodes blocks of complete three-byte sequences, as in runs of CJK text.
+// Lead bytes E0 and ED, which constrain the byte after them, are left to the
+// scalar decoder.  Returns the number of bytes decoded, which is three times
+// the number of characters written.  SSE2 has no byte shuffle to separate the
+// bytes of each sequence, so this is only vectorized for NEON.
+static inline size_t decodeThreeByteSequenceVectors(UChar* destination, const uint8_t* source, size_t length)
+{
+    size_t i = 0;
+#if CPU(ARM_NEON) && !defined(__SSE2__)
+    const size_t blockSize = 3 * characterVectorSize;
+    const uint8x16_t minimumLead = vdupq_n_u8(0xE1);
+    const uint8x16_t leadRange = vdupq_n_u8(0xEF - 0xE1);
+    const uint8x16_t surrogateLead = vdupq_n_u8(0xED);
+    const uint8x16_t continuationTopBits = vdupq_n_u8(0xC0);
+    const uint8x16_t continuationMarker = vdupq_n_u8(0x80);
+    const uint8x16_t leadPayloadMask = vdupq_n_u8(0x0F);
+    const uint8x16_t continuationPayloadMask = vdupq_n_u8(0x3F);
+    for (; i + blockSize <= length; i += blockSize) {
+        uint8x16x3_t block = vld3q_u8(source + i);
+        uint8x16_t valid = vcleq_u8(vsubq_u8(block.val[0], minimumLead), leadRange);
+        valid = vbicq_u8(valid, vceqq_u8(block.val[0], surrogateLead));
+        valid = vandq_u8(valid, vceqq_u8(vandq_u8(block.val[1], continuationTopBits), continuationMarker));
+        valid = vandq_u8(valid, vceqq_u8(vandq_u8(block.val[2], continuationTopBits), continuationMarker));
+        if (isAnyByteSet(vmvnq_u8(valid)))
+            break;
+        uint8x16_t leads = vandq_u8(block.val[0], leadPayloadMask);
+        uint8x16_t firstContinuations = vandq_u8(block.val[1], continuationPayloadMask);
+        uint8x16_t secondContinuations = vandq_u8(block.val[2], continuationPayloadMask);
+        uint16_t* output = reinterpret_cast<uint16_t*>(destination + i / 3);
+        uint16x8_t low = vshlq_n_u16(vshll_n_u8(vget_low_u8(leads), 6), 6);
+        low = vorrq_u16(low, vshll_n_u8(vget_low_u8(firstContinuations), 6));
+        low = vorrq_u16(low, vmovl_u8(vget_low_u8(secondContinuations)));
+        uint16x8_t high = vshlq_n_u16(vshll_n_u8(vget_high_u8(leads), 6), 6);
+        high = vorrq_u16(high, vshll_n_u8(vget_high_u8(firstContinuations), 6));
+        high = vorrq_u16(high, vmovl_u8(vget_high_u8(secondContinuations)));
+        vst1q_u16(output, low);
+        vst1q_u16(output + 8, high);
+    }
+#else
+    UNUSED_PARAM(destination);
+    UNUSED_PARAM(source);
+    UNUSED_PARAM(length);
+#endif
+    return i;
+}
+
 static inline UChar* appendCharacter(UChar* destination, int character)
 {
     ASSERT(character != nonCharacter);
@@ -224,6 +327,10 @@ String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool
     const uint8_t* end = source + length;
     const uint8_t* alignedEnd = alignToMachineWord(end);
     UChar* destination = buffer.characters();
+    // Vector blocks are only retried once past the block where the last one
+    // stopped, so that text mixing scripts does not pay for failed attempts on
+    // every character.
+    const uint8_t* vectorRetryPoint = source;
 
     do {
         if (m_partialSequenceSize) {
@@ -242,6 +349,16 @@ String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool
         while (source < end) {
             if (isASCII(*source)) {
                 // Fast path for ASCII. Most UTF-8 text will be ASCII.
+                if (source >= vectorRetryPoint) {
+                    size_t asciiLength = copyASCIIVectors(destination, source, end - source);
+                    source += asciiLength;
+                    destination += asciiLength;
+                    if (source == end)
+                        break;
+                    vectorRetryPoint = source + characterVectorSize;
+                    if (!isASCII(*source))
+                        continue;
+                }
                 if (isAlignedToMachineWord(source)) {
                     while (source < alignedEnd) {
                         MachineWord chunk = *reinterpret_cast_ptr<const MachineWord*>(source);
@@ -260,6 +377,15 @@ String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool
                 continue;
             }
             int count = nonASCIISequenceLength(*source);
+            if ((count == 2 || count == 3) && source >= vectorRetryPoint) {
+                // Runs of non-ASCII text in one script mostly use sequences of one length.
+                size_t decodedLength = count == 2 ? decodeTwoByteSequenceVectors(destination, source, end - source) : decodeThreeByteSequenceVectors(destination, source, end - source);
+                source += decodedLength;
+                destination += decodedLength / count;
+                vectorRetryPoint = source + count * characterVectorSize;
+                if (decodedLength)
+                    continue;
+            }
             int character;
             if (!count)
                 character = nonCharacter;
@@ -304,7 +430,16 @@ CString TextCodecUTF8::encode(const UChar* characters, size_t length, Unencodabl
 
     size_t i = 0;
     size_t bytesWritten = 0;
+    size_t vectorRetryIndex = 0;
     while (i < length) {
+        if (isASCII(characters[i]) && i >= vectorRetryIndex) {
+            size_t asciiLength = copyASCIIVectorsToBytes(bytes.data() + bytesWritten, characters + i, length - i);
+            i += asciiLength;
+            bytesWritten += asciiLength;
+            if (i == length)
+                break;
+            vectorRetryIndex = i + characterVectorSize;
+        }
         UChar32 character;
         U16_NEXT(characters, i, length, character);
         U8_APPEND_UNSAFE(bytes.data(), bytesWritten, character);
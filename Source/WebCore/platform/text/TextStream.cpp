@@ -35,6 +35,12 @@ namespace WebCore {
 
 static const size_t printBufferSize = 100; // large enough for any integer or floating point value in string format, including trailing null character
 
+TextStream::TextStream()
+{
+    // Render tree dumps of large documents get long.
+    m_text.setUsesChunks(true);
+}
+
 TextStream& TextStream::operator<<(bool b)
 {
     return *this << (b ? "1" : "0");
@@ -85,12 +91,9 @@ TextStream& TextStream::operator<<(double d)
 TextStream& TextStream::operator<<(const char* string)
 {
     size_t stringLength = strlen(string);
-    size_t textLength = m_text.size();
-    if (stringLength > numeric_limits<size_t>::max() - textLength)
+    if (stringLength > numeric_limits<unsigned>::max() - m_text.length())
         CRASH();
-    m_text.grow(textLength + stringLength);
-    for (size_t i = 0; i < stringLength; ++i)
-        m_text[textLength + i] = string[i];
+    m_text.append(string, stringLength);
     return *this;
 }
 
@@ -103,13 +106,15 @@ TextStream& TextStream::operator<<(const void* p)
 
 TextStream& TextStream::operator<<(const String& string)
 {
-    append(m_text, string);
+    m_text.append(string);
     return *this;
 }
 
 String TextStream::release()
 {
-    return String::adopt(m_text);
+    String result = m_text.toString();
+    m_text.clear();
+    return result;
 }
 
 #if OS(WINDOWS) && CPU(X86_64)
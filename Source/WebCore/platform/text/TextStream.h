@@ -27,13 +27,14 @@
 #define TextStream_h
 
 #include <wtf/Forward.h>
-#include <wtf/Vector.h>
-#include <wtf/unicode/Unicode.h>
+#include <wtf/text/StringBuilder.h>
 
 namespace WebCore {
 
 class TextStream {
 public:
+    TextStream();
+
     TextStream& operator<<(bool);
     TextStream& operator<<(int);
     TextStream& operator<<(unsigned);
@@ -52,7 +53,7 @@ public:
     String release();
 
 private:
-    Vector<UChar> m_text;
+    StringBuilder m_text;
 };
 
 }
@@ -26,6 +26,7 @@
 #include "RenderTableCell.h"
 #include "RenderTableCol.h"
 #include "RenderTableSection.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -35,6 +36,8 @@ AutoTableLayout::AutoTableLayout(RenderTable* table)
     : TableLayout(table)
     , m_hasPercent(false)
     , m_effectiveLogicalWidthDirty(true)
+    , m_needsFullRecalc(true)
+    , m_hasDirtyColumns(false)
 {
 }
 
@@ -42,7 +45,7 @@ AutoTableLayout::~AutoTableLayout()
 {
 }
 
-void AutoTableLayout::recalcColumn(int effCol)
+void AutoTableLayout::recalcColumn(int effCol, bool collectSpanCells)
 {
     Layout& columnLayout = m_layoutStruct[effCol];
 
@@ -104,7 +107,7 @@ void AutoTableLayout::recalcColumn(int effCol)
                         }
                         break;
                     case Percent:
-                        m_hasPercent = true;
+                        columnLayout.hasPercentCell = true;
                         if (cellLogicalWidth.isPositive() && (!columnLayout.logicalWidth.isPercent() || cellLogicalWidth.value() > columnLayout.logicalWidth.value()))
                             columnLayout.logicalWidth = cellLogicalWidth;
                         break;
@@ -121,7 +124,8 @@ void AutoTableLayout::recalcColumn(int effCol)
                     // a min/max width of at least 1px for this column now.
                     columnLayout.minLogicalWidth = max(columnLayout.minLogicalWidth, cellHasContent ? 1 : 0);
                     columnLayout.maxLogicalWidth = max(columnLayout.maxLogicalWidth, 1);
-                    insertSpanCell(cell);
+                    if (collectSpanCells)
+                        m_spanCells.append(cell);
                 }
             }
         }
@@ -138,15 +142,56 @@ void AutoTableLayout::recalcColumn(int effCol)
     columnLayout.maxLogicalWidth = max(columnLayout.maxLogicalWidth, columnLayout.minLogicalWidth);
 }
 
+bool AutoTableLayout::needsFullRecalc() const
+{
+    if (m_needsFullRecalc || m_layoutStruct.size() != static_cast<size_t>(m_table->numEffCols()))
+        return true;
+
+    // In the collapsing border model a cell's borders depend on its neighbours, so a change
+    // to one cell can change the width of another.
+    if (m_table->collapseBorders())
+        return true;
+
+    // <col> elements don't tell us when they change, but their preferred widths stay dirty
+    // until recalcColumn() visits them.
+    for (RenderObject* child = m_table->firstChild(); child && child->isTableCol(); child = child->nextSibling()) {
+        if (child->preferredLogicalWidthsDirty())
+            return true;
+        for (RenderObject* col = child->firstChild(); col; col = col->nextSibling()) {
+            if (col->preferredLogicalWidthsDirty())
+                return true;
+        }
+    }
+    return false;
+}
+
+void AutoTableLayout::cellPreferredLogicalWidthsChanged(RenderTableCell* cell)
+{
+    if (m_needsFullRecalc)
+        return;
+
+    size_t effCol = m_table->colToEffCol(cell->col());
+    if (effCol >= m_columnNeedsRecalc.size()) {
+        m_needsFullRecalc = true;
+        return;
+    }
+    m_columnNeedsRecalc[effCol] = true;
+    m_hasDirtyColumns = true;
+}
+
 void AutoTableLayout::fullRecalc()
 {
     m_hasPercent = false;
     m_effectiveLogicalWidthDirty = true;
+    m_needsFullRecalc = false;
+    m_hasDirtyColumns = false;
 
     int nEffCols = m_table->numEffCols();
     m_layoutStruct.resize(nEffCols);
     m_layoutStruct.fill(Layout());
-    m_spanCells.fill(0);
+    m_columnNeedsRecalc.resize(nEffCols);
+    m_columnNeedsRecalc.fill(false);
+    m_spanCells.clear();
 
     RenderObject* child = m_table->firstChild();
     Length groupLogicalWidth;
@@ -181,8 +226,37 @@ void AutoTableLayout::fullRecalc()
         child = next;
     }
 
-    for (int i = 0; i < nEffCols; i++)
-        recalcColumn(i);
+    m_columnElementLayoutStruct = m_layoutStruct;
+
+    for (int i = 0; i < nEffCols; i++) {
+        recalcColumn(i, true);
+        m_hasPercent = m_hasPercent || m_layoutStruct[i].hasPercentCell;
+    }
+
+    sortSpanCells();
+}
+
+// Recomputes only the columns that have a cell whose preferred widths changed. The grid and
+// therefore the set of spanning cells are the same as at the last fullRecalc(); only their
+// widths may have changed, and calcEffectiveLogicalWidth() always rereads those.
+void AutoTableLayout::recalcDirtyColumns()
+{
+    if (!m_hasDirtyColumns)
+        return;
+
+    m_hasPercent = false;
+    m_effectiveLogicalWidthDirty = true;
+    m_hasDirtyColumns = false;
+
+    size_t nEffCols = m_layoutStruct.size();
+    for (size_t i = 0; i < nEffCols; ++i) {
+        if (m_columnNeedsRecalc[i]) {
+            m_columnNeedsRecalc[i] = false;
+            m_layoutStruct[i] = m_columnElementLayoutStruct[i];
+            recalcColumn(i, false);
+        }
+        m_hasPercent = m_hasPercent || m_layoutStruct[i].hasPercentCell;
+    }
 }
 
 // FIXME: This needs to be adapted for vertical writing modes.
@@ -221,7 +295,10 @@ static bool shouldScaleColumns(RenderTable* table)
 
 void AutoTableLayout::computePreferredLogicalWidths(int& minWidth, int& maxWidth)
 {
-    fullRecalc();
+    if (needsFullRecalc())
+        fullRecalc();
+    else
+        recalcDirtyColumns();
 
     int spanMaxLogicalWidth = calcEffectiveLogicalWidth();
     minWidth = 0;
@@ -286,13 +363,11 @@ int AutoTableLayout::calcEffectiveLogicalWidth()
         m_layoutStruct[i].effectiveLogicalWidth = m_layoutStruct[i].logicalWidth;
         m_layoutStruct[i].effectiveMinLogicalWidth = m_layoutStruct[i].minLogicalWidth;
         m_layoutStruct[i].effectiveMaxLogicalWidth = m_layoutStruct[i].maxLogicalWidth;
+        m_layoutStruct[i].effectiveEmptyCellsOnly = m_layoutStruct[i].emptyCellsOnly;
     }
 
     for (size_t i = 0; i < m_spanCells.size(); ++i) {
         RenderTableCell* cell = m_spanCells[i];
-        if (!cell)
-            break;
-
         int span = cell->colSpan();
 
         Length cellLogicalWidth = cell->styleOrColLogicalWidth();
@@ -345,7 +420,7 @@ int AutoTableLayout::calcEffectiveLogicalWidth()
                     totalPercent += columnLayout.effectiveLogicalWidth.percent();
                 allColsAreFixed = false;
             }
-            if (!columnLayout.emptyCellsOnly)
+            if (!columnLayout.effectiveEmptyCellsOnly)
                 spanHasEmptyCellsOnly = false;
             span -= m_table->spanOfEffCol(lastCol);
             spanMinLogicalWidth += columnLayout.effectiveMinLogicalWidth;
@@ -438,7 +513,7 @@ int AutoTableLayout::calcEffectiveLogicalWidth()
         // treat span ranges consisting of empty cells only as if they had content
         if (spanHasEmptyCellsOnly) {
             for (unsigned pos = effCol; pos < lastCol; ++pos)
-                m_layoutStruct[pos].emptyCellsOnly = false;
+                m_layoutStruct[pos].effectiveEmptyCellsOnly = false;
         }
     }
     m_effectiveLogicalWidthDirty = false;
@@ -446,32 +521,18 @@ int AutoTableLayout::calcEffectiveLogicalWidth()
     return static_cast<int>(min(maxLogicalWidth, INT_MAX / 2.0f));
 }
 
-/* gets all cells that originate in a column and have a cellspan > 1
-   Sorts them by increasing cellspan
-*/
-void AutoTableLayout::insertSpanCell(RenderTableCell *cell)
+static bool hasSmallerColSpan(const RenderTableCell* a, const RenderTableCell* b)
 {
-    ASSERT_ARG(cell, cell && cell->colSpan() != 1);
-    if (!cell || cell->colSpan() == 1)
-        return;
-
-    int size = m_spanCells.size();
-    if (!size || m_spanCells[size-1] != 0) {
-        m_spanCells.grow(size + 10);
-        for (int i = 0; i < 10; i++)
-            m_spanCells[size+i] = 0;
-        size += 10;
-    }
-
-    // add them in sort. This is a slow algorithm, and a binary search or a fast sorting after collection would be better
-    unsigned int pos = 0;
-    int span = cell->colSpan();
-    while (pos < m_spanCells.size() && m_spanCells[pos] && span > m_spanCells[pos]->colSpan())
-        pos++;
-    memmove(m_spanCells.data()+pos+1, m_spanCells.data()+pos, (size-pos-1)*sizeof(RenderTableCell *));
-    m_spanCells[pos] = cell;
+    return a->colSpan() < b->colSpan();
 }
 
+// Orders the spanning cells collected by recalcColumn() by increasing colspan. Cells with the
+// same colspan are kept last-seen first, as the insertion sort that used to build this list did.
+void AutoTableLayout::sortSpanCells()
+{
+    reverse(m_spanCells.begin(), m_spanCells.end());
+    stable_sort(m_spanCells.begin(), m_spanCells.end(), hasSmallerColSpan);
+}
 
 void AutoTableLayout::layout()
 {
@@ -522,7 +583,7 @@ void AutoTableLayout::layout()
             // fall through
             break;
         case Auto:
-            if (m_layoutStruct[i].emptyCellsOnly)
+            if (m_layoutStruct[i].effectiveEmptyCellsOnly)
                 numAutoEmptyCellsOnly++;
             else {
                 numAuto++;
@@ -591,7 +652,7 @@ void AutoTableLayout::layout()
         available += allocAuto; // this gets redistributed
         for (size_t i = 0; i < nEffCols; ++i) {
             Length& logicalWidth = m_layoutStruct[i].effectiveLogicalWidth;
-            if (logicalWidth.isAuto() && totalAuto && !m_layoutStruct[i].emptyCellsOnly) {
+            if (logicalWidth.isAuto() && totalAuto && !m_layoutStruct[i].effectiveEmptyCellsOnly) {
                 int cellLogicalWidth = max(m_layoutStruct[i].computedLogicalWidth, static_cast<int>(available * static_cast<float>(m_layoutStruct[i].effectiveMaxLogicalWidth) / totalAuto));
                 available -= cellLogicalWidth;
                 totalAuto -= m_layoutStruct[i].effectiveMaxLogicalWidth;
@@ -634,7 +695,7 @@ void AutoTableLayout::layout()
         // still have some width to spread
         for (int i = nEffCols - 1; i >= 0; --i) {
             // variable columns with empty cells only don't get any width
-            if (m_layoutStruct[i].effectiveLogicalWidth.isAuto() && m_layoutStruct[i].emptyCellsOnly)
+            if (m_layoutStruct[i].effectiveLogicalWidth.isAuto() && m_layoutStruct[i].effectiveEmptyCellsOnly)
                 continue;
             int cellLogicalWidth = available / total;
             available -= cellLogicalWidth;
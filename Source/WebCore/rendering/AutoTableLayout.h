@@ -38,13 +38,18 @@ public:
     virtual void computePreferredLogicalWidths(int& minWidth, int& maxWidth);
     virtual void layout();
 
+    virtual void cellPreferredLogicalWidthsChanged(RenderTableCell*);
+    virtual void setNeedsFullRecalc() { m_needsFullRecalc = true; }
+
 private:
+    bool needsFullRecalc() const;
     void fullRecalc();
-    void recalcColumn(int effCol);
+    void recalcDirtyColumns();
+    void recalcColumn(int effCol, bool collectSpanCells);
 
     int calcEffectiveLogicalWidth();
 
-    void insertSpanCell(RenderTableCell*);
+    void sortSpanCells();
 
     struct Layout {
         Layout()
@@ -54,6 +59,8 @@ private:
             , effectiveMaxLogicalWidth(0)
             , computedLogicalWidth(0)
             , emptyCellsOnly(true)
+            , effectiveEmptyCellsOnly(true)
+            , hasPercentCell(false)
         {
         }
 
@@ -65,12 +72,20 @@ private:
         int effectiveMaxLogicalWidth;
         int computedLogicalWidth;
         bool emptyCellsOnly;
+        bool effectiveEmptyCellsOnly;
+        bool hasPercentCell;
     };
 
     Vector<Layout, 4> m_layoutStruct;
+    // The column layouts as set up from the <col> elements, before any cell is seen.
+    // A dirty column starts again from here.
+    Vector<Layout, 4> m_columnElementLayoutStruct;
+    Vector<bool, 4> m_columnNeedsRecalc;
     Vector<RenderTableCell*, 4> m_spanCells;
     bool m_hasPercent : 1;
     mutable bool m_effectiveLogicalWidthDirty : 1;
+    bool m_needsFullRecalc : 1;
+    bool m_hasDirtyColumns : 1;
 };
 
 } // namespace WebCore
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "LineBreakCache.h"
+
+#include "Font.h"
+#include "TextBreakIterator.h"
+#include "TextRun.h"
+#include "break_lines.h"
+#include <wtf/unicode/CharacterNames.h>
+
+namespace WebCore {
+
+static inline bool isSimpleWordCharacter(UChar c)
+{
+    return c != ' ' && c != '\t' && c != '\n' && c != softHyphen && c != noBreakSpace;
+}
+
+PassOwnPtr<LineBreakCache> LineBreakCache::create(const UChar* characters, unsigned length, const Font& font, bool breakNBSP)
+{
+    OwnPtr<LineBreakCache> cache = adoptPtr(new LineBreakCache(breakNBSP));
+    Vector<Space>& spaces = cache->m_spaces;
+
+    LazyLineBreakIterator breakIterator(characters, length);
+    bool wordIsSimple = false;
+    for (unsigned position = 0; position < length; ++position) {
+        UChar c = characters[position];
+        if (c != ' ' || !position || !isSimpleWordCharacter(characters[position - 1])) {
+            if (!isSimpleWordCharacter(c))
+                wordIsSimple = false;
+            continue;
+        }
+
+        Space space;
+        space.position = position;
+        space.lastSpaceInRun = spaces.size();
+        space.wordWidth = 0;
+        space.widthFromRunStart = 0;
+        space.endsSimpleWord = false;
+
+        if (wordIsSimple) {
+            // The word is simple only if the line breaker finds no opportunity
+            // in it, exactly as findNextLineBreak() would ask.
+            const Space& previous = spaces.last();
+            if (nextBreakablePosition(breakIterator, previous.position + 1, breakNBSP) == static_cast<int>(position)) {
+                // Measured as findNextLineBreak() measures words of collapsible text, which ignores xPos.
+                space.wordWidth = font.width(TextRun(characters + previous.position, position - previous.position, false));
+                space.widthFromRunStart = previous.widthFromRunStart + space.wordWidth;
+                space.endsSimpleWord = true;
+            }
+        }
+
+        spaces.append(space);
+        wordIsSimple = true;
+    }
+
+    for (size_t i = spaces.size(); i > 1; --i) {
+        if (spaces[i - 1].endsSimpleWord)
+            spaces[i - 2].lastSpaceInRun = spaces[i - 1].lastSpaceInRun;
+    }
+
+    spaces.shrinkToFit();
+    return cache.release();
+}
+
+size_t LineBreakCache::indexOfSpace(unsigned position) const
+{
+    size_t low = 0;
+    size_t high = m_spaces.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (m_spaces[middle].position < position)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low < m_spaces.size() && m_spaces[low].position == position)
+        return low;
+    return notFound;
+}
+
+size_t LineBreakCache::lastSpaceWithin(size_t index, float maximumWidth, float wordSpacing) const
+{
+    float start = m_spaces[index].widthFromRunStart;
+    size_t low = index;
+    size_t high = m_spaces[index].lastSpaceInRun;
+    while (low < high) {
+        size_t middle = low + (high - low + 1) / 2;
+        if (m_spaces[middle].widthFromRunStart - start + (middle - index) * wordSpacing <= maximumWidth)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+} // namespace WebCore
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LineBreakCache_h
+#define LineBreakCache_h
+
+#include <wtf/Noncopyable.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/Vector.h>
+#include <wtf/unicode/Unicode.h>
+
+namespace WebCore {
+
+class Font;
+
+// Remembers where the words of a RenderText start and how wide they are, so
+// that findNextLineBreak() can move a line over several words at once instead
+// of walking and measuring their characters again each time the text is laid
+// out at a new width.
+//
+// The cache records every single space that follows a non-space character.
+// The text from one such space up to the next is a simple word when it has no
+// break opportunity, white space, soft hyphen or no-break space in it; its
+// width is then the width that findNextLineBreak() would measure for it.
+// Consecutive simple words form a run, and each space stores the running total
+// of the widths of its run so that the words that fit in a given width can be
+// found with a binary search.
+//
+// The cache depends on the characters and the font of the RenderText, which
+// drops it whenever either of them changes.
+class LineBreakCache {
+    WTF_MAKE_NONCOPYABLE(LineBreakCache); WTF_MAKE_FAST_ALLOCATED;
+public:
+    // Shorter texts rarely span enough lines to be worth caching.
+    static const unsigned minimumTextLength = 64;
+
+    static PassOwnPtr<LineBreakCache> create(const UChar*, unsigned length, const Font&, bool breakNBSP);
+
+    bool breakNBSP() const { return m_breakNBSP; }
+
+    // Returns the index of the space at |position|, or notFound if there is
+    // no cached space there.
+    size_t indexOfSpace(unsigned position) const;
+
+    unsigned position(size_t index) const { return m_spaces[index].position; }
+
+    // Width of the simple word that starts at the previous space and ends
+    // before the space at |index|, including that previous space.
+    float wordWidth(size_t index) const
+    {
+        ASSERT(m_spaces[index].endsSimpleWord);
+        return m_spaces[index].wordWidth;
+    }
+
+    bool endsSimpleWord(size_t index) const { return m_spaces[index].endsSimpleWord; }
+
+    // Returns the index of the last space that can be reached from the space
+    // at |index| over simple words whose widths, each increased by
+    // |wordSpacing|, add up to at most |maximumWidth|.
+    size_t lastSpaceWithin(size_t index, float maximumWidth, float wordSpacing) const;
+
+private:
+    LineBreakCache(bool breakNBSP)
+        : m_breakNBSP(breakNBSP)
+    {
+    }
+
+    struct Space {
+        unsigned position;
+        unsigned lastSpaceInRun;
+        float wordWidth;
+        float widthFromRunStart;
+        bool endsSimpleWord;
+    };
+
+    Vector<Space> m_spaces;
+    bool m_breakNBSP;
+};
+
+} // namespace WebCore
+
+#endif // LineBreakCache_h
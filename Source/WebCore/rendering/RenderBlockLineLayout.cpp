@@ -26,6 +26,7 @@
 #include "Hyphenation.h"
 #include "InlineIterator.h"
 #include "InlineTextBox.h"
+#include "LineBreakCache.h"
 #include "Logging.h"
 #include "RenderArena.h"
 #include "RenderCombineText.h"
@@ -1804,6 +1805,35 @@ void LineWidth::fitBelowFloats()
     }
 }
 
+// Commits the simple words that follow the space at |pos| for as long as they fit
+// on the line, and moves |pos| to the space after the last of them. The cached
+// widths are added one word at a time, as the character loop in findNextLineBreak()
+// adds them, so the line breaks exactly where it would have without the cache.
+static bool skipWordsThatFit(const LineBreakCache& lineBreakCache, unsigned& pos, float wordSpacing, LineWidth& width)
+{
+    ASSERT(!width.uncommittedWidth());
+
+    size_t index = lineBreakCache.indexOfSpace(pos);
+    if (index == notFound)
+        return false;
+
+    size_t lastIndex = lineBreakCache.lastSpaceWithin(index, width.availableWidth() - width.committedWidth(), wordSpacing);
+    size_t skippedIndex = index;
+    while (skippedIndex < lastIndex) {
+        float wordWidth = lineBreakCache.wordWidth(skippedIndex + 1) + wordSpacing;
+        if (!width.fitsOnLine(wordWidth))
+            break;
+        width.addUncommittedWidth(wordWidth);
+        width.commit();
+        ++skippedIndex;
+    }
+
+    if (skippedIndex == index)
+        return false;
+    pos = lineBreakCache.position(skippedIndex);
+    return true;
+}
+
 InlineIterator RenderBlock::findNextLineBreak(InlineBidiResolver& resolver, bool firstLine, bool& isLineEmpty, LineBreakIteratorInfo& lineBreakIteratorInfo, bool& previousLineBrokeCleanly, 
                                               bool& hyphenated, EClear* clear, FloatingObject* lastFloatFromPreviousLine, Vector<RenderBox*>& positionedBoxes)
 {
@@ -2042,6 +2072,15 @@ InlineIterator RenderBlock::findNextLineBreak(InlineBidiResolver& resolver, bool
             bool breakAll = o->style()->wordBreak() == BreakAllWordBreak && autoWrap;
             float hyphenWidth = 0;
 
+            // Plain wrapping text in the block's own style can skip whole words using the cached
+            // word widths; anything that needs to look at the characters of each word cannot.
+            bool canUseLineBreakCache = currWS == NORMAL && !o->style()->breakOnlyAfterWhiteSpace() && !breakAll && !wordTrailingSpaceWidth
+                && !isFixedPitch && !style->hasTextCombine() && style == t->style() && static_cast<unsigned>(strlen) >= LineBreakCache::minimumTextLength;
+#if ENABLE(SVG)
+            if (isSVGText)
+                canUseLineBreakCache = false;
+#endif
+
             if (t->isWordBreak()) {
                 width.commit();
                 lBreak.moveToStartOf(o);
@@ -2193,6 +2232,18 @@ InlineIterator RenderBlock::findNextLineBreak(InlineBidiResolver& resolver, bool
                         lastSpaceWordSpacing = applyWordSpacing ? wordSpacing : 0;
                         lastSpace = pos;
                     }
+
+                    // We just committed the word before a single space; the words after it that are
+                    // known to fit can be committed without visiting their characters. Each of them
+                    // ends at a single space too, so the state below stays what the loop would leave.
+                    if (canUseLineBreakCache && betweenWords && c == ' ' && !previousCharacterIsSpace && !midWordBreak && !hyphenWidth
+                        && skipWordsThatFit(*t->lineBreakCache(breakNBSP), pos, lastSpaceWordSpacing, width)) {
+                        len = strlen - pos;
+                        lastSpace = pos;
+                        nextBreakable = pos;
+                        lBreak.moveTo(o, pos, nextBreakable);
+                        trailingPositionedBoxes.clear();
+                    }
                     
                     if (!ignoringSpaces && o->style()->collapseWhiteSpace()) {
                         // If we encounter a newline, or if we encounter a
@@ -27,6 +27,7 @@
 #include "config.h"
 #include "RenderImage.h"
 
+#include "Chrome.h"
 #include "Frame.h"
 #include "GraphicsContext.h"
 #include "HTMLAreaElement.h"
@@ -88,6 +89,20 @@ static const unsigned short paddingHeight = 4;
 static const float maxAltTextWidth = 1024;
 static const int maxAltTextHeight = 256;
 
+// Images are asked to decode at this multiple of their displayed device size,
+// so that zooming in a little further doesn't show a blurry image.
+static const float decodeSizeHeadroom = 2;
+
+static float decodeScaleFactor(Frame* frame)
+{
+    if (!frame)
+        return 1;
+    float scale = frame->pageScaleFactor();
+    if (Page* page = frame->page())
+        scale *= page->chrome()->scaleFactor();
+    return scale > 0 ? scale : 1;
+}
+
 IntSize RenderImage::imageSizeForError(CachedImage* newImage) const
 {
     ASSERT_ARG(newImage, newImage);
@@ -249,6 +264,18 @@ void RenderImage::paintReplaced(PaintInfo& paintInfo, int tx, int ty)
 
     GraphicsContext* context = paintInfo.context;
 
+    // An image that is being painted has scrolled into view; don't let it queue behind off-screen images.
+    if (CachedImage* cachedImage = m_imageResource->cachedImage()) {
+        if (cachedImage->isLoading() && cachedImage->loadPriority() < ResourceLoadPriorityMedium)
+            cachedImage->setLoadPriority(ResourceLoadPriorityMedium);
+        // Ask for the size in device pixels at the current page scale. When the scale grows,
+        // the larger request makes the image decode again at the higher resolution.
+        if (cWidth > 0 && cHeight > 0) {
+            float scale = decodeScaleFactor(frame()) * decodeSizeHeadroom;
+            cachedImage->requestDecodeSize(IntSize(static_cast<int>(ceilf(cWidth * scale)), static_cast<int>(ceilf(cHeight * scale))));
+        }
+    }
+
     if (!m_imageResource->hasImage() || m_imageResource->errorOccurred()) {
         if (paintInfo.phase == PaintPhaseSelection)
             return;
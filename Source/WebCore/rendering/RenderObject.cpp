@@ -578,7 +578,12 @@ void RenderObject::setPreferredLogicalWidthsDirty(bool b, bool markParents)
 {
     bool alreadyDirty = m_preferredLogicalWidthsDirty;
     m_preferredLogicalWidthsDirty = b;
-    if (b && !alreadyDirty && markParents && (isText() || (style()->position() != FixedPosition && style()->position() != AbsolutePosition)))
+    if (!b || alreadyDirty)
+        return;
+
+    if (isTableCell())
+        toRenderTableCell(this)->invalidateColumnPreferredLogicalWidths();
+    if (markParents && (isText() || (style()->position() != FixedPosition && style()->position() != AbsolutePosition)))
         invalidateContainerPreferredLogicalWidths();
 }
 
@@ -590,11 +595,15 @@ void RenderObject::invalidateContainerPreferredLogicalWidths()
     while (o && !o->m_preferredLogicalWidthsDirty) {
         // Don't invalidate the outermost object of an unrooted subtree. That object will be 
         // invalidated when the subtree is added to the document.
-        RenderObject* container = o->isTableCell() ? o->containingBlock() : o->container();
+        bool isTableCell = o->isTableCell();
+        RenderObject* container = isTableCell ? o->containingBlock() : o->container();
         if (!container && !o->isRenderView())
             break;
 
         o->m_preferredLogicalWidthsDirty = true;
+        // Auto table layout only recomputes the columns of the cells it is told about.
+        if (isTableCell)
+            toRenderTableCell(o)->invalidateColumnPreferredLogicalWidths();
         if (o->style()->position() == FixedPosition || o->style()->position() == AbsolutePosition)
             // A positioned object has no effect on the min/max width of its containing block ever.
             // We can optimize this case and not go up any further.
@@ -2105,6 +2114,10 @@ void RenderObject::destroy()
     if (m_hasCounterNodeMap)
         RenderCounter::destroyCounterNodes(this);
 
+    // The renderer may still be queued as an isolated layout root.
+    if (FrameView* frameView = document()->view())
+        frameView->removeIsolatedLayoutRoot(this);
+
     // FIXME: Would like to do this in RenderBoxModelObject, but the timing is so complicated that this can't easily
     // be moved into RenderBoxModelObject::destroy.
     if (hasLayer()) {
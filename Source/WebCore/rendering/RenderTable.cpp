@@ -95,7 +95,8 @@ void RenderTable::styleDidChange(StyleDifference diff, const RenderStyle* oldSty
             m_tableLayout.set(new FixedTableLayout(this));
         else
             m_tableLayout.set(new AutoTableLayout(this));
-    }
+    } else
+        m_tableLayout->setNeedsFullRecalc();
 }
 
 static inline void resetSectionPointerIfNotBefore(RenderTableSection*& ptr, RenderObject* before)
@@ -644,6 +645,12 @@ void RenderTable::paintMask(PaintInfo& paintInfo, int tx, int ty)
     paintMaskImages(paintInfo, rect.x(), rect.y(), rect.width(), rect.height());
 }
 
+void RenderTable::cellPreferredLogicalWidthsChanged(RenderTableCell* cell)
+{
+    if (m_tableLayout)
+        m_tableLayout->cellPreferredLogicalWidthsChanged(cell);
+}
+
 void RenderTable::computePreferredLogicalWidths()
 {
     ASSERT(preferredLogicalWidthsDirty());
@@ -840,6 +847,10 @@ void RenderTable::recalcSections() const
 
     ASSERT(selfNeedsLayout());
 
+    // The grid may have changed, so none of the column widths can be reused.
+    if (m_tableLayout)
+        m_tableLayout->setNeedsFullRecalc();
+
     m_needsSectionRecalc = false;
 }
 
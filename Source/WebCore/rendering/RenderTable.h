@@ -176,6 +176,9 @@ public:
     RenderTableCol* nextColElement(RenderTableCol* current) const;
 
     bool needsSectionRecalc() const { return m_needsSectionRecalc; }
+
+    // Tells the table layout which column to recompute the next time the preferred widths are computed.
+    void cellPreferredLogicalWidthsChanged(RenderTableCell*);
     void setNeedsSectionRecalc()
     {
         if (documentBeingDestroyed())
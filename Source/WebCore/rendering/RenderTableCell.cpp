@@ -127,6 +127,22 @@ Length RenderTableCell::styleOrColLogicalWidth() const
     return w;
 }
 
+void RenderTableCell::invalidateColumnPreferredLogicalWidths()
+{
+    RenderObject* row = parent();
+    RenderObject* section = row ? row->parent() : 0;
+    RenderObject* table = section ? section->parent() : 0;
+    if (!table || !table->isTable() || !section->isTableSection())
+        return;
+
+    // Until the grid is rebuilt our column may be stale, and the rebuild makes the table
+    // layout recompute every column anyway.
+    if (toRenderTable(table)->needsSectionRecalc() || toRenderTableSection(section)->needsCellRecalc())
+        return;
+
+    toRenderTable(table)->cellPreferredLogicalWidthsChanged(this);
+}
+
 void RenderTableCell::computePreferredLogicalWidths()
 {
     // The child cells rely on the grids up in the sections to do their computePreferredLogicalWidths work.  Normally the sections are set up early, as table
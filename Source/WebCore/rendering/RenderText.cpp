@@ -192,6 +192,8 @@ void RenderText::styleDidChange(StyleDifference diff, const RenderStyle* oldStyl
         m_knownToHaveNoOverflowAndNoFallbackFonts = false;
     }
 
+    m_lineBreakCache.clear();
+
     bool needsResetText = false;
     if (!oldStyle) {
         updateNeedsTranscoding();
@@ -1160,6 +1162,7 @@ void RenderText::setTextInternal(PassRefPtr<StringImpl> text)
 {
     ASSERT(text);
     m_text = text;
+    m_lineBreakCache.clear();
     if (m_needsTranscoding) {
         const TextEncoding* encoding = document()->decoder() ? &document()->decoder()->encoding() : 0;
         fontTranscoder().convert(m_text, style()->font().fontDescription(), encoding);
@@ -1191,6 +1194,13 @@ void RenderText::setTextInternal(PassRefPtr<StringImpl> text)
     m_isAllASCII = m_text.containsOnlyASCII();
 }
 
+LineBreakCache* RenderText::lineBreakCache(bool breakNBSP)
+{
+    if (!m_lineBreakCache || m_lineBreakCache->breakNBSP() != breakNBSP)
+        m_lineBreakCache = LineBreakCache::create(characters(), textLength(), style()->font(), breakNBSP);
+    return m_lineBreakCache.get();
+}
+
 void RenderText::secureText(UChar mask)
 {
     if (!m_text.length())
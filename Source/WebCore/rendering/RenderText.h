@@ -23,8 +23,10 @@
 #ifndef RenderText_h
 #define RenderText_h
 
+#include "LineBreakCache.h"
 #include "RenderObject.h"
 #include <wtf/Forward.h>
+#include <wtf/OwnPtr.h>
 
 namespace WebCore {
 
@@ -131,6 +133,10 @@ public:
     
     bool knownToHaveNoOverflowAndNoFallbackFonts() const { return m_knownToHaveNoOverflowAndNoFallbackFonts; }
 
+    // Returns the word breaks and widths of the text in the current style's font,
+    // computing them on first use. They are dropped when the text or style changes.
+    LineBreakCache* lineBreakCache(bool breakNBSP);
+
     void removeAndDestroyTextBoxes();
 
 protected:
@@ -170,6 +176,8 @@ private:
     InlineTextBox* m_firstTextBox;
     InlineTextBox* m_lastTextBox;
 
+    OwnPtr<LineBreakCache> m_lineBreakCache;
+
     float m_maxWidth;
     float m_beginMinWidth;
     float m_endMinWidth;
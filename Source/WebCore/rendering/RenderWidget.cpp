@@ -25,6 +25,7 @@
 
 #include "AXObjectCache.h"
 #include "AnimationController.h"
+#include "FrameView.h"
 #include "GraphicsContext.h"
 #include "HitTestResult.h"
 #include "RenderCounter.h"
@@ -134,6 +135,10 @@ void RenderWidget::destroy()
     if (m_hasCounterNodeMap)
         RenderCounter::destroyCounterNodes(this);
 
+    // The renderer may still be queued as an isolated layout root.
+    if (FrameView* frameView = document()->view())
+        frameView->removeIsolatedLayoutRoot(this);
+
     setWidget(0);
 
     // removes from override size map
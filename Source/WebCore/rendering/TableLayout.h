@@ -27,6 +27,7 @@
 namespace WebCore {
 
 class RenderTable;
+class RenderTableCell;
 
 class TableLayout {
     WTF_MAKE_NONCOPYABLE(TableLayout); WTF_MAKE_FAST_ALLOCATED;
@@ -41,6 +42,11 @@ public:
     virtual void computePreferredLogicalWidths(int& minWidth, int& maxWidth) = 0;
     virtual void layout() = 0;
 
+    // Layouts that cache per-column widths use these to learn what to recompute: a single
+    // cell whose preferred widths became dirty, or a change to the table's grid or style.
+    virtual void cellPreferredLogicalWidthsChanged(RenderTableCell*) { }
+    virtual void setNeedsFullRecalc() { }
+
 protected:
     RenderTable* m_table;
 };
@@ -58,6 +58,9 @@ static WebCore::OriginQuotaManager& originQuotaManager()
 
 namespace WebCore {
 
+// Every tracker query uses one of a handful of statements.
+static const unsigned trackerStatementCacheCapacity = 16;
+
 static DatabaseTracker* staticTracker = 0;
 
 void DatabaseTracker::initializeTracker(const String& databasePath)
@@ -122,6 +125,7 @@ void DatabaseTracker::openTrackerDatabase(bool createIfDoesNotExist)
         return;
     }
     m_database.disableThreadingChecks();
+    m_database.setStatementCacheCapacity(trackerStatementCacheCapacity);
     if (!m_database.tableExists("Origins")) {
         if (!m_database.executeCommand("CREATE TABLE Origins (origin TEXT UNIQUE ON CONFLICT REPLACE, quota INTEGER NOT NULL ON CONFLICT FAIL);")) {
             // FIXME: and here
@@ -38,6 +38,7 @@
 #include "LevelDBIterator.h"
 #include "LevelDBSlice.h"
 #include "SecurityOrigin.h"
+#include <string.h>
 
 #ifndef INT64_MAX
 // FIXME: We shouldn't need to rely on these macros.
@@ -57,21 +58,27 @@
 //
 // Each key type has a class (in square brackets below) which knows how to encode, decode, and compare that key type.
 //
+// The prefix is one byte holding the lengths of the three ids, followed by the ids as little-endian integers of
+// just that many bytes, so the prefix of a typical record takes four bytes. Other integers are varints: seven bits
+// per byte, least significant first. Strings in keys are a varint of (length << 1 | wide) followed by the characters,
+// one byte each when none is above U+00FF, and big-endian UTF-16 otherwise. String values are a byte saying which
+// of the two it is, followed by the characters.
+//
 // Global meta-data have keys with prefix (0,0,0), followed by a type byte:
 //
-//     <0, 0, 0, 0>                                           => IndexedDB/LevelDB schema version (0 for now) [SchemaVersionKey]
-//     <0, 0, 0, 1>                                           => The maximum database id ever allocated [MaxDatabaseIdKey]
-//     <0, 0, 0, 100, database id>                            => Existence implies the database id is in the free list [DatabaseFreeListKey]
-//     <0, 0, 0, 201, utf16 origin name, utf16 database name> => Database id [DatabaseNameKey]
+//     <0, 0, 0, 0>                               => IndexedDB/LevelDB schema version [SchemaVersionKey]
+//     <0, 0, 0, 1>                               => The maximum database id ever allocated [MaxDatabaseIdKey]
+//     <0, 0, 0, 100, database id>                => Existence implies the database id is in the free list [DatabaseFreeListKey]
+//     <0, 0, 0, 201, origin name, database name> => Database id [DatabaseNameKey]
 //
 //
 // Database meta-data:
 //
 //     Again, the prefix is followed by a type byte.
 //
-//     <database id, 0, 0, 0> => utf16 origin name [DatabaseMetaDataKey]
-//     <database id, 0, 0, 1> => utf16 database name [DatabaseMetaDataKey]
-//     <database id, 0, 0, 2> => utf16 user version data [DatabaseMetaDataKey]
+//     <database id, 0, 0, 0> => origin name [DatabaseMetaDataKey]
+//     <database id, 0, 0, 1> => database name [DatabaseMetaDataKey]
+//     <database id, 0, 0, 2> => user version data [DatabaseMetaDataKey]
 //     <database id, 0, 0, 3> => maximum object store id ever allocated [DatabaseMetaDataKey]
 //
 //
@@ -79,31 +86,32 @@
 //
 //     The prefix is followed by a type byte, then a variable-length integer, and then another variable-length integer (FIXME: this should be a byte).
 //
-//     <database id, 0, 0, 50, object store id, 0> => utf16 object store name [ObjectStoreMetaDataKey]
-//     <database id, 0, 0, 50, object store id, 1> => utf16 key path [ObjectStoreMetaDataKey]
+//     <database id, 0, 0, 50, object store id, 0> => object store name [ObjectStoreMetaDataKey]
+//     <database id, 0, 0, 50, object store id, 1> => key path [ObjectStoreMetaDataKey]
 //     <database id, 0, 0, 50, object store id, 2> => has auto increment [ObjectStoreMetaDataKey]
 //     <database id, 0, 0, 50, object store id, 3> => is evictable [ObjectStoreMetaDataKey]
 //     <database id, 0, 0, 50, object store id, 4> => last "version" number [ObjectStoreMetaDataKey]
 //     <database id, 0, 0, 50, object store id, 5> => maximum index id ever allocated [ObjectStoreMetaDataKey]
+//     <database id, 0, 0, 50, object store id, 6> => next auto increment number [ObjectStoreMetaDataKey]
 //
 //
 // Index meta-data:
 //
 //     The prefix is followed by a type byte, then two variable-length integers, and then another type byte.
 //
-//     <database id, 0, 0, 100, object store id, index id, 0> => utf16 index name [IndexMetaDataKey]
+//     <database id, 0, 0, 100, object store id, index id, 0> => index name [IndexMetaDataKey]
 //     <database id, 0, 0, 100, object store id, index id, 1> => are index keys unique [IndexMetaDataKey]
-//     <database id, 0, 0, 100, object store id, index id, 2> => utf16 key path [IndexMetaDataKey]
+//     <database id, 0, 0, 100, object store id, index id, 2> => key path [IndexMetaDataKey]
 //
 //
 // Other object store and index meta-data:
 //
-//     The prefix is followed by a type byte. The object store and index id are variable length integers, the utf16 strings are variable length strings.
+//     The prefix is followed by a type byte. The object store and index id are variable length integers, the strings are strings with their length.
 //
-//     <database id, 0, 0, 150, object store id>                   => existence implies the object store id is in the free list [ObjectStoreFreeListKey]
-//     <database id, 0, 0, 151, object store id, index id>         => existence implies the index id is in the free list [IndexFreeListKey]
-//     <database id, 0, 0, 200, utf16 object store name>           => object store id [ObjectStoreNamesKey]
-//     <database id, 0, 0, 201, object store id, utf16 index name> => index id [IndexNamesKey]
+//     <database id, 0, 0, 150, object store id>             => existence implies the object store id is in the free list [ObjectStoreFreeListKey]
+//     <database id, 0, 0, 151, object store id, index id>   => existence implies the index id is in the free list [IndexFreeListKey]
+//     <database id, 0, 0, 200, object store name>           => object store id [ObjectStoreNamesKey]
+//     <database id, 0, 0, 201, object store id, index name> => index id [IndexNamesKey]
 //
 //
 // Object store data:
@@ -141,10 +149,16 @@ static const unsigned char kIDBKeyDateTypeByte = 2;
 static const unsigned char kIDBKeyNumberTypeByte = 3;
 static const unsigned char kIDBKeyMinKeyTypeByte = 4;
 
+static const unsigned char kString8BitTypeByte = 0;
+static const unsigned char kString16BitTypeByte = 1;
+
 static const unsigned char kMinimumIndexId = 30;
 static const unsigned char kObjectStoreDataIndexId = 1;
 static const unsigned char kExistsEntryIndexId = 2;
 
+// Version 1 introduced the compact string encoding and fixed the byte order of integers.
+static const int64_t kLatestSchemaVersion = 1;
+
 static const unsigned char kSchemaVersionTypeByte = 0;
 static const unsigned char kMaxDatabaseIdTypeByte = 1;
 static const unsigned char kDatabaseFreeListTypeByte = 100;
@@ -159,6 +173,8 @@ static const unsigned char kIndexNamesKeyTypeByte = 201;
 
 namespace WebCore {
 
+using namespace std;
+
 static Vector<char> encodeByte(unsigned char c)
 {
     Vector<char> v;
@@ -195,9 +211,11 @@ static int64_t decodeInt(const char* begin, const char* end)
     ASSERT(begin <= end);
     int64_t ret = 0;
 
+    int shift = 0;
     while (begin < end) {
         unsigned char c = *begin++;
-        ret = (ret << 8) | c;
+        ret |= static_cast<int64_t>(c) << shift;
+        shift += 8;
     }
 
     return ret;
@@ -205,6 +223,7 @@ static int64_t decodeInt(const char* begin, const char* end)
 
 static Vector<char> encodeVarInt(int64_t n)
 {
+    ASSERT(n >= 0);
     Vector<char> ret; // FIXME: Size this at creation.
 
     do {
@@ -223,70 +242,173 @@ static const char* decodeVarInt(const char *p, const char* limit, int64_t& found
     ASSERT(limit >= p);
     foundInt = 0;
 
+    int shift = 0;
     do {
         if (p >= limit)
             return 0;
 
-        foundInt = (foundInt << 7) | (*p & 0x7f);
+        unsigned char c = *p;
+        foundInt |= static_cast<int64_t>(c & 0x7f) << shift;
+        shift += 7;
     } while (*p++ & 128);
     return p;
 }
 
-static Vector<char> encodeString(const String& s)
+static int compareInts(int64_t a, int64_t b)
 {
-    Vector<char> ret; // FIXME: Size this at creation.
+    if (a < b)
+        return -1;
+    if (a > b)
+        return 1;
+    return 0;
+}
 
+static bool isLatin1(const String& s)
+{
+    const UChar* characters = s.characters();
     for (unsigned i = 0; i < s.length(); ++i) {
-        UChar u = s[i];
+        if (characters[i] > 0xff)
+            return false;
+    }
+    return true;
+}
+
+static void appendCharacters(Vector<char>& ret, const String& s, bool wide)
+{
+    const UChar* characters = s.characters();
+    unsigned length = s.length();
+
+    if (!wide) {
+        ret.reserveCapacity(ret.size() + length);
+        for (unsigned i = 0; i < length; ++i)
+            ret.append(static_cast<char>(characters[i]));
+        return;
+    }
+
+    ret.reserveCapacity(ret.size() + length * 2);
+    for (unsigned i = 0; i < length; ++i) {
+        UChar u = characters[i];
         unsigned char hi = u >> 8;
         unsigned char lo = u;
         ret.append(hi);
         ret.append(lo);
     }
+}
+
+static UChar encodedCharacterAt(const char* characters, bool wide, size_t i)
+{
+    if (!wide)
+        return static_cast<unsigned char>(characters[i]);
+
+    unsigned char hi = characters[i * 2];
+    unsigned char lo = characters[i * 2 + 1];
+    return (hi << 8) | lo;
+}
 
+static String decodeCharacters(const char* characters, size_t length, bool wide)
+{
+    if (!wide)
+        return String(characters, length);
+
+    Vector<UChar> vector(length);
+    for (size_t i = 0; i < length; ++i)
+        vector[i] = encodedCharacterAt(characters, true, i);
+
+    return String::adopt(vector);
+}
+
+static Vector<char> encodeString(const String& s)
+{
+    bool wide = !isLatin1(s);
+    Vector<char> ret = encodeByte(wide ? kString16BitTypeByte : kString8BitTypeByte);
+    appendCharacters(ret, s, wide);
     return ret;
 }
 
 static String decodeString(const char* p, const char* end)
 {
     ASSERT(end >= p);
-    ASSERT(!((end - p) % 2));
-
-    size_t len = (end - p) / 2;
-    Vector<UChar> vector(len);
+    if (p == end)
+        return "";
 
-    for (size_t i = 0; i < len; ++i) {
-        unsigned char hi = *p++;
-        unsigned char lo = *p++;
+    bool wide = *p++ == kString16BitTypeByte;
+    ASSERT(!wide || !((end - p) % 2));
 
-        vector[i] = (hi << 8) | lo;
-    }
-
-    return String::adopt(vector);
+    return decodeCharacters(p, wide ? (end - p) / 2 : end - p, wide);
 }
 
 static Vector<char> encodeStringWithLength(const String& s)
 {
-    Vector<char> ret = encodeVarInt(s.length());
-    ret.append(encodeString(s));
+    bool wide = !isLatin1(s);
+    Vector<char> ret = encodeVarInt(static_cast<int64_t>(s.length()) << 1 | wide);
+    appendCharacters(ret, s, wide);
     return ret;
 }
 
-static const char* decodeStringWithLength(const char* p, const char* limit, String& foundString)
+// Finds the characters of a string encoded with its length, without copying them.
+static const char* extractStringWithLength(const char* p, const char* limit, const char*& characters, size_t& length, bool& wide)
 {
     ASSERT(limit >= p);
-    int64_t len;
-    p = decodeVarInt(p, limit, len);
+    int64_t header;
+    p = decodeVarInt(p, limit, header);
     if (!p)
         return 0;
-    if (p + len * 2 > limit)
+
+    length = header >> 1;
+    wide = header & 1;
+    size_t size = wide ? length * 2 : length;
+    if (static_cast<size_t>(limit - p) < size)
+        return 0;
+
+    characters = p;
+    return p + size;
+}
+
+static const char* decodeStringWithLength(const char* p, const char* limit, String& foundString)
+{
+    const char* characters;
+    size_t length;
+    bool wide;
+    p = extractStringWithLength(p, limit, characters, length, wide);
+    if (!p)
         return 0;
 
-    foundString = decodeString(p, p + len * 2);
-    p += len * 2;
+    foundString = decodeCharacters(characters, length, wide);
     return p;
 }
 
+// Compares two strings encoded with their lengths in the order of codePointCompare(),
+// and moves past them.
+static int compareStringsWithLength(const char*& p, const char* limitP, const char*& q, const char* limitQ)
+{
+    const char* charactersP;
+    const char* charactersQ;
+    size_t lengthP, lengthQ;
+    bool wideP, wideQ;
+    p = extractStringWithLength(p, limitP, charactersP, lengthP, wideP);
+    q = extractStringWithLength(q, limitQ, charactersQ, lengthQ, wideQ);
+    ASSERT(p);
+    ASSERT(q);
+    if (!p || !q)
+        return 0;
+
+    size_t length = min(lengthP, lengthQ);
+    if (wideP == wideQ) {
+        // Big-endian UTF-16 sorts byte by byte in code unit order, like Latin-1 does.
+        if (int x = memcmp(charactersP, charactersQ, wideP ? length * 2 : length))
+            return x > 0 ? 1 : -1;
+    } else {
+        for (size_t i = 0; i < length; ++i) {
+            UChar a = encodedCharacterAt(charactersP, wideP, i);
+            UChar b = encodedCharacterAt(charactersQ, wideQ, i);
+            if (a != b)
+                return a > b ? 1 : -1;
+        }
+    }
+
+    return compareInts(lengthP, lengthQ);
+}
+
 static Vector<char> encodeDouble(double x)
 {
     // FIXME: It would be nice if we could be byte order independent.
@@ -385,7 +507,9 @@ static const char* extractEncodedIDBKey(const char* start, const char* limit, Ve
 
     unsigned char type = *p++;
 
-    int64_t stringLen;
+    const char* characters;
+    size_t length;
+    bool wide;
 
     switch (type) {
     case kIDBKeyNullTypeByte:
@@ -394,14 +518,12 @@ static const char* extractEncodedIDBKey(const char* start, const char* limit, Ve
         return p;
     case kIDBKeyStringTypeByte:
         // String.
-        p = decodeVarInt(p, limit, stringLen);
+        p = extractStringWithLength(p, limit, characters, length, wide);
         if (!p)
             return 0;
-        if (p + stringLen * 2 > limit)
-            return 0;
         result->clear();
-        result->append(start, p - start + stringLen * 2);
-        return p + stringLen * 2;
+        result->append(start, p - start);
+        return p;
     case kIDBKeyDateTypeByte:
     case kIDBKeyNumberTypeByte:
         // Date or number.
@@ -415,20 +537,15 @@ static const char* extractEncodedIDBKey(const char* start, const char* limit, Ve
     return 0;
 }
 
-static int compareEncodedIDBKeys(const Vector<char>& keyA, const Vector<char>& keyB)
+// Compares two encoded keys in place, and moves past them.
+static int compareEncodedIDBKeys(const char*& p, const char* limitA, const char*& q, const char* limitB)
 {
-    ASSERT(keyA.size() >= 1);
-    ASSERT(keyB.size() >= 1);
-
-    const char* p = keyA.data();
-    const char* limitA = p + keyA.size();
-    const char* q = keyB.data();
-    const char* limitB = q + keyB.size();
+    ASSERT(p < limitA);
+    ASSERT(q < limitB);
 
     unsigned char typeA = *p++;
     unsigned char typeB = *q++;
 
-    String s, t;
     double d, e;
 
     if (int x = typeB - typeA) // FIXME: Note the subtleness!
@@ -441,11 +558,7 @@ static int compareEncodedIDBKeys(const Vector<char>& keyA, const Vector<char>& k
         return 0;
     case kIDBKeyStringTypeByte:
         // String type.
-        p = decodeStringWithLength(p, limitA, s); // FIXME: Compare without actually decoding the String!
-        ASSERT(p);
-        q = decodeStringWithLength(q, limitB, t);
-        ASSERT(q);
-        return codePointCompare(s, t);
+        return compareStringsWithLength(p, limitA, q, limitB);
     case kIDBKeyDateTypeByte:
     case kIDBKeyNumberTypeByte:
         // Date or number.
@@ -464,6 +577,16 @@ static int compareEncodedIDBKeys(const Vector<char>& keyA, const Vector<char>& k
     return 0;
 }
 
+static int compareEncodedIDBKeys(const Vector<char>& keyA, const Vector<char>& keyB)
+{
+    ASSERT(keyA.size() >= 1);
+    ASSERT(keyB.size() >= 1);
+
+    const char* p = keyA.data();
+    const char* q = keyB.data();
+    return compareEncodedIDBKeys(p, p + keyA.size(), q, q + keyB.size());
+}
+
 static bool getInt(LevelDBDatabase* db, const Vector<char>& key, int64_t& foundInt)
 {
     Vector<char> result;
@@ -568,13 +691,11 @@ public:
         ASSERT(m_objectStoreId != kInvalidId);
         ASSERT(m_indexId != kInvalidId);
 
-        if (m_databaseId != other.m_databaseId)
-            return m_databaseId - other.m_databaseId;
-        if (m_objectStoreId != other.m_objectStoreId)
-            return m_objectStoreId - other.m_objectStoreId;
-        if (m_indexId != other.m_indexId)
-            return m_indexId - other.m_indexId;
-        return 0;
+        if (int x = compareInts(m_databaseId, other.m_databaseId))
+            return x;
+        if (int x = compareInts(m_objectStoreId, other.m_objectStoreId))
+            return x;
+        return compareInts(m_indexId, other.m_indexId);
     }
 
     enum Type {
@@ -679,7 +800,7 @@ public:
     int compare(const DatabaseFreeListKey& other) const
     {
         ASSERT(m_databaseId >= 0);
-        return m_databaseId - other.m_databaseId;
+        return compareInts(m_databaseId, other.m_databaseId);
     }
 
 private:
@@ -809,9 +930,9 @@ public:
     {
         ASSERT(m_objectStoreId >= 0);
         ASSERT(m_metaDataType >= 0);
-        if (int x = m_objectStoreId - other.m_objectStoreId)
-            return x; // FIXME: Is this cast safe? I.e., will it preserve the sign?
-        return m_metaDataType - other.m_metaDataType;
+        if (int x = compareInts(m_objectStoreId, other.m_objectStoreId))
+            return x;
+        return compareInts(m_metaDataType, other.m_metaDataType);
     }
 
 private:
@@ -871,9 +992,9 @@ public:
         ASSERT(m_objectStoreId >= 0);
         ASSERT(m_indexId >= 0);
 
-        if (int x = m_objectStoreId - other.m_objectStoreId)
+        if (int x = compareInts(m_objectStoreId, other.m_objectStoreId))
             return x;
-        if (int x = m_indexId - other.m_indexId)
+        if (int x = compareInts(m_indexId, other.m_indexId))
             return x;
         return m_metaDataType - other.m_metaDataType;
     }
@@ -938,7 +1059,7 @@ public:
         // but that comparison will have been made earlier.
         // We should probably make this more clear, though...
         ASSERT(m_objectStoreId >= 0);
-        return m_objectStoreId - other.m_objectStoreId;
+        return compareInts(m_objectStoreId, other.m_objectStoreId);
     }
 
 private:
@@ -988,9 +1109,9 @@ public:
     {
         ASSERT(m_objectStoreId >= 0);
         ASSERT(m_indexId >= 0);
-        if (int x = m_objectStoreId - other.m_objectStoreId)
+        if (int x = compareInts(m_objectStoreId, other.m_objectStoreId))
             return x;
-        return m_indexId - other.m_indexId;
+        return compareInts(m_indexId, other.m_indexId);
     }
 
     int64_t objectStoreId() const
@@ -1035,7 +1156,6 @@ public:
     {
         KeyPrefix prefix(databaseId, 0, 0);
         Vector<char> ret = prefix.encode();
-        ret.append(encodeByte(kSchemaVersionTypeByte));
         ret.append(encodeByte(kObjectStoreNamesTypeByte));
         ret.append(encodeStringWithLength(objectStoreName));
         return ret;
@@ -1095,7 +1215,7 @@ public:
     int compare(const IndexNamesKey& other)
     {
         ASSERT(m_objectStoreId >= 0);
-        if (int x = m_objectStoreId - other.m_objectStoreId)
+        if (int x = compareInts(m_objectStoreId, other.m_objectStoreId))
             return x;
         return codePointCompare(m_indexName, other.m_indexName);
     }
@@ -1262,7 +1382,7 @@ public:
             return x;
         if (ignoreSequenceNumber)
             return 0;
-        return m_sequenceNumber - other.m_sequenceNumber;
+        return compareInts(m_sequenceNumber, other.m_sequenceNumber);
     }
 
     int64_t databaseId() const
@@ -1388,7 +1508,8 @@ static int realCompare(const LevelDBSlice& a, const LevelDBSlice& b, bool indexK
         if (ptrB == endB)
             return 1; // FIXME: This case of non-existing user keys should not have to be handled this way.
 
-        return decodeAndCompare<ObjectStoreDataKey>(a, b);
+        // Compare the user keys in place; this is the comparison behind most reads and writes.
+        return compareEncodedIDBKeys(ptrA, endA, ptrB, endB);
     }
     if (prefixA.type() == KeyPrefix::kExistsEntry) {
         if (ptrA == endA && ptrB == endB)
@@ -1398,7 +1519,7 @@ static int realCompare(const LevelDBSlice& a, const LevelDBSlice& b, bool indexK
         if (ptrB == endB)
             return 1; // FIXME: This case of non-existing user keys should not have to be handled this way.
 
-        return decodeAndCompare<ExistsEntryKey>(a, b);
+        return compareEncodedIDBKeys(ptrA, endA, ptrB, endB);
     }
     if (prefixA.type() == KeyPrefix::kIndexData) {
         if (ptrA == endA && ptrB == endB)
@@ -1408,16 +1529,20 @@ static int realCompare(const LevelDBSlice& a, const LevelDBSlice& b, bool indexK
         if (ptrB == endB)
             return 1; // FIXME: This case of non-existing user keys should not have to be handled this way.
 
-        IndexDataKey indexDataKeyA;
-        IndexDataKey indexDataKeyB;
-
-        ptrA = IndexDataKey::decode(a.begin(), endA, &indexDataKeyA);
-        ptrB = IndexDataKey::decode(b.begin(), endB, &indexDataKeyB);
-        ASSERT(ptrA);
-        ASSERT(ptrB);
-
+        if (int x = compareEncodedIDBKeys(ptrA, endA, ptrB, endB))
+            return x;
         bool ignoreSequenceNumber = indexKeys;
-        return indexDataKeyA.compare(indexDataKeyB, ignoreSequenceNumber);
+        if (ignoreSequenceNumber)
+            return 0;
+
+        // FIXME: We should change it so that all keys have a sequence number. Shouldn't need to handle this case.
+        int64_t sequenceNumberA = -1;
+        int64_t sequenceNumberB = -1;
+        if (ptrA != endA)
+            decodeVarInt(ptrA, endA, sequenceNumberA);
+        if (ptrB != endB)
+            decodeVarInt(ptrB, endB, sequenceNumberB);
+        return compareInts(sequenceNumberA, sequenceNumberB);
     }
 
     ASSERT_NOT_REACHED();
@@ -1437,23 +1562,47 @@ static int compareIndexKeys(const LevelDBSlice& a, const LevelDBSlice& b)
 class Comparator : public LevelDBComparator {
 public:
     virtual int compare(const LevelDBSlice& a, const LevelDBSlice& b) const { return realCompare(a, b); }
+    virtual const char* name() const { return "idb_cmp2"; }
+};
+
+// Only used to recognize a database written before schema version 1; LevelDB
+// refuses to open a database with a differently named comparator. The old
+// key order can't be reproduced, so this orders keys bytewise; the database
+// is destroyed straight after.
+class LegacyComparator : public LevelDBComparator {
+public:
+    virtual int compare(const LevelDBSlice& a, const LevelDBSlice& b) const
+    {
+        size_t lengthA = a.end() - a.begin();
+        size_t lengthB = b.end() - b.begin();
+        if (int x = memcmp(a.begin(), b.begin(), min(lengthA, lengthB)))
+            return x;
+        return compareInts(lengthA, lengthB);
+    }
     virtual const char* name() const { return "idb_cmp1"; }
 };
 }
 
+static bool isLegacyDatabase(const String& path)
+{
+    LegacyComparator legacyComparator;
+    OwnPtr<LevelDBDatabase> legacyDb = adoptPtr(LevelDBDatabase::open(path, &legacyComparator));
+    return legacyDb;
+}
+
 static bool setUpMetadata(LevelDBDatabase* db)
 {
     const Vector<char> metaDataKey = SchemaVersionKey::encode();
 
     int64_t schemaVersion;
     if (!getInt(db, metaDataKey, schemaVersion)) {
-        schemaVersion = 0;
+        schemaVersion = kLatestSchemaVersion;
         if (!putInt(db, metaDataKey, schemaVersion))
             return false;
     }
 
     // FIXME: Eventually, we'll need to be able to transition between schemas.
-    if (schemaVersion)
+    if (schemaVersion != kLatestSchemaVersion)
         return false; // Don't know what to do with this version.
 
     return true;
@@ -1490,10 +1639,18 @@ PassRefPtr<IDBBackingStore> IDBLevelDBBackingStore::open(SecurityOrigin* securit
 
     OwnPtr<LevelDBComparator> comparator(new Comparator());
     LevelDBDatabase* db = LevelDBDatabase::open(path, comparator.get());
-    if (!db)
-        return 0;
-
-    // FIXME: Handle comparator name changes.
+    if (!db) {
+        // The schema before version 1 used the "idb_cmp1" comparator. Its integers above 127
+        // did not read back correctly, so it can't be converted; start over instead. Any other
+        // failure leaves the files alone.
+        // FIXME: Migrate future schema changes instead of discarding data.
+        if (!fileExists(path) || !isLegacyDatabase(path) || !LevelDBDatabase::destroy(path))
+            return 0;
+        LOG_ERROR("Discarded IndexedDB database %s written with an old schema", path.utf8().data());
+        db = LevelDBDatabase::open(path, comparator.get());
+        if (!db)
+            return 0;
+    }
 
     RefPtr<IDBLevelDBBackingStore> backingStore(adoptRef(new IDBLevelDBBackingStore(fileIdentifier, factory, db)));
     backingStore->m_comparator = comparator.release();
@@ -1584,6 +1741,10 @@ void IDBLevelDBBackingStore::getObjectStores(int64_t databaseId, Vector<int64_t>
         p = ObjectStoreMetaDataKey::decode(p, limit, &metaDataKey);
         ASSERT(p);
 
+        // Skip the rows after the ones read below, such as the next auto increment number.
+        if (metaDataKey.metaDataType())
+            continue;
+
         int64_t objectStoreId = metaDataKey.objectStoreId();
 
         String objectStoreName = decodeString(it->value().begin(), it->value().end());
@@ -1669,6 +1830,7 @@ bool IDBLevelDBBackingStore::createObjectStore(int64_t databaseId, const String&
     const Vector<char> evictableKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 3);
     const Vector<char> lastVersionKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 4);
     const Vector<char> maxIndexIdKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 5);
+    const Vector<char> autoIncrementNumberKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 6);
     const Vector<char> namesKey = ObjectStoreNamesKey::encode(databaseId, name);
 
     bool ok = putString(m_db.get(), nameKey, name);
@@ -1707,6 +1869,12 @@ bool IDBLevelDBBackingStore::createObjectStore(int64_t databaseId, const String&
         return false;
     }
 
+    ok = putInt(m_db.get(), autoIncrementNumberKey, 1);
+    if (!ok) {
+        LOG_ERROR("Internal Indexed DB error.");
+        return false;
+    }
+
     ok = putInt(m_db.get(), namesKey, objectStoreId);
     if (!ok) {
         LOG_ERROR("Internal Indexed DB error.");
@@ -1735,7 +1903,7 @@ void IDBLevelDBBackingStore::deleteObjectStore(int64_t databaseId, int64_t objec
     String objectStoreName;
     getString(m_db.get(), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 0), objectStoreName);
 
-    if (!deleteRange(m_db.get(), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 0), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 6)))
+    if (!deleteRange(m_db.get(), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 0), ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 7)))
         return; // FIXME: Report error.
 
     putString(m_db.get(), ObjectStoreFreeListKey::encode(databaseId, objectStoreId), "");
@@ -1822,6 +1990,15 @@ bool IDBLevelDBBackingStore::putObjectStoreRecord(int64_t databaseId, int64_t ob
     if (!m_db->put(existsEntryKey, encodeInt(version)))
         return false;
 
+    // Generated keys must stay above every numeric key in the store.
+    if (key.type() == IDBKey::NumberType) {
+        const Vector<char> autoIncrementNumberKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 6);
+        int64_t autoIncrementNumber;
+        int64_t n = static_cast<int64_t>(key.number());
+        if (getInt(m_db.get(), autoIncrementNumberKey, autoIncrementNumber) && n >= autoIncrementNumber && !putInt(m_db.get(), autoIncrementNumberKey, n + 1))
+            return false;
+    }
+
     LevelDBRecordIdentifier* levelDBRecordIdentifier = static_cast<LevelDBRecordIdentifier*>(recordIdentifier);
     levelDBRecordIdentifier->setPrimaryKey(encodeIDBKey(key));
     levelDBRecordIdentifier->setVersion(version);
@@ -1850,6 +2027,13 @@ void IDBLevelDBBackingStore::deleteObjectStoreRecord(int64_t databaseId, int64_t
 
 double IDBLevelDBBackingStore::nextAutoIncrementNumber(int64_t databaseId, int64_t objectStoreId)
 {
+    const Vector<char> autoIncrementNumberKey = ObjectStoreMetaDataKey::encode(databaseId, objectStoreId, 6);
+    int64_t autoIncrementNumber;
+    if (getInt(m_db.get(), autoIncrementNumberKey, autoIncrementNumber))
+        return autoIncrementNumber;
+
+    // Object stores created before the number was kept in the meta-data need
+    // one scan, after which putObjectStoreRecord() keeps it up to date.
     const Vector<char> startKey = ObjectStoreDataKey::encode(databaseId, objectStoreId, minIDBKey());
     const Vector<char> stopKey = ObjectStoreDataKey::encode(databaseId, objectStoreId, maxIDBKey());
 
@@ -1874,6 +2058,8 @@ double IDBLevelDBBackingStore::nextAutoIncrementNumber(int64_t databaseId, int64
         }
     }
 
+    if (!putInt(m_db.get(), autoIncrementNumberKey, maxNumericKey + 1))
+        LOG_ERROR("Internal Indexed DB error.");
     return maxNumericKey + 1;
 }
 
@@ -2143,6 +2329,12 @@ bool IDBLevelDBBackingStore::keyExistsInIndex(int64_t databaseId, int64_t object
 }
 
 namespace {
+// Cursors read rows from LevelDB in batches that grow with each refill, so that a cursor
+// which is only read once costs one row, while a long walk costs few iterator steps.
+// The batch is thrown away, and the iterator reopened, whenever the database has been
+// written to since it was read.
+static const size_t kMaximumCursorPrefetchSize = 32;
+
 class CursorImplCommon : public IDBBackingStore::Cursor {
 public:
     // IDBBackingStore::Cursor
@@ -2164,10 +2356,25 @@ protected:
         , m_highKey(highKey)
         , m_highOpen(highOpen)
         , m_forward(forward)
+        , m_nextRow(0)
+        , m_iteratorModificationCount(0)
+        , m_prefetchSize(1)
+        , m_iteratorAtEnd(false)
     {
     }
     virtual ~CursorImplCommon() {}
 
+    bool isPastEnd(const LevelDBSlice&) const;
+    bool isBeforeStart(const LevelDBSlice&) const;
+    void reopenIterator();
+    bool fetchRows();
+    bool loadNextRow(const IDBKey*);
+
+    struct Row {
+        Vector<char> key;
+        Vector<char> value;
+    };
+
     LevelDBDatabase* m_db;
     OwnPtr<LevelDBIterator> m_iterator;
     Vector<char> m_lowKey;
@@ -2176,83 +2383,104 @@ protected:
     bool m_highOpen;
     bool m_forward;
     RefPtr<IDBKey> m_currentKey;
+
+    // The row loadCurrentRow() should decode.
+    Vector<char> m_currentRowKey;
+    Vector<char> m_currentRowValue;
+
+private:
+    Vector<Row> m_rows;
+    size_t m_nextRow;
+    unsigned long long m_iteratorModificationCount;
+    size_t m_prefetchSize;
+    bool m_iteratorAtEnd;
 };
 
-bool CursorImplCommon::firstSeek()
+bool CursorImplCommon::isPastEnd(const LevelDBSlice& key) const
 {
-    m_iterator = m_db->newIterator();
-
     if (m_forward)
-        m_iterator->seek(m_lowKey);
-    else
-        m_iterator->seek(m_highKey);
-
-    for (;;) {
-        if (!m_iterator->isValid())
-            return false;
-
-        if (m_forward && m_highOpen && compareIndexKeys(m_iterator->key(), m_highKey) >= 0)
-            return false;
-        if (m_forward && !m_highOpen && compareIndexKeys(m_iterator->key(), m_highKey) > 0)
-            return false;
-        if (!m_forward && m_lowOpen && compareIndexKeys(m_iterator->key(), m_lowKey) <= 0)
-            return false;
-        if (!m_forward && !m_lowOpen && compareIndexKeys(m_iterator->key(), m_lowKey) < 0)
-            return false;
+        return m_highOpen ? compareIndexKeys(key, m_highKey) >= 0 : compareIndexKeys(key, m_highKey) > 0;
+    return m_lowOpen ? compareIndexKeys(key, m_lowKey) <= 0 : compareIndexKeys(key, m_lowKey) < 0;
+}
 
-        if (m_forward && m_lowOpen) {
-            // lowKey not included in the range.
-            if (compareIndexKeys(m_iterator->key(), m_lowKey) <= 0) {
-                m_iterator->next();
-                continue;
-            }
-        }
-        if (!m_forward && m_highOpen) {
-            // highKey not included in the range.
-            if (compareIndexKeys(m_iterator->key(), m_highKey) >= 0) {
-                m_iterator->prev();
-                continue;
-            }
-        }
+bool CursorImplCommon::isBeforeStart(const LevelDBSlice& key) const
+{
+    // The start key is only excluded from the range when the bound is open.
+    if (m_forward)
+        return m_lowOpen && compareIndexKeys(key, m_lowKey) <= 0;
+    return m_highOpen && compareIndexKeys(key, m_highKey) >= 0;
+}
 
-        if (!loadCurrentRow()) {
-            if (m_forward)
-                m_iterator->next();
-            else
-                m_iterator->prev();
-            continue;
-        }
+void CursorImplCommon::reopenIterator()
+{
+    // Opening an iterator writes out any buffered writes, so take the count afterwards.
+    m_iterator = m_db->newIterator();
+    m_iteratorModificationCount = m_db->modificationCount();
+    m_iteratorAtEnd = false;
+    m_rows.clear();
+    m_nextRow = 0;
 
-        return true;
+    if (m_currentRowKey.isEmpty()) {
+        m_iterator->seek(m_forward ? m_lowKey : m_highKey);
+        return;
     }
+
+    // Carry on from the row after the one the cursor last looked at.
+    m_iterator->seek(m_currentRowKey);
+    if (m_forward) {
+        if (m_iterator->isValid() && !compareKeys(m_iterator->key(), m_currentRowKey))
+            m_iterator->next();
+    } else if (m_iterator->isValid())
+        m_iterator->prev();
+    else
+        m_iterator->seekToLast();
 }
 
-bool CursorImplCommon::continueFunction(const IDBKey* key)
+bool CursorImplCommon::fetchRows()
 {
-    // FIXME: This shares a lot of code with firstSeek.
+    m_rows.clear();
+    m_nextRow = 0;
+    if (m_iteratorAtEnd)
+        return false;
+
+    for (size_t i = 0; i < m_prefetchSize; ++i) {
+        if (!m_iterator->isValid() || isPastEnd(m_iterator->key())) {
+            m_iteratorAtEnd = true;
+            break;
+        }
+
+        m_rows.grow(m_rows.size() + 1);
+        Row& row = m_rows.last();
+        row.key.append(m_iterator->key().begin(), m_iterator->key().end() - m_iterator->key().begin());
+        row.value.append(m_iterator->value().begin(), m_iterator->value().end() - m_iterator->value().begin());
 
-    for (;;) {
         if (m_forward)
             m_iterator->next();
         else
             m_iterator->prev();
+    }
 
-        if (!m_iterator->isValid())
-            return false;
+    m_prefetchSize = min(m_prefetchSize * 2, kMaximumCursorPrefetchSize);
+    return !m_rows.isEmpty();
+}
 
-        Vector<char> trash;
-        if (!m_db->get(m_iterator->key(), trash))
-             continue;
+bool CursorImplCommon::loadNextRow(const IDBKey* key)
+{
+    for (;;) {
+        // Rows read before a write may since have been changed or removed.
+        if (m_db->modificationCount() != m_iteratorModificationCount)
+            reopenIterator();
 
-        if (m_forward && m_highOpen && compareIndexKeys(m_iterator->key(), m_highKey) >= 0) // high key not included in range
-            return false;
-        if (m_forward && !m_highOpen && compareIndexKeys(m_iterator->key(), m_highKey) > 0)
-            return false;
-        if (!m_forward && m_lowOpen && compareIndexKeys(m_iterator->key(), m_lowKey) <= 0) // low key not included in range
-            return false;
-        if (!m_forward && !m_lowOpen && compareIndexKeys(m_iterator->key(), m_lowKey) < 0)
+        if (m_nextRow == m_rows.size() && !fetchRows())
             return false;
 
+        Row& row = m_rows[m_nextRow++];
+        m_currentRowKey.swap(row.key);
+        m_currentRowValue.swap(row.value);
+
+        if (isBeforeStart(m_currentRowKey))
+            continue;
+
         if (!loadCurrentRow())
             continue;
 
@@ -2268,10 +2496,19 @@ bool CursorImplCommon::continueFunction(const IDBKey* key)
 
         // FIXME: Obey the uniqueness constraint (and test for it!)
 
-        break;
+        return true;
     }
+}
 
-    return true;
+bool CursorImplCommon::firstSeek()
+{
+    reopenIterator();
+    return loadNextRow(0);
+}
+
+bool CursorImplCommon::continueFunction(const IDBKey* key)
+{
+    return loadNextRow(key);
 }
 
 class ObjectStoreCursorImpl : public CursorImplCommon {
@@ -2298,8 +2535,8 @@ private:
 
 bool ObjectStoreCursorImpl::loadCurrentRow()
 {
-    const char* p = m_iterator->key().begin();
-    const char* keyLimit = m_iterator->key().end();
+    const char* p = m_currentRowKey.begin();
+    const char* keyLimit = m_currentRowKey.end();
 
     ObjectStoreDataKey objectStoreDataKey;
     p = ObjectStoreDataKey::decode(p, keyLimit, &objectStoreDataKey);
@@ -2310,13 +2547,13 @@ bool ObjectStoreCursorImpl::loadCurrentRow()
     m_currentKey = objectStoreDataKey.userKey();
 
     int64_t version;
-    const char* q = decodeVarInt(m_iterator->value().begin(), m_iterator->value().end(), version);
+    const char* q = decodeVarInt(m_currentRowValue.begin(), m_currentRowValue.end(), version);
     ASSERT(q);
     if (!q)
         return false;
     (void) version;
 
-    m_currentValue = decodeString(q, m_iterator->value().end());
+    m_currentValue = decodeString(q, m_currentRowValue.end());
 
     return true;
 }
@@ -2346,20 +2583,20 @@ private:
 
 bool IndexKeyCursorImpl::loadCurrentRow()
 {
-    const char* p = m_iterator->key().begin();
-    const char* keyLimit = m_iterator->key().end();
+    const char* p = m_currentRowKey.begin();
+    const char* keyLimit = m_currentRowKey.end();
     IndexDataKey indexDataKey;
     p = IndexDataKey::decode(p, keyLimit, &indexDataKey);
 
     m_currentKey = indexDataKey.userKey();
 
     int64_t indexDataVersion;
-    const char* q = decodeVarInt(m_iterator->value().begin(), m_iterator->value().end(), indexDataVersion);
+    const char* q = decodeVarInt(m_currentRowValue.begin(), m_currentRowValue.end(), indexDataVersion);
     ASSERT(q);
     if (!q)
         return false;
 
-    q = decodeIDBKey(q, m_iterator->value().end(), m_primaryKey);
+    q = decodeIDBKey(q, m_currentRowValue.end(), m_primaryKey);
     ASSERT(q);
     if (!q)
         return false;
@@ -2377,7 +2614,7 @@ bool IndexKeyCursorImpl::loadCurrentRow()
         return false;
 
     if (objectStoreDataVersion != indexDataVersion) { // FIXME: This is probably not very well covered by the layout tests.
-        m_db->remove(m_iterator->key());
+        m_db->remove(m_currentRowKey);
         return false;
     }
 
@@ -2411,16 +2648,16 @@ private:
 
 bool IndexCursorImpl::loadCurrentRow()
 {
-    const char *p = m_iterator->key().begin();
-    const char *limit = m_iterator->key().end();
+    const char *p = m_currentRowKey.begin();
+    const char *limit = m_currentRowKey.end();
 
     IndexDataKey indexDataKey;
     p = IndexDataKey::decode(p, limit, &indexDataKey);
 
     m_currentKey = indexDataKey.userKey();
 
-    const char *q = m_iterator->value().begin();
-    const char *valueLimit = m_iterator->value().end();
+    const char *q = m_currentRowValue.begin();
+    const char *valueLimit = m_currentRowValue.end();
 
     int64_t indexDataVersion;
     q = decodeVarInt(q, valueLimit, indexDataVersion);
@@ -2445,7 +2682,7 @@ bool IndexCursorImpl::loadCurrentRow()
         return false;
 
     if (objectStoreDataVersion != indexDataVersion) {
-        m_db->remove(m_iterator->key());
+        m_db->remove(m_currentRowKey);
         return false;
     }
 
@@ -2591,18 +2828,56 @@ PassRefPtr<IDBBackingStore::Cursor> IDBLevelDBBackingStore::openIndexCursor(int6
 }
 
 namespace {
-class DummyTransaction : public IDBBackingStore::Transaction {
+// Writes made during a transaction are buffered and committed as one LevelDB write batch,
+// so that a bulk load costs one write rather than several per record. Reads and iterators
+// see the buffered writes, and rolling back discards all of them.
+class TransactionImpl : public IDBBackingStore::Transaction {
 public:
-    virtual void begin() {}
-    virtual void commit() {}
-    virtual void rollback() {}
+    static PassRefPtr<TransactionImpl> create(LevelDBDatabase* db)
+    {
+        return adoptRef(new TransactionImpl(db));
+    }
+
+    // IDBBackingStore::Transaction
+    virtual void begin()
+    {
+        ASSERT(!m_inProgress);
+        m_db->beginWriteBatch();
+        m_inProgress = true;
+    }
+    virtual void commit()
+    {
+        // The write batch is shared by the whole database, so a transaction
+        // that never began must not commit or roll back someone else's writes.
+        if (!m_inProgress)
+            return;
+        m_inProgress = false;
+        if (!m_db->commitWriteBatch())
+            LOG_ERROR("Failed to commit an IndexedDB transaction");
+    }
+    virtual void rollback()
+    {
+        if (!m_inProgress)
+            return;
+        m_inProgress = false;
+        m_db->rollbackWriteBatch();
+    }
+
+private:
+    TransactionImpl(LevelDBDatabase* db)
+        : m_db(db)
+        , m_inProgress(false)
+    {
+    }
+
+    LevelDBDatabase* m_db;
+    bool m_inProgress;
 };
 }
 
 PassRefPtr<IDBBackingStore::Transaction> IDBLevelDBBackingStore::createTransaction()
 {
-    // FIXME: We need to implement a transaction abstraction that allows for roll-backs, and write tests for it.
-    return adoptRef(new DummyTransaction());
+    return TransactionImpl::create(m_db.get());
 }
 
 // FIXME: deleteDatabase should be part of IDBBackingStore.
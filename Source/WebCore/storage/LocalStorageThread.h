@@ -61,7 +61,7 @@ namespace WebCore {
         void* threadEntryPoint();
 
         ThreadIdentifier m_threadID;
-        MessageQueue<LocalStorageTask> m_queue;
+        LockFreeMessageQueue<LocalStorageTask> m_queue;
     };
 
 } // namespace WebCore
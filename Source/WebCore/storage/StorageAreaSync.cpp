@@ -31,14 +31,21 @@
 #include "EventNames.h"
 #include "FileSystem.h"
 #include "HTMLElement.h"
+#include "Logging.h"
 #include "SQLiteFileSystem.h"
 #include "SQLiteStatement.h"
+#include "SQLiteTransaction.h"
 #include "SecurityOrigin.h"
 #include "StorageAreaImpl.h"
 #include "StorageSyncManager.h"
 #include "StorageTracker.h"
 #include "SuddenTermination.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/Vector.h>
 #include <wtf/text/CString.h>
+#include <wtf/text/StringBuilder.h>
+
+using namespace std;
 
 namespace WebCore {
 
@@ -46,17 +53,44 @@ namespace WebCore {
 // Instead, queue up a batch of items to sync and actually do the sync at the following interval.
 static const double StorageSyncInterval = 1.0;
 
+// While a page keeps overwriting the same keys, most of each sync is redundant, so the
+// interval doubles up to this limit. It falls back to StorageSyncInterval once writes
+// are mostly to new keys again.
+static const double MaximumStorageSyncInterval = 8.0;
+
+// The shortest wait before finishing a partial sync, so that a large write is persisted
+// quickly without monopolizing the background thread.
+static const double MinimumStorageSyncInterval = 0.1;
+
+// Nothing waits on a sync, so it can wait for other timers to wake us up.
+static const double StorageSyncTolerance = 1.0;
+
 // A sane limit on how many items we'll schedule to sync all at once.  This makes it
 // much harder to starve the rest of LocalStorage and the OS's IO subsystem in general.
-static const int MaxiumItemsToSync = 100;
+// The limit adapts between these bounds so that each sync takes about TargetSyncDuration.
+static const unsigned MinimumItemsToSync = 100;
+static const unsigned MaximumItemsToSync = 10000;
+static const double TargetSyncDuration = 0.05;
+
+// Items are written with multi-row statements. This keeps the number of bound
+// parameters well below SQLite's default limit of 999.
+static const unsigned MaximumRowsPerStatement = 64;
+
+// Enough to keep the import, clear and count statements compiled between syncs, along
+// with the full-size multi-row insert and delete statements.
+static const unsigned StorageStatementCacheCapacity = 8;
 
 inline StorageAreaSync::StorageAreaSync(PassRefPtr<StorageSyncManager> storageSyncManager, PassRefPtr<StorageAreaImpl> storageArea, const String& databaseIdentifier)
     : m_syncTimer(this, &StorageAreaSync::syncTimerFired)
     , m_itemsCleared(false)
+    , m_syncInterval(StorageSyncInterval)
+    , m_writesSinceSync(0)
     , m_finalSyncScheduled(false)
     , m_storageArea(storageArea)
     , m_syncManager(storageSyncManager)
     , m_databaseIdentifier(databaseIdentifier.crossThreadString())
+    , m_itemsPerSync(MinimumItemsToSync)
+    , m_lastSyncDuration(0)
     , m_clearItemsWhileSyncing(false)
     , m_syncScheduled(false)
     , m_syncInProgress(false)
@@ -67,6 +101,7 @@ inline StorageAreaSync::StorageAreaSync(PassRefPtr<StorageSyncManager> storageSy
     ASSERT(isMainThread());
     ASSERT(m_storageArea);
     ASSERT(m_syncManager);
+    m_syncTimer.setTolerance(StorageSyncTolerance);
 }
 
 PassRefPtr<StorageAreaSync> StorageAreaSync::create(PassRefPtr<StorageSyncManager> storageSyncManager, PassRefPtr<StorageAreaImpl> storageArea, const String& databaseIdentifier)
@@ -115,13 +150,8 @@ void StorageAreaSync::scheduleItemForSync(const String& key, const String& value
     ASSERT(!m_finalSyncScheduled);
 
     m_changedItems.set(key, value);
-    if (!m_syncTimer.isActive()) {
-        m_syncTimer.startOneShot(StorageSyncInterval);
-
-        // The following is balanced by the call to enableSuddenTermination in the
-        // syncTimerFired function.
-        disableSuddenTermination();
-    }
+    ++m_writesSinceSync;
+    startSyncTimer();
 }
 
 void StorageAreaSync::scheduleClear()
@@ -131,13 +161,7 @@ void StorageAreaSync::scheduleClear()
 
     m_changedItems.clear();
     m_itemsCleared = true;
-    if (!m_syncTimer.isActive()) {
-        m_syncTimer.startOneShot(StorageSyncInterval);
-
-        // The following is balanced by the call to enableSuddenTermination in the
-        // syncTimerFired function.
-        disableSuddenTermination();
-    }
+    startSyncTimer();
 }
 
 void StorageAreaSync::scheduleCloseDatabase()
@@ -149,14 +173,21 @@ void StorageAreaSync::scheduleCloseDatabase()
         return;
 
     m_syncCloseDatabase = true;
-    
-    if (!m_syncTimer.isActive()) {
-        m_syncTimer.startOneShot(StorageSyncInterval);
-        
-        // The following is balanced by the call to enableSuddenTermination in the
-        // syncTimerFired function.
-        disableSuddenTermination();
-    }
+    startSyncTimer();
+}
+
+void StorageAreaSync::startSyncTimer()
+{
+    ASSERT(isMainThread());
+
+    if (m_syncTimer.isActive())
+        return;
+
+    m_syncTimer.startOneShot(m_syncInterval);
+
+    // The following is balanced by the call to enableSuddenTermination in the
+    // syncTimerFired function.
+    disableSuddenTermination();
 }
 
 void StorageAreaSync::syncTimerFired(Timer<StorageAreaSync>*)
@@ -164,17 +195,32 @@ void StorageAreaSync::syncTimerFired(Timer<StorageAreaSync>*)
     ASSERT(isMainThread());
 
     bool partialSync = false;
+    double followUpInterval;
     {
         MutexLocker locker(m_syncLock);
 
+        // Finish a partial sync, or retry a sync that is still in progress, after about
+        // twice as long as the last sync took.
+        followUpInterval = min(max(2 * m_lastSyncDuration, MinimumStorageSyncInterval), StorageSyncInterval);
+
         // Do not schedule another sync if we're still trying to complete the
         // previous one.  But, if we're shutting down, schedule it anyway.
         if (m_syncInProgress && !m_finalSyncScheduled) {
             ASSERT(!m_syncTimer.isActive());
-            m_syncTimer.startOneShot(StorageSyncInterval);
+            m_syncTimer.startOneShot(followUpInterval);
             return;
         }
 
+        // Every write beyond one per changed key was overwritten before it could sync.
+        unsigned changedItems = m_changedItems.size();
+        unsigned writesCoalesced = m_writesSinceSync > changedItems ? m_writesSinceSync - changedItems : 0;
+        m_statistics.writesCoalesced += writesCoalesced;
+        if (writesCoalesced && writesCoalesced >= changedItems)
+            m_syncInterval = min(2 * m_syncInterval, MaximumStorageSyncInterval);
+        else
+            m_syncInterval = StorageSyncInterval;
+        m_writesSinceSync = 0;
+
         if (m_itemsCleared) {
             m_itemsPendingSync.clear();
             m_clearItemsWhileSyncing = true;
@@ -183,8 +229,8 @@ void StorageAreaSync::syncTimerFired(Timer<StorageAreaSync>*)
 
         HashMap<String, String>::iterator changed_it = m_changedItems.begin();
         HashMap<String, String>::iterator changed_end = m_changedItems.end();
-        for (int count = 0; changed_it != changed_end; ++count, ++changed_it) {
-            if (count >= MaxiumItemsToSync && !m_finalSyncScheduled) {
+        for (unsigned count = 0; changed_it != changed_end; ++count, ++changed_it) {
+            if (count >= m_itemsPerSync && !m_finalSyncScheduled) {
                 partialSync = true;
                 break;
             }
@@ -192,6 +238,8 @@ void StorageAreaSync::syncTimerFired(Timer<StorageAreaSync>*)
         }
 
         if (partialSync) {
+            ++m_statistics.partialSyncs;
+
             // We can't do the fast path of simply clearing all items, so we'll need to manually
             // remove them one by one.  Done under lock since m_itemsPendingSync is modified by
             // the background thread.
@@ -215,7 +263,7 @@ void StorageAreaSync::syncTimerFired(Timer<StorageAreaSync>*)
     if (partialSync) {
         // If we didn't finish syncing, then we need to finish the job later.
         ASSERT(!m_syncTimer.isActive());
-        m_syncTimer.startOneShot(StorageSyncInterval);
+        m_syncTimer.startOneShot(followUpInterval);
     } else {
         // The following is balanced by the calls to disableSuddenTermination in the
         // scheduleItemForSync, scheduleClear, and scheduleFinalSync functions.
@@ -254,6 +302,12 @@ void StorageAreaSync::openDatabase(OpenDatabaseParamType openingStrategy)
         return;
     }
 
+    // With a write-ahead log, a commit only appends to the log, which is then
+    // synced at checkpoints rather than on every commit.
+    if (m_database.enableWriteAheadLogging())
+        m_database.setSynchronous(SQLiteDatabase::SyncNormal);
+    m_database.setStatementCacheCapacity(StorageStatementCacheCapacity);
+
     if (!m_database.executeCommand("CREATE TABLE IF NOT EXISTS ItemTable (key TEXT UNIQUE ON CONFLICT REPLACE, value TEXT NOT NULL ON CONFLICT FAIL)")) {
         LOG_ERROR("Failed to create table ItemTable for local storage");
         markImported();
@@ -275,6 +329,8 @@ void StorageAreaSync::performImport()
         return;
     }
 
+    double startTime = currentTime();
+
     SQLiteStatement query(m_database, "SELECT key, value FROM ItemTable");
     if (query.prepare() != SQLResultOk) {
         LOG_ERROR("Unable to select items from ItemTable for local storage");
@@ -282,25 +338,32 @@ void StorageAreaSync::performImport()
         return;
     }
 
-    HashMap<String, String> itemMap;
-
+    // Hand each row to the storage area as it is read, rather than collecting the whole
+    // database in a temporary map first, so that a large origin is only held in memory once.
+    // The key column is UNIQUE, so no row can replace one imported before it.
+    unsigned itemsImported = 0;
+    unsigned long long charactersImported = 0;
     int result = query.step();
     while (result == SQLResultRow) {
-        itemMap.set(query.getColumnText(0), query.getColumnText(1));
+        String key = query.getColumnText(0);
+        String value = query.getColumnText(1);
+        charactersImported += key.length() + value.length();
+        ++itemsImported;
+        m_storageArea->importItem(key, value);
         result = query.step();
     }
 
-    if (result != SQLResultDone) {
+    if (result != SQLResultDone)
         LOG_ERROR("Error reading items from ItemTable for local storage");
-        markImported();
-        return;
-    }
-
-    HashMap<String, String>::iterator it = itemMap.begin();
-    HashMap<String, String>::iterator end = itemMap.end();
 
-    for (; it != end; ++it)
-        m_storageArea->importItem(it->first, it->second);
+    double importTime = currentTime() - startTime;
+    LOG(StorageAPI, "Imported %u items (%llu characters) for local storage in %.1fms\n", itemsImported, charactersImported, importTime * 1000);
+    {
+        MutexLocker locker(m_syncLock);
+        m_statistics.itemsImported += itemsImported;
+        m_statistics.charactersImported += charactersImported;
+        m_statistics.importTime += importTime;
+    }
 
     markImported();
 }
@@ -333,6 +396,59 @@ void StorageAreaSync::blockUntilImportComplete()
     m_storageArea = 0;
 }
 
+typedef HashMap<String, String>::const_iterator ItemIterator;
+
+enum WriteType { InsertItems, RemoveItems };
+
+static String multiRowStatement(WriteType type, size_t rows)
+{
+    ASSERT(rows);
+    StringBuilder sql;
+    if (type == InsertItems) {
+        sql.append("INSERT INTO ItemTable VALUES (?, ?)");
+        for (size_t i = 1; i < rows; ++i)
+            sql.append(", (?, ?)");
+    } else {
+        sql.append("DELETE FROM ItemTable WHERE key IN (?");
+        for (size_t i = 1; i < rows; ++i)
+            sql.append(", ?");
+        sql.append(')');
+    }
+    return sql.toString();
+}
+
+static bool writeItems(SQLiteDatabase& database, SQLiteWriteBatch& batch, const Vector<ItemIterator>& items, WriteType type)
+{
+    size_t rowsPerStatement = MaximumRowsPerStatement;
+    size_t start = 0;
+    while (start < items.size()) {
+        size_t rows = min(rowsPerStatement, items.size() - start);
+        // Only full-size statements repeat from one sync to the next. Caching the shorter
+        // last statement of each batch would evict the statements that do.
+        SQLiteStatement statement(database, multiRowStatement(type, rows), rows == rowsPerStatement ? SQLiteStatement::MayBeCached : SQLiteStatement::NeverCached);
+        if (statement.prepare() != SQLResultOk) {
+            // SQLite only accepts several rows in one VALUES clause since 3.7.11.
+            if (rows > 1) {
+                rowsPerStatement = 1;
+                continue;
+            }
+            LOG_ERROR("Failed to prepare %s statement - cannot write to local storage database", type == InsertItems ? "insert" : "delete");
+            return false;
+        }
+
+        int index = 1;
+        for (size_t i = start; i < start + rows; ++i) {
+            statement.bindText(index++, items[i]->first);
+            if (type == InsertItems)
+                statement.bindText(index++, items[i]->second);
+        }
+        if (!batch.step(statement))
+            return false;
+        start += rows;
+    }
+    return true;
+}
+
 void StorageAreaSync::sync(bool clearItems, const HashMap<String, String>& items)
 {
     ASSERT(!isMainThread());
@@ -355,53 +471,33 @@ void StorageAreaSync::sync(bool clearItems, const HashMap<String, String>& items
         return;
     }
     
-    // If the clear flag is set, then we clear all items out before we write any new ones in.
-    if (clearItems) {
-        SQLiteStatement clear(m_database, "DELETE FROM ItemTable");
-        if (clear.prepare() != SQLResultOk) {
-            LOG_ERROR("Failed to prepare clear statement - cannot write to local storage database");
-            return;
-        }
-
-        int result = clear.step();
-        if (result != SQLResultDone) {
-            LOG_ERROR("Failed to clear all items in the local storage database - %i", result);
-            return;
-        }
-    }
+    // Write the whole sync in one transaction, rather than syncing the
+    // database file once per item.
+    SQLiteWriteBatch batch(m_database);
 
-    SQLiteStatement insert(m_database, "INSERT INTO ItemTable VALUES (?, ?)");
-    if (insert.prepare() != SQLResultOk) {
-        LOG_ERROR("Failed to prepare insert statement - cannot write to local storage database");
+    // If the clear flag is set, then we clear all items out before we write any new ones in.
+    if (clearItems && !batch.executeCommand("DELETE FROM ItemTable")) {
+        LOG_ERROR("Failed to clear all items in the local storage database");
         return;
     }
 
-    SQLiteStatement remove(m_database, "DELETE FROM ItemTable WHERE key=?");
-    if (remove.prepare() != SQLResultOk) {
-        LOG_ERROR("Failed to prepare delete statement - cannot write to local storage database");
-        return;
+    // Based on the null-ness of the value, decide whether this is an insert or a delete.
+    Vector<ItemIterator> insertions;
+    Vector<ItemIterator> removals;
+    ItemIterator end = items.end();
+    for (ItemIterator it = items.begin(); it != end; ++it) {
+        if (it->second.isNull())
+            removals.append(it);
+        else
+            insertions.append(it);
     }
 
-    HashMap<String, String>::const_iterator end = items.end();
-
-    for (HashMap<String, String>::const_iterator it = items.begin(); it != end; ++it) {
-        // Based on the null-ness of the second argument, decide whether this is an insert or a delete.
-        SQLiteStatement& query = it->second.isNull() ? remove : insert;
+    // The key column replaces on conflict, so inserting an existing key updates it.
+    if (!writeItems(m_database, batch, insertions, InsertItems) || !writeItems(m_database, batch, removals, RemoveItems))
+        LOG_ERROR("Failed to update items in the local storage database");
 
-        query.bindText(1, it->first);
-
-        // If the second argument is non-null, we're doing an insert, so bind it as the value.
-        if (!it->second.isNull())
-            query.bindText(2, it->second);
-
-        int result = query.step();
-        if (result != SQLResultDone) {
-            LOG_ERROR("Failed to update item in the local storage database - %i", result);
-            break;
-        }
-
-        query.reset();
-    }
+    if (!batch.commit())
+        LOG_ERROR("Failed to commit %u items to the local storage database", batch.writeCount());
 }
 
 void StorageAreaSync::performSync()
@@ -423,11 +519,30 @@ void StorageAreaSync::performSync()
         m_syncInProgress = true;
     }
 
+    double startTime = currentTime();
     sync(clearItems, items);
+    double syncTime = currentTime() - startTime;
+    unsigned itemsSynced = items.size();
+    LOG(StorageAPI, "Synced %u items to local storage in %.1fms\n", itemsSynced, syncTime * 1000);
 
     {
         MutexLocker locker(m_syncLock);
         m_syncInProgress = false;
+        m_lastSyncDuration = syncTime;
+
+        ++m_statistics.syncs;
+        m_statistics.itemsWritten += itemsSynced;
+        m_statistics.syncTime += syncTime;
+        LOG(StorageAPI, "Local storage totals: %u syncs (%u partial), %u items written, %u writes coalesced, %.1fms syncing\n",
+            m_statistics.syncs, m_statistics.partialSyncs, m_statistics.itemsWritten, m_statistics.writesCoalesced, m_statistics.syncTime * 1000);
+
+        // Only a sync of a full batch says how many items fit in TargetSyncDuration;
+        // a smaller one is dominated by the fixed cost of the transaction.
+        if (itemsSynced >= m_itemsPerSync && syncTime > 0) {
+            double itemsInTargetDuration = itemsSynced * TargetSyncDuration / syncTime;
+            double itemsPerSync = (m_itemsPerSync + min(itemsInTargetDuration, static_cast<double>(MaximumItemsToSync))) / 2;
+            m_itemsPerSync = max(MinimumItemsToSync, static_cast<unsigned>(itemsPerSync));
+        }
     }
 
     // The following is balanced by the call to disableSuddenTermination in the
@@ -471,6 +586,12 @@ void StorageAreaSync::scheduleSync()
 {
     syncTimerFired(&m_syncTimer);
 }
+
+StorageAreaSync::SyncStatistics StorageAreaSync::syncStatistics() const
+{
+    MutexLocker locker(m_syncLock);
+    return m_statistics;
+}
     
 } // namespace WebCore
 
@@ -53,15 +53,45 @@ namespace WebCore {
 
         void scheduleSync();
 
+        struct SyncStatistics {
+            SyncStatistics()
+                : syncs(0)
+                , partialSyncs(0)
+                , itemsWritten(0)
+                , writesCoalesced(0)
+                , syncTime(0)
+                , itemsImported(0)
+                , charactersImported(0)
+                , importTime(0)
+            {
+            }
+
+            unsigned syncs;
+            unsigned partialSyncs;
+            unsigned itemsWritten;
+            // Writes that never reached the database because the same key was written again before it synced.
+            unsigned writesCoalesced;
+            double syncTime;
+            unsigned itemsImported;
+            unsigned long long charactersImported;
+            double importTime;
+        };
+        SyncStatistics syncStatistics() const;
+
     private:
         StorageAreaSync(PassRefPtr<StorageSyncManager>, PassRefPtr<StorageAreaImpl>, const String& databaseIdentifier);
 
         void dispatchStorageEvent(const String& key, const String& oldValue, const String& newValue, Frame* sourceFrame);
+        void startSyncTimer();
 
         Timer<StorageAreaSync> m_syncTimer;
         HashMap<String, String> m_changedItems;
         bool m_itemsCleared;
 
+        // Grows while the page keeps rewriting the same keys, so that fewer redundant syncs hit the disk.
+        double m_syncInterval;
+        unsigned m_writesSinceSync;
+
         bool m_finalSyncScheduled;
 
         RefPtr<StorageAreaImpl> m_storageArea;
@@ -89,8 +119,12 @@ namespace WebCore {
 
         const String m_databaseIdentifier;
 
-        Mutex m_syncLock;
+        mutable Mutex m_syncLock;
         HashMap<String, String> m_itemsPendingSync;
+        // Sized by the background thread so that one sync takes about the same time however fast the disk is.
+        unsigned m_itemsPerSync;
+        double m_lastSyncDuration;
+        SyncStatistics m_statistics;
         bool m_clearItemsWhileSyncing;
         bool m_syncScheduled;
         bool m_syncInProgress;
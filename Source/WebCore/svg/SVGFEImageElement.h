@@ -40,6 +40,7 @@ class SVGFEImageElement : public SVGFilterPrimitiveStandardAttributes,
                           public SVGLangSpace,
                           public SVGExternalResourcesRequired,
                           public CachedResourceClient {
+    MAKE_NODE_ARENA_ALLOCATED;
 public:
     static PassRefPtr<SVGFEImageElement> create(const QualifiedName&, Document*);
 
@@ -31,6 +31,7 @@ class CSSFontFaceSrcValue;
 class CachedFont;
 
 class SVGFontFaceUriElement : public SVGElement, public CachedResourceClient {
+    MAKE_NODE_ARENA_ALLOCATED;
 public:
     static PassRefPtr<SVGFontFaceUriElement> create(const QualifiedName&, Document*);
 
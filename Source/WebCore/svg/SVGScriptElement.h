@@ -35,6 +35,7 @@ class SVGScriptElement : public SVGElement
                        , public SVGURIReference
                        , public SVGExternalResourcesRequired
                        , public ScriptElement {
+    MAKE_NODE_ARENA_ALLOCATED;
 public:
     static PassRefPtr<SVGScriptElement> create(const QualifiedName&, Document*, bool wasInsertedByParser);
 
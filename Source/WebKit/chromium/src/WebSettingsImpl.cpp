@@ -397,4 +397,18 @@ void WebSettingsImpl::setFullScreenEnabled(bool enabled)
 #endif
 }
 
+void WebSettingsImpl::setIsolatedSubtreeLayoutEnabled(bool enabled)
+{
+    m_settings->setIsolatedSubtreeLayoutEnabled(enabled);
+}
+
+void WebSettingsImpl::setDOMNodeArenaEnabled(bool enabled)
+{
+#if ENABLE(DOM_NODE_ARENA)
+    m_settings->setDOMNodeArenaEnabled(enabled);
+#else
+    UNUSED_PARAM(enabled);
+#endif
+}
+
 } // namespace WebKit
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "IDBLevelDBBackingStore.h"
+
+#include "FileSystem.h"
+#include "IDBFactoryBackendImpl.h"
+#include "IDBKey.h"
+#include "LevelDBComparator.h"
+#include "LevelDBDatabase.h"
+#include "LevelDBSlice.h"
+#include "SecurityOrigin.h"
+
+#include <gtest/gtest.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/Vector.h>
+
+#if ENABLE(INDEXED_DATABASE) && ENABLE(LEVELDB)
+
+using namespace WebCore;
+
+namespace {
+
+// Stands in for the comparator used before schema version 1.
+class LegacyComparator : public LevelDBComparator {
+public:
+    virtual int compare(const LevelDBSlice& a, const LevelDBSlice& b) const
+    {
+        size_t lengthA = a.end() - a.begin();
+        size_t lengthB = b.end() - b.begin();
+        if (int x = memcmp(a.begin(), b.begin(), std::min(lengthA, lengthB)))
+            return x;
+        return lengthA == lengthB ? 0 : (lengthA < lengthB ? -1 : 1);
+    }
+    virtual const char* name() const { return "idb_cmp1"; }
+};
+
+class IDBLevelDBBackingStoreTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        PlatformFileHandle handle;
+        m_pathBase = openTemporaryFile("IDBLevelDBBackingStoreTest", handle);
+        closeFile(handle);
+        deleteFile(m_pathBase);
+
+        m_origin = SecurityOrigin::createFromString("http://localhost:8000");
+        m_path = pathByAppendingComponent(m_pathBase, m_origin->databaseIdentifier() + ".indexeddb.leveldb");
+        m_factory = IDBFactoryBackendImpl::create();
+    }
+
+    virtual void TearDown()
+    {
+        LevelDBDatabase::destroy(m_path);
+        deleteEmptyDirectory(m_pathBase);
+    }
+
+    PassRefPtr<IDBBackingStore> openBackingStore()
+    {
+        return IDBLevelDBBackingStore::open(m_origin.get(), m_pathBase, 0, "test", m_factory.get());
+    }
+
+    void writeLegacyDatabase()
+    {
+        ASSERT_TRUE(makeAllDirectories(m_pathBase));
+        LegacyComparator comparator;
+        OwnPtr<LevelDBDatabase> db = adoptPtr(LevelDBDatabase::open(m_path, &comparator));
+        ASSERT_TRUE(db);
+        ASSERT_TRUE(db->put(LevelDBSlice(m_legacyKey), m_legacyKey));
+    }
+
+    bool legacyDatabaseIsIntact()
+    {
+        LegacyComparator comparator;
+        OwnPtr<LevelDBDatabase> db = adoptPtr(LevelDBDatabase::open(m_path, &comparator));
+        Vector<char> value;
+        return db && db->get(LevelDBSlice(m_legacyKey), value) && value == m_legacyKey;
+    }
+
+    String m_pathBase;
+    String m_path;
+    RefPtr<SecurityOrigin> m_origin;
+    RefPtr<IDBFactoryBackendImpl> m_factory;
+    Vector<char> m_legacyKey;
+};
+
+TEST_F(IDBLevelDBBackingStoreTest, RollbackWithoutBeginKeepsOtherTransactionsWrites)
+{
+    RefPtr<IDBBackingStore> backingStore = openBackingStore();
+    ASSERT_TRUE(backingStore);
+
+    RefPtr<IDBBackingStore::Transaction> running = backingStore->createTransaction();
+    RefPtr<IDBBackingStore::Transaction> pending = backingStore->createTransaction();
+
+    running->begin();
+    int64_t rowId;
+    EXPECT_TRUE(backingStore->setIDBDatabaseMetaData("db", "1", rowId, true));
+
+    // A transaction aborted before it started shares the write batch, but must not touch it.
+    pending->rollback();
+    pending->commit();
+
+    running->commit();
+
+    String version;
+    int64_t foundId;
+    EXPECT_TRUE(backingStore->extractIDBDatabaseMetaData("db", version, foundId));
+    EXPECT_EQ(String("1"), version);
+    EXPECT_EQ(rowId, foundId);
+}
+
+TEST_F(IDBLevelDBBackingStoreTest, RollbackDiscardsWrites)
+{
+    RefPtr<IDBBackingStore> backingStore = openBackingStore();
+    ASSERT_TRUE(backingStore);
+
+    RefPtr<IDBBackingStore::Transaction> transaction = backingStore->createTransaction();
+    transaction->begin();
+    int64_t rowId;
+    EXPECT_TRUE(backingStore->setIDBDatabaseMetaData("db", "1", rowId, true));
+    transaction->rollback();
+
+    String version;
+    int64_t foundId;
+    EXPECT_FALSE(backingStore->extractIDBDatabaseMetaData("db", version, foundId));
+}
+
+TEST_F(IDBLevelDBBackingStoreTest, RollbackDiscardsWritesSeenByIterators)
+{
+    RefPtr<IDBBackingStore> backingStore = openBackingStore();
+    ASSERT_TRUE(backingStore);
+
+    int64_t databaseId;
+    EXPECT_TRUE(backingStore->setIDBDatabaseMetaData("db", "1", databaseId, true));
+
+    RefPtr<IDBBackingStore::Transaction> transaction = backingStore->createTransaction();
+    transaction->begin();
+    int64_t objectStoreId;
+    EXPECT_TRUE(backingStore->createObjectStore(databaseId, "store", String(), true, objectStoreId));
+
+    // Listing object stores iterates over the meta-data, which must see the
+    // buffered writes without writing them out.
+    Vector<int64_t> ids;
+    Vector<String> names;
+    Vector<String> keyPaths;
+    Vector<bool> autoIncrementFlags;
+    backingStore->getObjectStores(databaseId, ids, names, keyPaths, autoIncrementFlags);
+    ASSERT_EQ(1u, ids.size());
+    EXPECT_EQ(objectStoreId, ids[0]);
+    EXPECT_EQ(String("store"), names[0]);
+    EXPECT_TRUE(autoIncrementFlags[0]);
+
+    transaction->rollback();
+
+    ids.clear();
+    names.clear();
+    keyPaths.clear();
+    autoIncrementFlags.clear();
+    backingStore->getObjectStores(databaseId, ids, names, keyPaths, autoIncrementFlags);
+    EXPECT_EQ(0u, ids.size());
+}
+
+TEST_F(IDBLevelDBBackingStoreTest, AutoIncrementNumberFollowsNumericKeys)
+{
+    RefPtr<IDBBackingStore> backingStore = openBackingStore();
+    ASSERT_TRUE(backingStore);
+
+    int64_t databaseId;
+    EXPECT_TRUE(backingStore->setIDBDatabaseMetaData("db", "1", databaseId, true));
+    int64_t objectStoreId;
+    EXPECT_TRUE(backingStore->createObjectStore(databaseId, "store", String(), true, objectStoreId));
+    EXPECT_EQ(1, backingStore->nextAutoIncrementNumber(databaseId, objectStoreId));
+
+    RefPtr<IDBBackingStore::Transaction> transaction = backingStore->createTransaction();
+    transaction->begin();
+    RefPtr<IDBBackingStore::ObjectStoreRecordIdentifier> recordIdentifier = backingStore->createInvalidRecordIdentifier();
+    EXPECT_TRUE(backingStore->putObjectStoreRecord(databaseId, objectStoreId, *IDBKey::createNumber(5), "five", recordIdentifier.get()));
+    EXPECT_EQ(6, backingStore->nextAutoIncrementNumber(databaseId, objectStoreId));
+
+    // Smaller and non-numeric keys leave the number alone.
+    EXPECT_TRUE(backingStore->putObjectStoreRecord(databaseId, objectStoreId, *IDBKey::createNumber(2), "two", recordIdentifier.get()));
+    EXPECT_TRUE(backingStore->putObjectStoreRecord(databaseId, objectStoreId, *IDBKey::createString("ten"), "ten", recordIdentifier.get()));
+    EXPECT_EQ(6, backingStore->nextAutoIncrementNumber(databaseId, objectStoreId));
+
+    transaction->rollback();
+    EXPECT_EQ(1, backingStore->nextAutoIncrementNumber(databaseId, objectStoreId));
+}
+
+TEST_F(IDBLevelDBBackingStoreTest, OpenDiscardsLegacyDatabase)
+{
+    m_legacyKey.append("legacy", 6);
+    writeLegacyDatabase();
+
+    RefPtr<IDBBackingStore> backingStore = openBackingStore();
+    EXPECT_TRUE(backingStore);
+    backingStore.clear();
+
+    // The database was rebuilt with the current comparator.
+    EXPECT_FALSE(legacyDatabaseIsIntact());
+}
+
+TEST_F(IDBLevelDBBackingStoreTest, OpenKeepsFilesItCannotOpen)
+{
+    // A plain file where the database directory should be fails to open for
+    // reasons other than the comparator, so it must be left alone.
+    ASSERT_TRUE(makeAllDirectories(m_pathBase));
+    PlatformFileHandle handle = openFile(m_path, OpenForWrite);
+    ASSERT_TRUE(isHandleValid(handle));
+    EXPECT_EQ(4, writeToFile(handle, "data", 4));
+    closeFile(handle);
+
+    EXPECT_FALSE(openBackingStore());
+
+    long long size;
+    EXPECT_TRUE(getFileSize(m_path, size));
+    EXPECT_EQ(4, size);
+    EXPECT_TRUE(deleteFile(m_path));
+}
+
+} // namespace
+
+#endif // ENABLE(INDEXED_DATABASE) && ENABLE(LEVELDB)
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include "NodeArena.h"
+
+#include <gtest/gtest.h>
+
+#if ENABLE(DOM_NODE_ARENA)
+
+namespace WebCore {
+
+class NodeArenaTest : public testing::Test {
+};
+
+TEST_F(NodeArenaTest, StatisticsTrackLiveObjects)
+{
+    NodeArena* arena = NodeArena::create();
+    void* small;
+    void* large;
+    {
+        NodeArena::Scope scope(arena);
+        small = NodeArena::allocate(40);
+        large = NodeArena::allocate(4096);
+    }
+    EXPECT_EQ(2u, arena->statistics().liveObjects);
+    EXPECT_GT(arena->statistics().liveBytes, 4096u + 40u);
+    EXPECT_GT(arena->statistics().slabBytes, 0u);
+    EXPECT_GT(arena->statistics().largeObjectBytes, 4096u);
+
+    NodeArena::deallocate(large, 4096);
+    EXPECT_EQ(1u, arena->statistics().liveObjects);
+    EXPECT_EQ(0u, arena->statistics().largeObjectBytes);
+
+    NodeArena::deallocate(small, 40);
+    EXPECT_EQ(0u, arena->statistics().liveObjects);
+    EXPECT_EQ(0u, arena->statistics().liveBytes);
+    arena->detachFromDocument();
+}
+
+TEST_F(NodeArenaTest, ReusesFreedCells)
+{
+    NodeArena* arena = NodeArena::create();
+    {
+        NodeArena::Scope scope(arena);
+        void* first = NodeArena::allocate(64);
+        NodeArena::deallocate(first, 64);
+        size_t slabBytes = arena->statistics().slabBytes;
+        void* second = NodeArena::allocate(64);
+        EXPECT_EQ(first, second);
+        EXPECT_EQ(slabBytes, arena->statistics().slabBytes);
+        NodeArena::deallocate(second, 64);
+    }
+    arena->detachFromDocument();
+}
+
+// Models a node that is adopted into another document: it is freed while a
+// Scope for the other document's arena is active.
+TEST_F(NodeArenaTest, ObjectsAreFreedToTheArenaTheyCameFrom)
+{
+    NodeArena* arena = NodeArena::create();
+    NodeArena* otherArena = NodeArena::create();
+    void* p;
+    {
+        NodeArena::Scope scope(arena);
+        p = NodeArena::allocate(32);
+    }
+    {
+        NodeArena::Scope scope(otherArena);
+        NodeArena::deallocate(p, 32);
+    }
+    EXPECT_EQ(0u, arena->statistics().liveObjects);
+    EXPECT_EQ(0u, otherArena->statistics().liveObjects);
+    arena->detachFromDocument();
+    otherArena->detachFromDocument();
+}
+
+TEST_F(NodeArenaTest, NestedScopesRestoreTheOuterArena)
+{
+    NodeArena* arena = NodeArena::create();
+    NodeArena* otherArena = NodeArena::create();
+    void* outer;
+    void* inner;
+    void* mallocObject;
+    void* outerAgain;
+    {
+        NodeArena::Scope scope(arena);
+        outer = NodeArena::allocate(16);
+        {
+            NodeArena::Scope innerScope(otherArena);
+            inner = NodeArena::allocate(16);
+            {
+                NodeArena::Scope mallocScope(0);
+                mallocObject = NodeArena::allocate(16);
+            }
+        }
+        outerAgain = NodeArena::allocate(16);
+    }
+    EXPECT_EQ(2u, arena->statistics().liveObjects);
+    EXPECT_EQ(1u, otherArena->statistics().liveObjects);
+
+    NodeArena::deallocate(outer, 16);
+    NodeArena::deallocate(inner, 16);
+    NodeArena::deallocate(mallocObject, 16);
+    NodeArena::deallocate(outerAgain, 16);
+    EXPECT_EQ(0u, arena->statistics().liveObjects);
+    EXPECT_EQ(0u, otherArena->statistics().liveObjects);
+    arena->detachFromDocument();
+    otherArena->detachFromDocument();
+}
+
+// The arena stays alive until the objects that outlive its document are freed.
+TEST_F(NodeArenaTest, ObjectsOutliveTheDocument)
+{
+    NodeArena* arena = NodeArena::create();
+    void* p;
+    {
+        NodeArena::Scope scope(arena);
+        p = NodeArena::allocate(48);
+    }
+    arena->detachFromDocument();
+    EXPECT_EQ(1u, arena->statistics().liveObjects);
+    NodeArena::deallocate(p, 48);
+}
+
+// Models a script run by the parser destroying the document being parsed.
+TEST_F(NodeArenaTest, ScopeOutlivesTheDocument)
+{
+    NodeArena* arena = NodeArena::create();
+    void* before;
+    void* after;
+    {
+        NodeArena::Scope scope(arena);
+        before = NodeArena::allocate(24);
+        arena->detachFromDocument();
+        NodeArena::deallocate(before, 24);
+        // The arena deleted itself, so this must not come from it.
+        after = NodeArena::allocate(24);
+    }
+    NodeArena::deallocate(after, 24);
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(DOM_NODE_ARENA)
@@ -1354,6 +1354,10 @@ void LayoutTestController::overridePreference(const CppArgumentList& arguments,
         prefs->hyperlinkAuditingEnabled = cppVariantToBool(value);
     else if (key == "WebKitEnableCaretBrowsing")
         prefs->caretBrowsingEnabled = cppVariantToBool(value);
+    else if (key == "WebKitIsolatedSubtreeLayoutEnabled")
+        prefs->isolatedSubtreeLayoutEnabled = cppVariantToBool(value);
+    else if (key == "WebKitDOMNodeArenaEnabled")
+        prefs->domNodeArenaEnabled = cppVariantToBool(value);
     else {
         string message("Invalid name for preference: ");
         message.append(key);
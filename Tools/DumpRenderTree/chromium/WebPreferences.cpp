@@ -105,6 +105,8 @@ void WebPreferences::reset()
     acceleratedCompositingEnabled = false;
     accelerated2dCanvasEnabled = false;
     forceCompositingMode = false;
+    isolatedSubtreeLayoutEnabled = false;
+    domNodeArenaEnabled = false;
 }
 
 void WebPreferences::applyTo(WebView* webView)
@@ -152,6 +154,8 @@ void WebPreferences::applyTo(WebView* webView)
     settings->setAcceleratedCompositingEnabled(acceleratedCompositingEnabled);
     settings->setForceCompositingMode(forceCompositingMode);
     settings->setAccelerated2dCanvasEnabled(accelerated2dCanvasEnabled);
+    settings->setIsolatedSubtreeLayoutEnabled(isolatedSubtreeLayoutEnabled);
+    settings->setDOMNodeArenaEnabled(domNodeArenaEnabled);
 
     // Fixed values.
     settings->setShouldPaintCustomScrollbars(true);
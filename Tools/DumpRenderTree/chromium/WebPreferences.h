@@ -80,6 +80,8 @@ struct WebPreferences {
     bool acceleratedCompositingEnabled;
     bool forceCompositingMode;
     bool accelerated2dCanvasEnabled;
+    bool isolatedSubtreeLayoutEnabled;
+    bool domNodeArenaEnabled;
 
     WebPreferences() { reset(); }
     void reset();
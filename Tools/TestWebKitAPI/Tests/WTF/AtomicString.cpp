@@ -0,0 +1,132 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+
+#include <JavaScriptCore/AtomicString.h>
+#include <JavaScriptCore/Threading.h>
+#include <JavaScriptCore/Vector.h>
+#include <JavaScriptCore/WTFString.h>
+
+namespace TestWebKitAPI {
+
+static const unsigned wordCount = 20000;
+
+static Vector<String> makeWords()
+{
+    Vector<String> words;
+    for (unsigned i = 0; i < wordCount; ++i)
+        words.append(String::format("word-%u", i * 7919));
+    return words;
+}
+
+TEST(WTF, AtomicStringAddAndFind)
+{
+    Vector<String> words = makeWords();
+
+    // Half the words stay atomic, the other half are released after each add.
+    Vector<AtomicString> kept;
+    for (unsigned i = 0; i < wordCount; i += 2)
+        kept.append(AtomicString(words[i].characters(), words[i].length()));
+
+    for (unsigned pass = 0; pass < 2; ++pass) {
+        for (unsigned i = 0; i < wordCount; ++i) {
+            AtomicString atom(words[i].characters(), words[i].length());
+            TEST_ASSERT(atom == words[i]);
+            if (!(i % 2))
+                TEST_ASSERT(atom.impl() == kept[i / 2].impl());
+        }
+    }
+
+    for (unsigned i = 0; i < wordCount; ++i) {
+        RefPtr<AtomicStringImpl> found = AtomicString::find(words[i].characters(), words[i].length(), words[i].impl()->hash());
+        if (i % 2)
+            TEST_ASSERT(!found);
+        else
+            TEST_ASSERT(found == kept[i / 2].impl());
+    }
+}
+
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+
+static const unsigned atomizingThreadCount = 4;
+
+struct AtomizingThread {
+    const Vector<String>* words;
+    const Vector<AtomicString>* mainThreadAtoms;
+    bool matched;
+};
+
+// Atomizes every word many times, keeping none of them, and checks that the
+// words the main thread holds atomize to the main thread's strings. Also
+// looks up the words nobody holds, which other threads keep releasing.
+static void* atomizeWords(void* context)
+{
+    AtomizingThread* thread = static_cast<AtomizingThread*>(context);
+    thread->matched = true;
+    for (unsigned pass = 0; pass < 10; ++pass) {
+        for (unsigned i = 0; i < wordCount; ++i) {
+            const String& word = (*thread->words)[i];
+            AtomicString atom(word.characters(), word.length());
+            if (atom != word || (!(i % 2) && atom.impl() != (*thread->mainThreadAtoms)[i / 2].impl()))
+                thread->matched = false;
+            atom = AtomicString();
+            RefPtr<AtomicStringImpl> found = AtomicString::find(word.characters(), word.length(), word.impl()->hash());
+            if (found && !equal(found.get(), word.impl()))
+                thread->matched = false;
+        }
+    }
+    return 0;
+}
+
+TEST(WTF, AtomicStringSharedBetweenThreads)
+{
+    Vector<String> words = makeWords();
+    Vector<AtomicString> mainThreadAtoms;
+    for (unsigned i = 0; i < wordCount; i += 2)
+        mainThreadAtoms.append(AtomicString(words[i].characters(), words[i].length()));
+
+    AtomizingThread threads[atomizingThreadCount];
+    ThreadIdentifier identifiers[atomizingThreadCount];
+    for (unsigned i = 0; i < atomizingThreadCount; ++i) {
+        threads[i].words = &words;
+        threads[i].mainThreadAtoms = &mainThreadAtoms;
+        identifiers[i] = createThread(atomizeWords, &threads[i], "AtomicString test");
+    }
+    for (unsigned i = 0; i < atomizingThreadCount; ++i) {
+        waitForThreadCompletion(identifiers[i], 0);
+        TEST_ASSERT(threads[i].matched);
+    }
+
+    for (unsigned i = 0; i < wordCount; ++i) {
+        AtomicString atom(words[i].characters(), words[i].length());
+        TEST_ASSERT(atom == words[i]);
+        TEST_ASSERT(atom.impl() == AtomicString(words[i]).impl());
+    }
+}
+
+#endif // ENABLE(SHARED_ATOMIC_STRING_TABLE)
+
+} // namespace TestWebKitAPI
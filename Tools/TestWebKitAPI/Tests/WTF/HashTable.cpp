@@ -0,0 +1,164 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+
+#include <JavaScriptCore/HashMap.h>
+#include <JavaScriptCore/HashSet.h>
+#include <JavaScriptCore/StringHash.h>
+#include <JavaScriptCore/Vector.h>
+#include <JavaScriptCore/WTFString.h>
+
+namespace TestWebKitAPI {
+
+typedef HashMap<int, int> IntMap;
+typedef HashMap<int, int, IntHash<unsigned>, GroupProbingHashTraits<HashTraits<int> > > GroupProbingIntMap;
+typedef HashMap<String, int> StringMap;
+typedef HashMap<String, int, StringHash, GroupProbingHashTraits<HashTraits<String> > > GroupProbingStringMap;
+
+static unsigned nextRandom(unsigned& seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+// Applies the same random adds, sets, removes and finds to both maps, and
+// checks that they always agree.
+template<typename Map, typename ReferenceMap> static bool runMix(unsigned seed, int keyRange, int operations)
+{
+    Map map;
+    ReferenceMap reference;
+    for (int i = 0; i < operations; ++i) {
+        int key = 1 + nextRandom(seed) % keyRange;
+        switch (nextRandom(seed) % 8) {
+        case 0:
+        case 1:
+            if (map.add(key, i).second != reference.add(key, i).second)
+                return false;
+            break;
+        case 2:
+            map.set(key, i);
+            reference.set(key, i);
+            break;
+        case 3:
+        case 4:
+            map.remove(key);
+            reference.remove(key);
+            break;
+        default:
+            if (map.get(key) != reference.get(key) || map.contains(key) != reference.contains(key))
+                return false;
+        }
+    }
+
+    if (map.size() != reference.size())
+        return false;
+    int count = 0;
+    typename Map::iterator end = map.end();
+    for (typename Map::iterator it = map.begin(); it != end; ++it) {
+        if (reference.get(it->first) != it->second)
+            return false;
+        ++count;
+    }
+    map.checkConsistency();
+    return count == map.size();
+}
+
+TEST(WTF, HashTableGroupProbingSmallKeyRange)
+{
+    for (unsigned seed = 1; seed <= 10; ++seed)
+        TEST_ASSERT((runMix<GroupProbingIntMap, IntMap>(seed, 100, 20000)));
+}
+
+TEST(WTF, HashTableGroupProbingLargeKeyRange)
+{
+    for (unsigned seed = 1; seed <= 4; ++seed)
+        TEST_ASSERT((runMix<GroupProbingIntMap, IntMap>(seed, 100000, 200000)));
+}
+
+TEST(WTF, HashTableGroupProbingStringKeys)
+{
+    GroupProbingStringMap map;
+    for (int i = 0; i < 1000; ++i)
+        map.set(String::number(i), i);
+    for (int i = 0; i < 1000; i += 3)
+        map.remove(String::number(i));
+    map.checkConsistency();
+
+    TEST_ASSERT(map.size() == 666);
+    for (int i = 0; i < 1000; ++i)
+        TEST_ASSERT(map.contains(String::number(i)) == !!(i % 3));
+
+    GroupProbingStringMap copy(map);
+    TEST_ASSERT(copy.size() == map.size());
+    TEST_ASSERT(copy.get("500") == 500);
+    map.clear();
+    TEST_ASSERT(map.isEmpty());
+    TEST_ASSERT(!map.contains("500"));
+}
+
+static const int mixKeyCount = 100000;
+
+// Inserts every key, looks each up several times, misses as often, then
+// removes half of the keys and looks them all up again.
+template<typename Map, typename Key> static bool runMix(const Vector<Key>& keys, const Vector<Key>& missingKeys)
+{
+    Map map;
+    for (size_t i = 0; i < keys.size(); ++i)
+        map.set(keys[i], i);
+    int found = 0;
+    for (int pass = 0; pass < 4; ++pass) {
+        for (size_t i = 0; i < keys.size(); ++i)
+            found += map.contains(keys[(i * 7919) % keys.size()]);
+        for (size_t i = 0; i < missingKeys.size(); ++i)
+            found += map.contains(missingKeys[i]);
+    }
+    for (size_t i = 0; i < keys.size(); i += 2)
+        map.remove(keys[i]);
+    for (size_t i = 0; i < keys.size(); ++i)
+        found += map.contains(keys[i]);
+    return found == mixKeyCount * 4 + mixKeyCount / 2 && map.size() == static_cast<unsigned>(mixKeyCount / 2);
+}
+
+TEST(WTF, HashTableGroupProbingMixes)
+{
+    Vector<int> intKeys;
+    Vector<int> missingIntKeys;
+    Vector<String> stringKeys;
+    Vector<String> missingStringKeys;
+    for (int i = 0; i < mixKeyCount; ++i) {
+        intKeys.append(i * 2 + 1);
+        missingIntKeys.append(i * 2 + 2);
+        stringKeys.append(String::format("http://www.example.com/images/%d.png", i * 2));
+        missingStringKeys.append(String::format("http://www.example.com/images/%d.png", i * 2 + 1));
+    }
+
+    TEST_ASSERT(runMix<IntMap>(intKeys, missingIntKeys));
+    TEST_ASSERT(runMix<GroupProbingIntMap>(intKeys, missingIntKeys));
+    TEST_ASSERT(runMix<StringMap>(stringKeys, missingStringKeys));
+    TEST_ASSERT(runMix<GroupProbingStringMap>(stringKeys, missingStringKeys));
+}
+
+} // namespace TestWebKitAPI
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+
+#include <JavaScriptCore/CurrentTime.h>
+#include <JavaScriptCore/MessageQueue.h>
+#include <JavaScriptCore/OwnPtr.h>
+#include <JavaScriptCore/PassOwnPtr.h>
+#include <JavaScriptCore/StdLibExtras.h>
+#include <JavaScriptCore/Threading.h>
+
+namespace TestWebKitAPI {
+
+struct Message {
+    Message(unsigned producer, unsigned sequence)
+        : producer(producer)
+        , sequence(sequence)
+    {
+    }
+
+    unsigned producer;
+    unsigned sequence;
+};
+
+static bool hasOddSequence(Message* message)
+{
+    return message->sequence & 1;
+}
+
+TEST(WTF, LockFreeMessageQueueOrdering)
+{
+    LockFreeMessageQueue<Message> queue;
+    for (unsigned i = 0; i < 10; ++i)
+        queue.append(adoptPtr(new Message(0, i)));
+    queue.prepend(adoptPtr(new Message(0, 100)));
+    queue.removeIf(hasOddSequence);
+
+    const unsigned expected[] = { 100, 0, 2, 4, 6, 8 };
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(expected); ++i) {
+        OwnPtr<Message> message = queue.tryGetMessage();
+        TEST_ASSERT(message);
+        TEST_ASSERT(message->sequence == expected[i]);
+    }
+    TEST_ASSERT(queue.isEmpty());
+    TEST_ASSERT(!queue.tryGetMessage());
+}
+
+TEST(WTF, LockFreeMessageQueueTimeoutAndKill)
+{
+    LockFreeMessageQueue<Message> queue;
+    queue.append(adoptPtr(new Message(0, 2)));
+
+    MessageQueueWaitResult result;
+    OwnPtr<Message> message = queue.waitForMessageFilteredWithTimeout(result, hasOddSequence, currentTime() + 0.01);
+    TEST_ASSERT(result == MessageQueueTimeout);
+    TEST_ASSERT(!message);
+    TEST_ASSERT(!queue.isEmpty());
+
+    queue.kill();
+    TEST_ASSERT(queue.killed());
+    TEST_ASSERT(!queue.waitForMessage());
+}
+
+static const unsigned producerCount = 4;
+static const unsigned messagesPerProducer = 100000;
+
+template<typename Queue> struct Producer {
+    Queue* queue;
+    unsigned id;
+};
+
+template<typename Queue> static void* produceMessages(void* context)
+{
+    Producer<Queue>* producer = static_cast<Producer<Queue>*>(context);
+    for (unsigned i = 0; i < messagesPerProducer; ++i)
+        producer->queue->append(adoptPtr(new Message(producer->id, i)));
+    return 0;
+}
+
+// Posts messages from several threads and takes them on this one, checking
+// that each producer's messages arrive in order.
+template<typename Queue> static bool receivesMessagesInOrder()
+{
+    Queue queue;
+    Producer<Queue> producers[producerCount];
+    ThreadIdentifier threads[producerCount];
+    unsigned nextSequence[producerCount];
+
+    for (unsigned i = 0; i < producerCount; ++i) {
+        producers[i].queue = &queue;
+        producers[i].id = i;
+        nextSequence[i] = 0;
+        threads[i] = createThread(produceMessages<Queue>, &producers[i], "MessageQueue producer");
+    }
+
+    bool inOrder = true;
+    for (unsigned i = 0; i < producerCount * messagesPerProducer; ++i) {
+        OwnPtr<Message> message = queue.waitForMessage();
+        if (message->sequence != nextSequence[message->producer])
+            inOrder = false;
+        nextSequence[message->producer] = message->sequence + 1;
+    }
+
+    for (unsigned i = 0; i < producerCount; ++i)
+        waitForThreadCompletion(threads[i], 0);
+    return inOrder;
+}
+
+TEST(WTF, MessageQueueMultipleProducers)
+{
+    TEST_ASSERT(receivesMessagesInOrder<MessageQueue<Message> >());
+    TEST_ASSERT(receivesMessagesInOrder<LockFreeMessageQueue<Message> >());
+}
+
+} // namespace TestWebKitAPI